@@ -1,15 +1,40 @@
 #ifndef AFINA_STORAGE_H
 #define AFINA_STORAGE_H
 
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <memory>
 #include <string>
+#include <utility>
+#include <vector>
 
 namespace Afina {
 
+/**
+ * Immutable piece of stored value. Storage shares chunks with readers, so value could
+ * be sent to the network chunk by chunk without assembling a contiguous copy first
+ */
+using ValueChunk = std::shared_ptr<const std::string>;
+
 /**
  *
  */
 class Storage {
 public:
+    // End of the key GetChunksBatch hasn't found
+    static const std::size_t kMissing = static_cast<std::size_t>(-1);
+
+    // Outcome of Scan: walk reached the end of prefix range, there could be more keys after the last collected
+    // one, or storage can't walk its keys in order at all
+    enum class ScanResult { kEnd, kMore, kUnsupported };
+
+    /**
+     * Computes new value of the key for Update: gets whether key is present and its current value, empty if
+     * there is none, changes value in place and returns true to store it or false to leave key as it is
+     */
+    using Updater = std::function<bool(bool present, std::string &value)>;
+
     Storage() {}
     virtual ~Storage() {}
 
@@ -30,6 +55,18 @@ public:
      */
     virtual bool Put(const std::string &key, const std::string &value) = 0;
 
+    /**
+     * Same as Put, but storage is free to take over the given buffer instead of
+     * copying the value out of it. Network layer uses that to read large values
+     * right into the buffer storage keeps.
+     *
+     * Default implementation copies value by Put
+     *
+     * @param key to be associated with value
+     * @param value to be assigned for the key, might be left empty
+     */
+    virtual bool Adopt(const std::string &key, std::string &&value) { return Put(key, value); }
+
     /**
      * Stores association between given key/value pair if key isn't present in
      * storage.
@@ -72,6 +109,46 @@ public:
      */
     virtual bool Delete(const std::string &key) = 0;
 
+    /**
+     * Sets time to live of the existing key: key expires once given number of seconds pass, 0 means
+     * key never expires and negative ttl expires key right away. Value is left untouched.
+     *
+     * Put starts association without expiration, Set and Append keep expiration the key has.
+     *
+     * Default implementation is for storages without expiration: negative ttl deletes the key,
+     * otherwise method only reports if key is present
+     *
+     * @param key to change expiration of
+     * @param ttl seconds to live
+     * @return true if key found
+     */
+    virtual bool Touch(const std::string &key, int64_t ttl) {
+        if (ttl < 0) {
+            return Delete(key);
+        }
+        std::string value;
+        return Get(key, value);
+    }
+
+    /**
+     * Reports expiration of the existing key: seconds it has left to live, rounded up, or -1 if key never
+     * expires, the way memcached reports it. Check doesn't count as a use of the key.
+     *
+     * Default implementation is for storages without expiration: every key lives forever
+     *
+     * @param key to check expiration of
+     * @param ttl output parameter for seconds to live
+     * @return true if key found
+     */
+    virtual bool TimeToLive(const std::string &key, int64_t &ttl) {
+        std::string value;
+        if (!Get(key, value)) {
+            return false;
+        }
+        ttl = -1;
+        return true;
+    }
+
     /**
      * Retrive key for the given value
      * If there is an association for the given key then method copies value
@@ -84,6 +161,140 @@ public:
      * @param value output parameter to copy value to
      */
     virtual bool Get(const std::string &key, std::string &value) = 0;
+
+    /**
+     * Appends given data to the end of existing value for the key. If key
+     * doesn't present in storage method returns false and doesn't change anything.
+     *
+     * Default implementation builds new value and replace existing one, storages
+     * that keeps values in chunks could avoid copy of existing data.
+     *
+     * @param key to append data for
+     * @param value data to be appended
+     */
+    virtual bool Append(const std::string &key, const std::string &value) {
+        std::string current;
+        if (!Get(key, current)) {
+            return false;
+        }
+        return Set(key, current + value);
+    }
+
+    /**
+     * Inserts given data before the beginning of existing value for the key. If key doesn't present in
+     * storage method returns false and doesn't change anything.
+     *
+     * Default implementation builds new value and updates existing one
+     *
+     * @param key to prepend data for
+     * @param value data to be prepended
+     */
+    virtual bool Prepend(const std::string &key, const std::string &value) {
+        std::string current;
+        if (!Get(key, current)) {
+            return false;
+        }
+        return Set(key, value + current);
+    }
+
+    /**
+     * Read-modify-write of the key as a single operation: nothing could change the key between the moment
+     * updater sees its value and the moment new value is stored. New key starts without expiration, existing
+     * one keeps its expiration the way Set does.
+     *
+     * Updater might be called more than once if storage has to retry, so it must not do anything but compute
+     * the value. Default implementation is not atomic: Get, then Set or PutIfAbsent, storages that could be
+     * used by several threads must override it
+     *
+     * @param key to update value of
+     * @param update computes new value out of the current one
+     * @return true if new value is stored, false if updater declined or storage failed to store it
+     */
+    virtual bool Update(const std::string &key, const Updater &update) {
+        std::string value;
+        bool present = Get(key, value);
+        if (!update(present, value)) {
+            return false;
+        }
+        return present ? Set(key, value) : PutIfAbsent(key, value);
+    }
+
+    /**
+     * Removes all associations at once. Returns false if storage doesn't support that,
+     * default implementation doesn't
+     */
+    virtual bool Clear() { return false; }
+
+    /**
+     * Retrive value for the given key as a sequence of chunks, concatenation of
+     * chunks is the value. Chunks are immutable and stay valid even if value gets
+     * changed or deleted after method returns.
+     *
+     * In case if given key not found method returns false and doesn't perform
+     * any changes on the output parameter
+     *
+     * @param key to retrive value for
+     * @param chunks output parameter to append value chunks to
+     */
+    virtual bool GetChunks(const std::string &key, std::vector<ValueChunk> &chunks) {
+        std::shared_ptr<std::string> value(new std::string());
+        if (!Get(key, *value)) {
+            return false;
+        }
+        chunks.push_back(std::move(value));
+        return true;
+    }
+
+    /**
+     * Same as GetChunks for each of the given keys in turn, but storage could look them all up at once, for
+     * example under a single lock. Ends gets an entry per key: size of chunks once chunks of the key are
+     * appended, or kMissing if key not found.
+     *
+     * Default implementation calls GetChunks for each key
+     *
+     * @param keys to retrive values for
+     * @param chunks output parameter to append value chunks to
+     * @param ends output parameter to append end of each value chunks to
+     */
+    virtual void GetChunksBatch(const std::vector<const std::string *> &keys, std::vector<ValueChunk> &chunks,
+                                std::vector<std::size_t> &ends) {
+        for (auto key : keys) {
+            ends.push_back(GetChunks(*key, chunks) ? chunks.size() : kMissing);
+        }
+    }
+
+    /**
+     * Walks over stored keys in ascending order and collects keys which starts
+     * with the given prefix. Walk starts from the first key strictly greater than
+     * start (or from the first key with given prefix if start is empty) and stops
+     * once limit keys collected. Scan doesn't change usage order of the keys.
+     *
+     * Single call is expected to be cheap, so large scans must be done as a sequence
+     * of calls, each one passes the last key returned by previous call as start. That
+     * way concurrent writers could make progress between chunks.
+     *
+     * Method returns kMore if there could be more keys with given prefix after the
+     * last collected one and kEnd if walk reached the end of prefix range. Storages
+     * that doesn't support ordered walk returns kUnsupported and leave keys untouched,
+     * default implementation does so.
+     *
+     * @param prefix keys must start with
+     * @param start key to continue walk after, empty to start from the beginning
+     * @param limit maximum number of keys to collect
+     * @param keys output parameter to append found keys to
+     */
+    virtual ScanResult Scan(const std::string &prefix, const std::string &start, std::size_t limit,
+                            std::vector<std::string> &keys) {
+        return ScanResult::kUnsupported;
+    }
+
+    /**
+     * Appends storage statistics in form of name/value pairs, names follow memcached
+     * "stats" command when possible
+     *
+     * @param stats output parameter to append statistics to
+     */
+    virtual void GetStats(std::vector<std::pair<std::string, std::string>> &stats) {}
 };
 
 } // namespace Afina
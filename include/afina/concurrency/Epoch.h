@@ -0,0 +1,108 @@
+#ifndef AFINA_CONCURRENCY_EPOCH_H
+#define AFINA_CONCURRENCY_EPOCH_H
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace Afina {
+namespace Concurrency {
+
+/**
+ * # Epoch based memory reclamation
+ * Lock-free structures can't free memory right after it was unlinked, because some
+ * concurrent reader could still access it. Readers pin the current global epoch for the
+ * duration of an operation, and unlinked memory is retired into the epoch it was unlinked in.
+ * Global epoch advances only when all pinned threads have seen it, so once it moved two
+ * times after the retirement nobody could hold a reference anymore and memory is freed.
+ *
+ * Each thread gets a slot on first use, so the number of threads using the same manager
+ * concurrently is limited by kMaxThreads.
+ */
+class EpochManager {
+public:
+    // Maximum number of threads working with one manager at the same time
+    static const std::size_t kMaxThreads = 256;
+
+    // Number of retirements after which thread tries to advance global epoch
+    static const std::size_t kAdvancePeriod = 64;
+
+    /**
+     * Scoped pin of the current epoch. Memory reachable from the structure at the moment
+     * guard is created stays valid until guard is destroyed
+     */
+    class Guard {
+    public:
+        Guard(EpochManager &manager) : _manager(manager) { _manager.Enter(); }
+        ~Guard() { _manager.Leave(); }
+
+    private:
+        Guard(const Guard &) = delete;
+        Guard &operator=(const Guard &) = delete;
+
+        EpochManager &_manager;
+    };
+
+    EpochManager();
+    ~EpochManager();
+
+    /**
+     * Schedules object to be freed by deleter once no thread could reference it anymore.
+     * Must be called by thread which holds the Guard
+     */
+    void Retire(void *ptr, void (*deleter)(void *));
+
+    /**
+     * Typed version of Retire, object is deleted by operator delete
+     */
+    template <typename T> void Retire(T *ptr) {
+        Retire(static_cast<void *>(ptr), [](void *p) { delete static_cast<T *>(p); });
+    }
+
+private:
+    EpochManager(const EpochManager &) = delete;
+    EpochManager &operator=(const EpochManager &) = delete;
+
+    struct Retired {
+        void *ptr;
+        void (*deleter)(void *);
+    };
+
+    // Per thread state, only owner thread touches fields other than state
+    struct Slot {
+        // (epoch << 1) | active
+        std::atomic<uint64_t> state;
+
+        // Nested guards of the owner thread
+        std::size_t depth;
+
+        // Retired memory for three consequent epochs, indexed by epoch % 3
+        std::vector<Retired> limbo[3];
+        uint64_t limbo_epoch[3];
+
+        std::size_t retired;
+
+        // Avoid false sharing between threads
+        char padding[64];
+    };
+
+    void Enter();
+    void Leave();
+
+    // Tries to move global epoch forward, succeeds if all active threads are in the current one
+    void TryAdvance();
+
+    // Frees limbo lists that are old enough
+    void Collect(Slot &slot, uint64_t epoch);
+
+    static void Free(std::vector<Retired> &list);
+
+    std::atomic<uint64_t> _epoch;
+    Slot _slots[kMaxThreads];
+};
+
+} // namespace Concurrency
+} // namespace Afina
+
+#endif // AFINA_CONCURRENCY_EPOCH_H
@@ -2,32 +2,26 @@
 #define AFINA_CONCURRENCY_EXECUTOR_H
 
 #include <condition_variable>
+#include <deque>
 #include <functional>
 #include <memory>
 #include <mutex>
 #include <queue>
 #include <string>
 #include <thread>
+#include <vector>
 
 namespace Afina {
 namespace Concurrency {
 
 /**
  * # Thread pool
+ * Runs tasks on the fixed number of threads in the order tasks were added. Tasks added by a single thread
+ * start in that order, but several threads run tasks at the same time, so caller that needs tasks to be
+ * done one after another must not add the next one until previous is complete
  */
 class Executor {
-    enum class State {
-        // Threadpool is fully operational, tasks could be added and get executed
-        kRun,
-
-        // Threadpool is on the way to be shutdown, no ned task could be added, but existing will be
-        // completed as requested
-        kStopping,
-
-        // Threadppol is stopped
-        kStopped
-    };
-
+public:
     Executor(std::string name, int size);
     ~Executor();
 
@@ -44,7 +38,7 @@ class Executor {
      * onto execution queue, i.e scheduled for execution and false otherwise.
      *
      * That function doesn't wait for function result. Function could always be written in a way to notify caller about
-     * execution finished by itself
+     * execution finished by itself. Exceptions thrown by the function are dropped
      */
     template <typename F, typename... Types> bool Execute(F &&func, Types... args) {
         // Prepare "task"
@@ -62,6 +56,18 @@ class Executor {
     }
 
 private:
+    enum class State {
+        // Threadpool is fully operational, tasks could be added and get executed
+        kRun,
+
+        // Threadpool is on the way to be shutdown, no ned task could be added, but existing will be
+        // completed as requested
+        kStopping,
+
+        // Threadppol is stopped
+        kStopped
+    };
+
     // No copy/move/assign allowed
     Executor(const Executor &);            // = delete;
     Executor(Executor &&);                 // = delete;
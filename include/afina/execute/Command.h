@@ -1,24 +1,87 @@
 #ifndef AFINA_EXECUTE_COMMAND_H
 #define AFINA_EXECUTE_COMMAND_H
 
+#include <cstdint>
+#include <memory>
 #include <string>
+#include <vector>
+
+#include "OutputSink.h"
+
+namespace spdlog {
+class logger;
+} // namespace spdlog
 
 namespace Afina {
 
 class Storage;
+using ValueChunk = std::shared_ptr<const std::string>;
 
 namespace Execute {
 
+/**
+ * Converts memcached expiration time into time to live for Storage::Touch: 0 means item never expires, values
+ * up to 30 days are seconds from now and larger ones are unix time. Negative result means item is already expired
+ */
+int64_t memcached_ttl(int64_t exptime);
+
+/**
+ * Sets logger commands trace their execution to, at trace level only. Commands don't log anything
+ * until it is set, nullptr turns logging off again. Must not be called while commands are executed
+ */
+void set_logger(std::shared_ptr<spdlog::logger> logger);
+
 /**
  *
  *
  */
 class Command {
 public:
-    Command() {}
+    /**
+     * Commands Dispatcher could execute without virtual calls, any other one is of kOther kind
+     */
+    enum class Kind : uint8_t { kOther, kGet, kSet };
+
+    Command() : _kind(Kind::kOther) {}
     virtual ~Command() {}
 
+    inline Kind kind() const { return _kind; }
+
     virtual void Execute(Storage &storage, const std::string &args, std::string &out) = 0;
+
+    /**
+     * Executes command same way as Execute does, but response is written as a sequence of
+     * chunks: response is a concatenation of all chunks appended to out. That allows commands
+     * to reference values stored in the storage instead of copying them into the response.
+     *
+     * Command that has nothing to reply (quiet or noreply requests) appends no chunks, network layer
+     * sends nothing for it then, not even \r\n.
+     *
+     * Default implementation puts whole response built by Execute as a single chunk
+     */
+    virtual void ExecuteChunked(Storage &storage, const std::string &args, std::vector<ValueChunk> &out);
+
+    /**
+     * Same as ExecuteChunked, but command may take the argument buffer over, for example to keep it in the
+     * storage as is. Argument is left in unspecified state.
+     *
+     * Default implementation calls ExecuteChunked
+     */
+    virtual void ExecuteOwned(Storage &storage, std::string &&args, std::vector<ValueChunk> &out);
+
+    /**
+     * Same as ExecuteOwned, but response goes into the connection output: text is copied into its reusable
+     * buffer and values are referenced, so that network layer sends whole batch with a single writev.
+     *
+     * Default implementation collects chunks of ExecuteOwned right into the sink
+     */
+    virtual void ExecuteTo(Storage &storage, std::string &&args, OutputSink &out);
+
+protected:
+    explicit Command(Kind kind) : _kind(kind) {}
+
+private:
+    const Kind _kind;
 };
 
 } // namespace Execute
@@ -0,0 +1,89 @@
+#ifndef AFINA_EXECUTE_COUNTERS_H
+#define AFINA_EXECUTE_COUNTERS_H
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+
+namespace Afina {
+namespace Execute {
+
+/**
+ * # Server wide statistics counters
+ * Commands and network layer count requests, hits and connections here, stats command reports the totals.
+ *
+ * Every thread increments its own copy of the counters that sits on cache lines of its own, so request path
+ * never writes memory other threads write: that is a thread local pointer check and a plain add. Reader sums
+ * copies of all running threads under the lock, copy of a thread is folded into the common total once thread
+ * exits. Counters are read one by one while threads keep going, so sum is not an atomic snapshot
+ */
+class Counters {
+public:
+    enum Counter : std::size_t {
+        kCmdGet,
+        kGetHits,
+        kGetMisses,
+        kCmdSet,
+        kCmdTouch,
+        kTouchHits,
+        kTouchMisses,
+        kDeleteHits,
+        kDeleteMisses,
+        kCmdFlush,
+
+        // Connections that are open now is a difference of these two
+        kConnectionsOpened,
+        kConnectionsClosed,
+
+        // Requests answered with timeout error instead of being executed
+        kTimedOut,
+
+        // Multi-gets answered from the response cache and the ones that had to be executed
+        kResponseCacheHits,
+        kResponseCacheMisses,
+
+        kCount
+    };
+
+    /**
+     * Counters of a single thread, only the owner thread writes them
+     */
+    struct alignas(64) Slot {
+        std::atomic<uint64_t> values[kCount];
+    };
+
+    /**
+     * Adds value to the counter of the calling thread
+     */
+    static void Add(Counter counter, uint64_t value = 1) {
+        Slot *slot = _local;
+        if (slot == nullptr) {
+            slot = Register();
+        }
+
+        // Single writer: no need in the locked read-modify-write, relaxed store is enough for readers
+        std::atomic<uint64_t> &cell = slot->values[counter];
+        cell.store(cell.load(std::memory_order_relaxed) + value, std::memory_order_relaxed);
+    }
+
+    /**
+     * Sums counters of all threads, the ones already finished included
+     */
+    static void Collect(uint64_t (&totals)[kCount]);
+
+    /**
+     * Sum of a single counter over all threads
+     */
+    static uint64_t Get(Counter counter);
+
+private:
+    // Creates slot of the calling thread and registers it for the readers
+    static Slot *Register();
+
+    static thread_local Slot *_local;
+};
+
+} // namespace Execute
+} // namespace Afina
+
+#endif // AFINA_EXECUTE_COUNTERS_H
@@ -1,6 +1,9 @@
 #ifndef AFINA_EXECUTE_DELETE_H
 #define AFINA_EXECUTE_DELETE_H
 
+#include <cstddef>
+#include <string>
+
 #include "Command.h"
 
 namespace Afina {
@@ -17,10 +20,21 @@ namespace Execute {
  */
 class Delete : public Command {
 public:
-    Delete();
-    ~Delete();
+    Delete() {}
+    Delete(const std::string &key) : _key(key) {}
+    ~Delete() {}
+
+    inline const std::string &key() const { return _key; }
+
+    /**
+     * Reuses command for another request, key buffer is kept
+     */
+    void Reset(const char *key, std::size_t size) { _key.assign(key, size); }
 
     void Execute(Storage &storage, const std::string &args, std::string &out) override;
+
+private:
+    std::string _key;
 };
 
 } // namespace Execute
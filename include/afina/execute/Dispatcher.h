@@ -0,0 +1,83 @@
+#ifndef AFINA_EXECUTE_DISPATCHER_H
+#define AFINA_EXECUTE_DISPATCHER_H
+
+#include <cstddef>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "Command.h"
+#include "Get.h"
+#include "OutputSink.h"
+#include "Set.h"
+
+namespace Afina {
+namespace Execute {
+
+/**
+ * # Executes commands on the storage
+ * Network services run every command through the dispatcher they are given. Base one just calls
+ * Command::ExecuteTo, so it works with any storage, paying a virtual call for the command and one more
+ * for each storage call it makes
+ */
+class Dispatcher {
+public:
+    Dispatcher() {}
+    virtual ~Dispatcher() {}
+
+    virtual void ExecuteTo(Storage &storage, Command &command, std::string &&args, OutputSink &out) {
+        command.ExecuteTo(storage, std::move(args), out);
+    }
+
+    /**
+     * Executes consecutive gets at once, see Get::ExecuteBatch
+     */
+    virtual void ExecuteGets(Storage &storage, Get *const *gets, std::size_t count, OutputSink &out) {
+        Get::ExecuteBatch(storage, gets, count, out);
+    }
+
+    /**
+     * Looks up value of the single key get for the protocols that don't build text responses,
+     * see Get::ExecuteValue
+     */
+    virtual bool ExecuteValue(Storage &storage, Get &get, std::vector<ValueChunk> &value) {
+        return get.ExecuteValue(storage, value);
+    }
+};
+
+/**
+ * # Dispatcher for the storage of the known type
+ * Storage passed must be of type S or derived from it. Hot commands are executed by their templated bodies,
+ * so storage calls are direct and inlined once S is final, while commands of other kinds go through the
+ * virtual call as usual. That leaves a single well predicted indirect call per command, the one to the
+ * dispatcher itself, that is picked once at startup
+ */
+template <typename S> class StaticDispatcher : public Dispatcher {
+public:
+    void ExecuteTo(Storage &storage, Command &command, std::string &&args, OutputSink &out) override {
+        S &concrete = static_cast<S &>(storage);
+        switch (command.kind()) {
+        case Command::Kind::kGet:
+            static_cast<Get &>(command).ExecuteOn(concrete, out);
+            break;
+        case Command::Kind::kSet:
+            static_cast<Set &>(command).ExecuteOn(concrete, std::move(args), out);
+            break;
+        default:
+            command.ExecuteTo(storage, std::move(args), out);
+        }
+    }
+
+    void ExecuteGets(Storage &storage, Get *const *gets, std::size_t count, OutputSink &out) override {
+        Get::ExecuteBatch(static_cast<S &>(storage), gets, count, out);
+    }
+
+    bool ExecuteValue(Storage &storage, Get &get, std::vector<ValueChunk> &value) override {
+        return get.ExecuteValueOn(static_cast<S &>(storage), value);
+    }
+};
+
+} // namespace Execute
+} // namespace Afina
+
+#endif // AFINA_EXECUTE_DISPATCHER_H
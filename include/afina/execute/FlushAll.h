@@ -0,0 +1,40 @@
+#ifndef AFINA_EXECUTE_FLUSH_ALL_H
+#define AFINA_EXECUTE_FLUSH_ALL_H
+
+#include <cstdint>
+#include <string>
+
+#include "Command.h"
+
+namespace Afina {
+namespace Execute {
+
+/**
+ * # Invalidate all the items
+ * flush_all [delay] [noreply]
+ *
+ * Drops every item from the storage right away. Delayed invalidation is not
+ * supported, so delay must be 0 if present
+ *
+ * Command must write result to the output, which could be:
+ * - "OK" to indicate success
+ * - "SERVER_ERROR ..." if storage can't be cleared
+ * - "CLIENT_ERROR ..." if delay is given
+ */
+class FlushAll : public Command {
+public:
+    FlushAll(int32_t delay) : _delay(delay) {}
+    ~FlushAll() {}
+
+    inline const int32_t delay() const { return _delay; }
+
+    void Execute(Storage &storage, const std::string &args, std::string &out) override;
+
+private:
+    const int32_t _delay;
+};
+
+} // namespace Execute
+} // namespace Afina
+
+#endif // AFINA_EXECUTE_FLUSH_ALL_H
@@ -0,0 +1,50 @@
+#ifndef AFINA_EXECUTE_GAT_H
+#define AFINA_EXECUTE_GAT_H
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "Get.h"
+
+namespace Afina {
+namespace Execute {
+
+/**
+ * # Get and touch
+ * gat <exptime> <key>*
+ *
+ * Updates expiration time of every existing key, the same way as touch does, and
+ * then responds exactly like get. Values are not rewritten
+ */
+class Gat : public Get {
+public:
+    Gat() : Get(Kind::kOther, std::vector<std::string>()), _expire(0) {}
+    Gat(int32_t expire, std::vector<std::string> &&keys) : Get(Kind::kOther, std::move(keys)), _expire(expire) {}
+    ~Gat() {}
+
+    inline const int32_t expire() const { return _expire; }
+
+    // See Get::Reset
+    std::vector<std::string> &Reset(int32_t expire, std::size_t count) {
+        _expire = expire;
+        return Get::Reset(count);
+    }
+
+    void Execute(Storage &storage, const std::string &args, std::string &out) override;
+    void ExecuteChunked(Storage &storage, const std::string &args, std::vector<ValueChunk> &out) override;
+    void ExecuteTo(Storage &storage, std::string &&args, OutputSink &out) override;
+
+private:
+    // Sets new expiration time of all the keys
+    void TouchKeys(Storage &storage) const;
+
+    int32_t _expire;
+};
+
+} // namespace Execute
+} // namespace Afina
+
+#endif // AFINA_EXECUTE_GAT_H
@@ -1,9 +1,13 @@
 #ifndef AFINA_EXECUTE_GET_H
 #define AFINA_EXECUTE_GET_H
 
+#include <cstddef>
 #include <string>
+#include <utility>
 #include <vector>
 
+#include <afina/Storage.h>
+
 #include "Command.h"
 
 namespace Afina {
@@ -34,17 +38,159 @@ namespace Execute {
  */
 class Get : public Command {
 public:
-    Get(const std::vector<std::string> &keys) : _keys(keys) {}
+    Get() : Command(Kind::kGet) {}
+    Get(const std::vector<std::string> &keys) : Command(Kind::kGet), _keys(keys) {}
+    Get(std::vector<std::string> &&keys) : Command(Kind::kGet), _keys(std::move(keys)) {}
     ~Get() {}
 
     inline const std::vector<std::string> &keys() const { return _keys; }
 
+    /**
+     * Reuses command for another request with the given number of keys. Key buffers are kept, caller assigns
+     * keys through the returned list
+     */
+    std::vector<std::string> &Reset(std::size_t count);
+
     void Execute(Storage &storage, const std::string &args, std::string &out) override;
 
+    // Values are referenced from the storage, not copied. See Command.h
+    void ExecuteChunked(Storage &storage, const std::string &args, std::vector<ValueChunk> &out) override;
+
+    // Headers are written into the sink buffer, values are referenced. See Command.h
+    void ExecuteTo(Storage &storage, std::string &&args, OutputSink &out) override;
+
+    /**
+     * Looks up the only key of the command: chunks of its value are appended to the list, returns false if
+     * there is none. Traced and counted as any other get, for the protocols that don't build text responses
+     */
+    bool ExecuteValue(Storage &storage, std::vector<ValueChunk> &value);
+
+    /**
+     * ExecuteValue on the storage of known type, see ExecuteOn
+     */
+    template <typename S> bool ExecuteValueOn(S &storage, std::vector<ValueChunk> &value);
+
+    /**
+     * ExecuteTo on the storage of known type, storage calls are resolved at compile time if S is final.
+     * Returns number of keys found. See Dispatcher
+     */
+    template <typename S> std::size_t ExecuteOn(S &storage, OutputSink &out);
+
+    /**
+     * Executes consecutive gets of a pipeline at once: keys of all of them are looked up by a single
+     * Storage::GetChunksBatch call, then responses are written one after another. Each response is
+     * terminated with \r\n, the way network layer terminates response of a single command
+     */
+    template <typename S> static void ExecuteBatch(S &storage, Get *const *gets, std::size_t count, OutputSink &out);
+
+protected:
+    // Commands derived from get are of their own kind
+    Get(Kind kind, std::vector<std::string> &&keys) : Command(kind), _keys(std::move(keys)) {}
+
 private:
+    // Cache answers gets without executing them, yet traces and counts them the same way
+    friend class ResponseCache;
+
+    // Traces command along with all its keys if logger wants it
+    void LogKeys() const;
+
+    // Adds keys requested and found to the server stats
+    void Count(std::size_t hits) const;
+
     std::vector<std::string> _keys;
+
+    // Buffers of the keys dropped by Reset, taken back once more keys are needed
+    std::vector<std::string> _spare;
 };
 
+// See Get.h
+template <typename S> std::size_t Get::ExecuteOn(S &storage, OutputSink &out) {
+    LogKeys();
+
+    // Chunks are fetched right into the sink, header goes before them once value size is known
+    std::vector<ValueChunk> &values = out.Values();
+    std::size_t hits = 0;
+    for (auto &key : _keys) {
+        std::size_t from = values.size();
+        if (!storage.GetChunks(key, values)) {
+            continue;
+        }
+        hits++;
+
+        std::size_t size = 0;
+        for (std::size_t i = from; i < values.size(); i++) {
+            size += values[i]->size();
+        }
+
+        out.Append("VALUE ", 6);
+        out.Append(key);
+        out.Append(" 0 ", 3);
+        out.AppendNumber(size);
+        out.Append("\r\n", 2);
+        out.Reference(from);
+        out.Append("\r\n", 2);
+    }
+    Count(hits);
+    out.Append("END", 3); // networking layer should add the last \r\n
+    return hits;
+}
+
+// See Get.h
+template <typename S> bool Get::ExecuteValueOn(S &storage, std::vector<ValueChunk> &value) {
+    LogKeys();
+    bool found = storage.GetChunks(_keys.front(), value);
+    Count(found ? 1 : 0);
+    return found;
+}
+
+// See Get.h
+template <typename S> void Get::ExecuteBatch(S &storage, Get *const *gets, std::size_t count, OutputSink &out) {
+    // Lists are owned by the sink, so their memory is reused by the following batches
+    std::vector<const std::string *> &keys = out.BatchKeys();
+    std::vector<std::size_t> &ends = out.BatchEnds();
+    keys.clear();
+    ends.clear();
+    for (std::size_t i = 0; i < count; i++) {
+        gets[i]->LogKeys();
+        for (auto &key : gets[i]->_keys) {
+            keys.push_back(&key);
+        }
+    }
+
+    std::vector<ValueChunk> &values = out.Values();
+    std::size_t from = values.size();
+    storage.GetChunksBatch(keys, values, ends);
+
+    // Values are fetched already, each one starts where the previous found one ends
+    auto end = ends.begin();
+    for (std::size_t i = 0; i < count; i++) {
+        std::size_t hits = 0;
+        for (auto &key : gets[i]->_keys) {
+            std::size_t to = *end++;
+            if (to == Storage::kMissing) {
+                continue;
+            }
+            hits++;
+
+            std::size_t size = 0;
+            for (std::size_t k = from; k < to; k++) {
+                size += values[k]->size();
+            }
+
+            out.Append("VALUE ", 6);
+            out.Append(key);
+            out.Append(" 0 ", 3);
+            out.AppendNumber(size);
+            out.Append("\r\n", 2);
+            out.Reference(from, to);
+            out.Append("\r\n", 2);
+            from = to;
+        }
+        gets[i]->Count(hits);
+        out.Append("END\r\n", 5);
+    }
+}
+
 } // namespace Execute
 } // namespace Afina
 
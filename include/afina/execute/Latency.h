@@ -0,0 +1,159 @@
+#ifndef AFINA_EXECUTE_LATENCY_H
+#define AFINA_EXECUTE_LATENCY_H
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace Afina {
+namespace Execute {
+
+/**
+ * # Log-linear latency histogram
+ * Buckets are laid out the way HdrHistogram does: values below 2 * kSubBuckets get a bucket each, every next
+ * power of two range is split into kSubBuckets equal buckets. So bucket is never wider than 1/16 of the values
+ * it holds, while whole range up to 2^kMaxBits nanoseconds (about 18 minutes) takes less than 5K of counters.
+ * Larger values go to the last bucket.
+ *
+ * Only one thread records into a histogram, any thread could read it
+ */
+class Histogram {
+public:
+    static const unsigned kSubBits = 4;
+    static const unsigned kSubBuckets = 1u << kSubBits;
+    static const unsigned kMaxBits = 40;
+    static const std::size_t kBuckets = (kMaxBits - kSubBits + 1) * kSubBuckets;
+
+    using Counts = uint64_t[kBuckets];
+
+    Histogram() {
+        for (auto &count : _counts) {
+            count.store(0, std::memory_order_relaxed);
+        }
+    }
+
+    /**
+     * Bucket the value goes to
+     */
+    static std::size_t Bucket(uint64_t value) {
+        if (value < 2 * kSubBuckets) {
+            return value;
+        }
+        if (value >= (uint64_t(1) << kMaxBits)) {
+            return kBuckets - 1;
+        }
+
+        unsigned shift = 63 - __builtin_clzll(value) - kSubBits;
+        return (shift << kSubBits) + (value >> shift);
+    }
+
+    /**
+     * Largest value that goes to the given bucket
+     */
+    static uint64_t Highest(std::size_t bucket) {
+        if (bucket < 2 * kSubBuckets) {
+            return bucket;
+        }
+        unsigned shift = bucket / kSubBuckets - 1;
+        uint64_t top = bucket % kSubBuckets + kSubBuckets;
+        return ((top + 1) << shift) - 1;
+    }
+
+    /**
+     * Value that given share (0.99 for p99) of the recorded values don't exceed, up to bucket precision.
+     * Returns 0 if nothing is recorded
+     */
+    static uint64_t Percentile(const Counts &counts, double share);
+
+    /**
+     * Counts value, owner thread only
+     */
+    void Record(uint64_t value) {
+        // Single writer: no need in the locked read-modify-write
+        std::atomic<uint64_t> &cell = _counts[Bucket(value)];
+        cell.store(cell.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+    }
+
+    /**
+     * Adds counts of the histogram to the given ones
+     */
+    void Collect(Counts &counts) const;
+
+    /**
+     * Adds given counts to the histogram, caller must be the only writer
+     */
+    void Merge(const Counts &counts);
+
+private:
+    std::atomic<uint64_t> _counts[kBuckets];
+};
+
+/**
+ * # Latency of the requests served
+ * Histograms are kept for each pair of backend (network service that measures) and series (what is
+ * measured, like "get:execute"), both are registered by name once and referred by index then.
+ *
+ * Threads record into histograms of their own, created on the first record, so recording is a thread local
+ * pointer check and a plain add. Readers merge histograms of all threads under the lock, histograms of
+ * the thread are folded into the common ones once thread exits. See Counters, it works the same way
+ */
+class Latency {
+public:
+    static const std::size_t kMaxBackends = 8;
+    static const std::size_t kMaxSeries = 64;
+
+    struct Slot {
+        std::atomic<Histogram *> histograms[kMaxBackends][kMaxSeries];
+    };
+
+    /**
+     * Returns index of the backend or series with the given name, registers it if there is none yet.
+     * Throws runtime_error once there is no more room
+     */
+    static std::size_t Backend(const std::string &name);
+    static std::size_t Series(const std::string &name);
+
+    /**
+     * Records value in nanoseconds into the histogram of the calling thread
+     */
+    static void Record(std::size_t backend, std::size_t series, uint64_t value) {
+        Slot *slot = _local;
+        if (slot == nullptr) {
+            slot = Register();
+        }
+
+        Histogram *histogram = slot->histograms[backend][series].load(std::memory_order_relaxed);
+        if (histogram == nullptr) {
+            histogram = Create(backend, series);
+        }
+        histogram->Record(value);
+    }
+
+    /**
+     * Sums histograms of all threads for the given backend and series
+     */
+    static void Collect(std::size_t backend, std::size_t series, Histogram::Counts &counts);
+
+    /**
+     * Appends count, p50, p99, p999 and max in nanoseconds of every non-empty histogram as
+     * "<backend>:<series>:<stat>" pairs
+     */
+    static void Report(std::vector<std::pair<std::string, std::string>> &stats);
+
+private:
+    // Creates slot of the calling thread and registers it for the readers
+    static Slot *Register();
+
+    // Creates histogram in the slot of the calling thread
+    static Histogram *Create(std::size_t backend, std::size_t series);
+
+    static thread_local Slot *_local;
+};
+
+} // namespace Execute
+} // namespace Afina
+
+#endif // AFINA_EXECUTE_LATENCY_H
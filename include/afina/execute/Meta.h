@@ -0,0 +1,170 @@
+#ifndef AFINA_EXECUTE_META_H
+#define AFINA_EXECUTE_META_H
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "Command.h"
+
+namespace Afina {
+namespace Execute {
+
+/**
+ * # Basic class for all meta commands
+ * Meta commands take a key followed by a list of single letter flags, some of flags carry a token right
+ * after the letter: "mg foo v k Oabc". Flags common for all meta commands:
+ * - q: quiet mode, response that means "as expected" (HD, EN, NF depending on command) is not sent at all,
+ *   so clients could pipeline commands and wait for the final "mn"
+ * - O<opaque>: token copied into response as is, to match responses with requests
+ * - k: return key in response
+ * - L<milliseconds>: deadline of the request, it is answered with "SERVER_ERROR timeout" instead of being
+ *   executed if it has waited longer than that since it was read. Server timeout still applies, so the
+ *   earlier of two deadlines wins; L0 means client has no deadline of its own
+ *
+ * Response is a status code followed by return flags: "HD k<key> O<opaque>". If command writes nothing to
+ * the output, network layer sends nothing as well.
+ */
+class MetaCommand : public Command {
+public:
+    MetaCommand(const std::string &key, const std::vector<std::string> &flags);
+    ~MetaCommand() {}
+
+    inline const std::string &key() const { return _key; }
+    inline bool quiet() const { return Has('q'); }
+
+    /**
+     * Checks if flag is given
+     */
+    bool Has(char flag) const;
+
+    /**
+     * Returns token of the flag, empty string if flag is not given or has no token
+     */
+    const std::string &Token(char flag) const;
+
+    /**
+     * Builds the whole response by concatenation of chunks
+     */
+    void Execute(Storage &storage, const std::string &args, std::string &out) override;
+    void ExecuteChunked(Storage &storage, const std::string &args, std::vector<ValueChunk> &out) override = 0;
+
+protected:
+    /**
+     * Appends requested return flags that doesn't depend on the value: k and O
+     */
+    void AppendReturnFlags(std::string &out) const;
+
+    const std::string _key;
+
+    // Flags in the order given by client along with their tokens
+    std::vector<std::pair<char, std::string>> _flags;
+};
+
+/**
+ * # Meta get
+ * mg <key> <flags>*
+ *
+ * Returns only fields client asked for:
+ * - v: return value, response is "VA <size> <flags>*\r\n<data>"; otherwise "HD <flags>*"
+ * - s: return value size as s<size>
+ * - f: return client flags as f<flags>, always 0 as storage doesn't keep them, the same way get reports
+ * - t: return remaining TTL in seconds as t<ttl>, -1 if key never expires
+ *
+ * Miss is reported as "EN", omitted in quiet mode
+ */
+class MetaGet : public MetaCommand {
+public:
+    MetaGet(const std::string &key, const std::vector<std::string> &flags) : MetaCommand(key, flags) {}
+    ~MetaGet() {}
+
+    void ExecuteChunked(Storage &storage, const std::string &args, std::vector<ValueChunk> &out) override;
+};
+
+/**
+ * # Meta set
+ * ms <key> <datalen> <flags>*\r\n<data>
+ *
+ * Flag M<mode> selects the way value is stored: S - set (default), E - add, A - append, P - prepend,
+ * R - replace. Flag T<ttl> sets expiration of stored value, see memcached_ttl for the format, append and
+ * prepend keep expiration of the key. Flag F<flags> is accepted but ignored as storage doesn't keep flags.
+ *
+ * Response is "HD" if value was stored, omitted in quiet mode, or "NS" otherwise
+ */
+class MetaSet : public MetaCommand {
+public:
+    MetaSet(const std::string &key, const std::vector<std::string> &flags);
+    ~MetaSet() {}
+
+    void ExecuteChunked(Storage &storage, const std::string &args, std::vector<ValueChunk> &out) override;
+
+private:
+    char _mode;
+    int64_t _expire;
+};
+
+/**
+ * # Meta delete
+ * md <key> <flags>*
+ *
+ * Response is "HD" if key was deleted or "NF" if there was no such key, both omitted in quiet mode
+ */
+class MetaDelete : public MetaCommand {
+public:
+    MetaDelete(const std::string &key, const std::vector<std::string> &flags) : MetaCommand(key, flags) {}
+    ~MetaDelete() {}
+
+    void ExecuteChunked(Storage &storage, const std::string &args, std::vector<ValueChunk> &out) override;
+};
+
+/**
+ * # Meta arithmetic
+ * ma <key> <flags>*
+ *
+ * Increments or decrements decimal value stored for the key:
+ * - M<mode>: I or + to increment (default), D or - to decrement
+ * - D<delta>: delta, 1 by default
+ * - N<ttl>: create missing item with initial value, it expires after ttl, see memcached_ttl for the format
+ * - J<initial>: initial value for N, 0 by default
+ * - v: return new value, response is "VA <size> <flags>*\r\n<number>"
+ *
+ * Increment wraps around 64 bits, decrement stops at 0. Response is "HD" on success, omitted in quiet mode,
+ * "NF" if key is missing, omitted in quiet mode, or "NS" if value is not a number.
+ *
+ * Value is read and written back by a single Storage::Update, so concurrent arithmetic on the same key never
+ * loses updates
+ */
+class MetaArithmetic : public MetaCommand {
+public:
+    MetaArithmetic(const std::string &key, const std::vector<std::string> &flags);
+    ~MetaArithmetic() {}
+
+    void ExecuteChunked(Storage &storage, const std::string &args, std::vector<ValueChunk> &out) override;
+
+private:
+    bool _increment;
+    uint64_t _delta;
+    uint64_t _initial;
+    int64_t _expire;
+};
+
+/**
+ * # Meta no-op
+ * mn
+ *
+ * Always responds "MN", used as the end marker of a quiet pipeline
+ */
+class MetaNoop : public Command {
+public:
+    MetaNoop() {}
+    ~MetaNoop() {}
+
+    void Execute(Storage &storage, const std::string &args, std::string &out) override;
+};
+
+} // namespace Execute
+} // namespace Afina
+
+#endif // AFINA_EXECUTE_META_H
@@ -0,0 +1,140 @@
+#ifndef AFINA_EXECUTE_OUTPUT_SINK_H
+#define AFINA_EXECUTE_OUTPUT_SINK_H
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include <sys/uio.h>
+
+namespace Afina {
+
+using ValueChunk = std::shared_ptr<const std::string>;
+
+namespace Execute {
+
+/**
+ * # Response of the connection
+ * Commands write response as a sequence of parts: short text fragments (headers, statuses, \r\n) are copied
+ * into the single buffer of the sink, while value bytes are referenced right in the storage chunks that are
+ * kept alive by the sink. Once batch of commands is executed, whole output is described by an iovec array
+ * and goes out with writev, nothing is concatenated.
+ *
+ * Sink is meant to live as long as connection does: Clear keeps capacity of all its buffers, so after a few
+ * requests writing response allocates nothing.
+ */
+class OutputSink {
+public:
+    /**
+     * Position in the output, see Truncate
+     */
+    struct Mark {
+        std::size_t buffer;
+        std::size_t values;
+        std::size_t parts;
+    };
+
+    OutputSink() {}
+    ~OutputSink() {}
+
+    /**
+     * Copies bytes into the output
+     */
+    void Append(const char *data, std::size_t size);
+    void Append(const std::string &text) { Append(text.data(), text.size()); }
+    void Append(const char *text);
+
+    /**
+     * Writes decimal representation of the number into the output
+     */
+    void AppendNumber(uint64_t number);
+
+    /**
+     * Storage of the value chunks referenced by the output. Command could fetch chunks right here, for example
+     * with Storage::GetChunks, they are kept alive but not sent until passed to Reference
+     */
+    std::vector<ValueChunk> &Values() { return _values; }
+
+    /**
+     * Scratch lists of the batched lookup, see Get::ExecuteBatch. Content is meaningful only during a single
+     * batch, sink keeps them to reuse their memory, so that batches allocate nothing either
+     */
+    std::vector<const std::string *> &BatchKeys() { return _batch_keys; }
+    std::vector<std::size_t> &BatchEnds() { return _batch_ends; }
+
+    /**
+     * Adds chunks of Values() starting from the given index to the output, bytes are not copied
+     */
+    void Reference(std::size_t from) { Reference(from, _values.size()); }
+
+    /**
+     * Adds chunks of Values() in the [from, to) range to the output, bytes are not copied
+     */
+    void Reference(std::size_t from, std::size_t to);
+
+    /**
+     * Adds single chunk to the output, bytes are not copied
+     */
+    void Reference(ValueChunk chunk);
+
+    /**
+     * Current end of the output
+     */
+    Mark Position() const { return Mark{_buffer.size(), _values.size(), _parts.size()}; }
+
+    /**
+     * Drops everything written after the given position, used for responses client doesn't want
+     */
+    void Truncate(const Mark &mark);
+
+    /**
+     * Number of bytes written after the given position
+     */
+    std::size_t Written(const Mark &mark) const;
+
+    /**
+     * Appends bytes written after the given position to the string
+     */
+    void CopyTo(const Mark &mark, std::string &out) const;
+
+    /**
+     * Number of bytes in the output
+     */
+    std::size_t Size() const { return Written(Mark{0, 0, 0}); }
+    bool Empty() const { return _parts.empty(); }
+
+    /**
+     * Describes whole output as an iovec array. Array is owned by the sink and stays valid until the sink is
+     * modified, caller may change it while sending data out
+     */
+    std::vector<struct iovec> &Iov();
+
+    /**
+     * Drops whole output, memory is kept for the following responses
+     */
+    void Clear();
+
+private:
+    // Part of the output: either bytes of the text buffer or the whole value chunk
+    struct Part {
+        std::size_t value; // index in _values, kText for the text buffer
+        std::size_t offset;
+        std::size_t size;
+    };
+
+    static const std::size_t kText = SIZE_MAX;
+
+    std::string _buffer;
+    std::vector<ValueChunk> _values;
+    std::vector<Part> _parts;
+    std::vector<struct iovec> _iov;
+    std::vector<const std::string *> _batch_keys;
+    std::vector<std::size_t> _batch_ends;
+};
+
+} // namespace Execute
+} // namespace Afina
+
+#endif // AFINA_EXECUTE_OUTPUT_SINK_H
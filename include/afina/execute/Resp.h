@@ -0,0 +1,174 @@
+#ifndef AFINA_EXECUTE_RESP_H
+#define AFINA_EXECUTE_RESP_H
+
+#include <cstdint>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "Command.h"
+
+namespace Afina {
+namespace Execute {
+
+/**
+ * # Basic class for Redis protocol (RESP2) commands
+ * Response is a single RESP2 reply without the final \r\n, network layer adds it the same way it does
+ * for memcached commands:
+ * - "+OK": simple string
+ * - "-ERR <message>": error
+ * - ":<number>": integer
+ * - "$<size>\r\n<data>": bulk string, "$-1" is null
+ */
+class RespCommand : public Command {
+public:
+    RespCommand() {}
+    ~RespCommand() {}
+
+    /**
+     * Parses decimal signed 64 bit integer the way Redis does: no spaces, no plus sign, no overflow
+     */
+    static bool ParseInteger(const std::string &token, int64_t &number);
+
+    /**
+     * Builds the whole response by concatenation of chunks
+     */
+    void Execute(Storage &storage, const std::string &args, std::string &out) override;
+    void ExecuteChunked(Storage &storage, const std::string &args, std::vector<ValueChunk> &out) override = 0;
+};
+
+/**
+ * # Redis GET
+ * GET <key>
+ *
+ * Responds with value as bulk string, sent right out of the storage chunks, or null if key is missing
+ */
+class RespGet : public RespCommand {
+public:
+    RespGet(const std::string &key) : _key(key) {}
+    ~RespGet() {}
+
+    void ExecuteChunked(Storage &storage, const std::string &args, std::vector<ValueChunk> &out) override;
+
+private:
+    const std::string _key;
+};
+
+/**
+ * # Redis SET
+ * SET <key> <value> [EX <seconds> | PX <milliseconds>] [NX | XX]
+ *
+ * Value comes as command argument. NX stores value only if key is absent, XX only if key is present,
+ * responds null if value wasn't stored and "+OK" otherwise. Value stored without EX/PX never expires
+ */
+class RespSet : public RespCommand {
+public:
+    enum class Condition { Always, IfAbsent, IfPresent };
+
+    RespSet(const std::string &key, Condition condition, int64_t ttl)
+        : _key(key), _condition(condition), _ttl(ttl) {}
+    ~RespSet() {}
+
+    void ExecuteChunked(Storage &storage, const std::string &args, std::vector<ValueChunk> &out) override;
+
+    /**
+     * Plain SET hands argument buffer over to the storage
+     */
+    void ExecuteOwned(Storage &storage, std::string &&args, std::vector<ValueChunk> &out) override;
+
+private:
+    const std::string _key;
+    const Condition _condition;
+    const int64_t _ttl;
+};
+
+/**
+ * # Redis DEL
+ * DEL <key> [<key> ...]
+ *
+ * Responds with number of keys deleted
+ */
+class RespDelete : public RespCommand {
+public:
+    RespDelete(std::vector<std::string> &&keys) : _keys(std::move(keys)) {}
+    ~RespDelete() {}
+
+    void ExecuteChunked(Storage &storage, const std::string &args, std::vector<ValueChunk> &out) override;
+
+private:
+    const std::vector<std::string> _keys;
+};
+
+/**
+ * # Redis INCR, INCRBY, DECR, DECRBY
+ * INCR <key>
+ *
+ * Adds delta to the signed 64 bit number stored for the key, missing key counts as 0. Expiration of the
+ * key is kept. Responds with the new number, or error if value isn't a number or result overflows.
+ *
+ * Value is read and written back by a single Storage::Update, so concurrent arithmetic on the same key never
+ * loses updates
+ */
+class RespIncrement : public RespCommand {
+public:
+    RespIncrement(const std::string &key, int64_t delta) : _key(key), _delta(delta) {}
+    ~RespIncrement() {}
+
+    void ExecuteChunked(Storage &storage, const std::string &args, std::vector<ValueChunk> &out) override;
+
+private:
+    const std::string _key;
+    const int64_t _delta;
+};
+
+/**
+ * # Redis EXPIRE
+ * EXPIRE <key> <seconds>
+ *
+ * Sets time to live of the key, key with zero or negative ttl is deleted right away. Responds with 1 if
+ * key exists and 0 otherwise
+ */
+class RespExpire : public RespCommand {
+public:
+    RespExpire(const std::string &key, int64_t ttl) : _key(key), _ttl(ttl) {}
+    ~RespExpire() {}
+
+    void ExecuteChunked(Storage &storage, const std::string &args, std::vector<ValueChunk> &out) override;
+
+private:
+    const std::string _key;
+    const int64_t _ttl;
+};
+
+/**
+ * # Redis PING
+ * Always responds "+PONG", clients use it to check connection
+ */
+class RespPing : public Command {
+public:
+    RespPing() {}
+    ~RespPing() {}
+
+    void Execute(Storage &storage, const std::string &args, std::string &out) override;
+};
+
+/**
+ * # Redis error reply
+ * Request parser builds it for the commands it can't execute: unknown commands, wrong number of
+ * arguments, malformed options. Responds "-ERR <message>"
+ */
+class RespError : public Command {
+public:
+    RespError(const std::string &message) : _message(message) {}
+    ~RespError() {}
+
+    void Execute(Storage &storage, const std::string &args, std::string &out) override;
+
+private:
+    const std::string _message;
+};
+
+} // namespace Execute
+} // namespace Afina
+
+#endif // AFINA_EXECUTE_RESP_H
@@ -0,0 +1,94 @@
+#ifndef AFINA_EXECUTE_RESPONSE_CACHE_H
+#define AFINA_EXECUTE_RESPONSE_CACHE_H
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "Dispatcher.h"
+
+namespace Afina {
+namespace Backend {
+class Versioned;
+}
+
+namespace Execute {
+
+/**
+ * # Responses of the hot multi-gets
+ * Clients that keep asking for the same set of keys get the response built once: it is kept for a short
+ * lifetime keyed by the requested keys and sent as a single referenced chunk, no storage lookups and no
+ * copies. Gets of a single key and commands of other kinds go to the next dispatcher as usual.
+ *
+ * Storage passed must be Backend::Versioned: versions of the keys are remembered before the response is
+ * built, any change of them makes cached response stale. Values that expire or get evicted don't change
+ * versions, so they could be served for up to the lifetime after that, that is the price of the cache.
+ *
+ * Hits and misses are counted, see stats
+ */
+class ResponseCache : public Dispatcher {
+public:
+    // Shards of the cache, each one has a lock and a map of its own
+    static const std::size_t kShards = 16;
+
+    // Responses kept per shard at most
+    static const std::size_t kShardCapacity = 256;
+
+    /**
+     * Caches responses for the given number of milliseconds, commands it doesn't cache go to the next
+     * dispatcher, that must work with the Versioned storage
+     */
+    ResponseCache(std::shared_ptr<Dispatcher> next, uint32_t lifetime);
+    ~ResponseCache() {}
+
+    void ExecuteTo(Storage &storage, Command &command, std::string &&args, OutputSink &out) override;
+
+    // Multi-gets of the pipeline are answered one by one, the rest are still coalesced
+    void ExecuteGets(Storage &storage, Get *const *gets, std::size_t count, OutputSink &out) override;
+
+    // Single key is never cached, value goes to the next dispatcher
+    bool ExecuteValue(Storage &storage, Get &get, std::vector<ValueChunk> &value) override {
+        return _next->ExecuteValue(storage, get, value);
+    }
+
+private:
+    // Response along with versions of the keys it was built on
+    struct Entry {
+        ValueChunk response;
+        std::size_t hits;
+        uint64_t expires;
+        std::vector<std::size_t> slots;
+        std::vector<uint64_t> versions;
+    };
+
+    struct Shard {
+        std::mutex lock;
+        std::unordered_map<std::string, std::shared_ptr<const Entry>> entries;
+    };
+
+    // Writes response of the multi-get, from the cache if it is still fresh
+    void Execute(Backend::Versioned &storage, Get &get, OutputSink &out);
+
+    // Response is still the one storage would give
+    static bool Fresh(const Backend::Versioned &storage, const Entry &entry, uint64_t now);
+
+    // Adds entry to the shard, once shard is full stale entries are dropped or an arbitrary one if there are none
+    void Insert(Shard &shard, const Backend::Versioned &storage, std::string &&key,
+                std::shared_ptr<const Entry> &&entry, uint64_t now);
+
+    std::shared_ptr<Dispatcher> _next;
+
+    // Lifetime of the response in nanoseconds
+    const uint64_t _lifetime;
+
+    Shard _shards[kShards];
+};
+
+} // namespace Execute
+} // namespace Afina
+
+#endif // AFINA_EXECUTE_RESPONSE_CACHE_H
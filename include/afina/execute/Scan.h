@@ -0,0 +1,57 @@
+#ifndef AFINA_EXECUTE_SCAN_H
+#define AFINA_EXECUTE_SCAN_H
+
+#include <cstddef>
+#include <string>
+
+#include "Command.h"
+
+namespace Afina {
+namespace Execute {
+
+/**
+ * # Walk over keys with the given prefix
+ * Lists keys which start with the prefix in ascending order. Walk starts right after
+ * the given start key (or from the beginning of prefix range if start is empty) and
+ * returns no more than limit keys.
+ *
+ * Storage is walked in small chunks so that writers are not blocked for the whole
+ * scan. Keys added or removed concurrently might or might not be returned.
+ *
+ * Command writes each key as a separate line and finishes response with END:
+ * KEY <key>\r\n
+ * KEY ....
+ * END
+ *
+ * In case if response was truncated by limit, client could continue walk by passing the
+ * last returned key as start. Storages that can't walk keys in order answer with
+ * "SERVER_ERROR scan is not supported by the storage" instead
+ */
+class Scan : public Command {
+public:
+    // Number of keys returned if client doesn't ask for a specific limit
+    static const std::size_t kDefaultLimit = 100;
+
+    // Maximum number of keys collected from storage in a single call
+    static const std::size_t kChunkSize = 64;
+
+    Scan(const std::string &prefix, const std::string &start, std::size_t limit)
+        : _prefix(prefix), _start(start), _limit(limit) {}
+    ~Scan() {}
+
+    inline const std::string &prefix() const { return _prefix; }
+    inline const std::string &start() const { return _start; }
+    inline std::size_t limit() const { return _limit; }
+
+    void Execute(Storage &storage, const std::string &args, std::string &out) override;
+
+private:
+    const std::string _prefix;
+    const std::string _start;
+    const std::size_t _limit;
+};
+
+} // namespace Execute
+} // namespace Afina
+
+#endif // AFINA_EXECUTE_SCAN_H
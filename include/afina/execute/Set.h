@@ -1,9 +1,12 @@
 #ifndef AFINA_EXECUTE_SET_H
 #define AFINA_EXECUTE_SET_H
 
+#include <cstddef>
 #include <cstdint>
 #include <string>
+#include <utility>
 
+#include "Counters.h"
 #include "InsertCommand.h"
 
 namespace Afina {
@@ -21,10 +24,37 @@ namespace Execute {
  */
 class Set : public InsertCommand {
 public:
-    Set(const std::string &key, uint32_t flags, int32_t expire) : InsertCommand(key, flags, expire) {}
+    Set() : InsertCommand(Kind::kSet) {}
+    Set(const std::string &key, uint32_t flags, int32_t expire) : InsertCommand(key, flags, expire, Kind::kSet) {}
     ~Set() {}
 
     void Execute(Storage &storage, const std::string &args, std::string &out) override;
+
+    /**
+     * Value buffer is moved into the storage without copy
+     */
+    void ExecuteOwned(Storage &storage, std::string &&args, std::vector<ValueChunk> &out) override;
+    void ExecuteTo(Storage &storage, std::string &&args, OutputSink &out) override;
+
+    /**
+     * ExecuteTo on the storage of known type, see Get::ExecuteOn
+     */
+    template <typename S> void ExecuteOn(S &storage, std::string &&args, OutputSink &out) {
+        Adopt(storage, std::move(args));
+        out.Append("STORED", 6);
+    }
+
+private:
+    template <typename S> void Adopt(S &storage, std::string &&args) {
+        Trace(args.size());
+        Counters::Add(Counters::kCmdSet);
+        if (storage.Adopt(_key, std::move(args)) && _expire != 0) {
+            storage.Touch(_key, memcached_ttl(_expire));
+        }
+    }
+
+    // Traces command if logger wants it
+    void Trace(std::size_t size) const;
 };
 
 } // namespace Execute
@@ -8,11 +8,22 @@
 namespace Afina {
 namespace Execute {
 
+/**
+ * # memcached stats
+ * stats [<section>]
+ *
+ * Reports process info, server wide counters (see Counters.h) and whatever storage knows about its items.
+ * "stats latency" reports latency histograms of the requests instead, see Latency.h
+ */
 class Stats : public Command {
 public:
     Stats() {}
+    Stats(const std::string &section) : _section(section) {}
     ~Stats() {}
     void Execute(Storage &storage, const std::string &args, std::string &out) override;
+
+private:
+    const std::string _section;
 };
 
 } // namespace Execute
@@ -0,0 +1,51 @@
+#ifndef AFINA_EXECUTE_TOUCH_H
+#define AFINA_EXECUTE_TOUCH_H
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+#include "Command.h"
+
+namespace Afina {
+namespace Execute {
+
+/**
+ * # Update expiration time of the key
+ * touch <key> <exptime> [noreply]
+ *
+ * Sets new expiration time of the existing item without sending or rewriting
+ * its value, see memcached_ttl for the exptime format
+ *
+ * Command must write result to the output, which could be:
+ * - "TOUCHED" to indicate success
+ * - "NOT_FOUND" to indicate that the item with this key was not found
+ */
+class Touch : public Command {
+public:
+    Touch() : _expire(0) {}
+    Touch(const std::string &key, int32_t expire) : _key(key), _expire(expire) {}
+    ~Touch() {}
+
+    inline const std::string &key() const { return _key; }
+    inline const int32_t expire() const { return _expire; }
+
+    /**
+     * Reuses command for another request, key buffer is kept
+     */
+    void Reset(const char *key, std::size_t size, int32_t expire) {
+        _key.assign(key, size);
+        _expire = expire;
+    }
+
+    void Execute(Storage &storage, const std::string &args, std::string &out) override;
+
+private:
+    std::string _key;
+    int32_t _expire;
+};
+
+} // namespace Execute
+} // namespace Afina
+
+#endif // AFINA_EXECUTE_TOUCH_H
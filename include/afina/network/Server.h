@@ -2,8 +2,11 @@
 #define AFINA_NETWORK_SERVER_H
 
 #include <memory>
+#include <utility>
 #include <vector>
 
+#include <afina/execute/Dispatcher.h>
+
 namespace Afina {
 class Storage;
 namespace Logging {
@@ -21,6 +24,36 @@ public:
         : pStorage(ps), pLogging(pl) {}
     virtual ~Server() {}
 
+    /**
+     * Protocols clients of the server speak:
+     * - Memcached: text and binary memcached protocols, picked by the first byte of each connection
+     * - Resp: Redis protocol, RESP2
+     */
+    enum class Frontend { Memcached, Resp };
+
+    /**
+     * Selects protocols server speaks, must be called before Start
+     */
+    void SetFrontend(Frontend frontend) { this->frontend = frontend; }
+
+    /**
+     * Number of threads to execute commands on, 0 to execute them on the network thread. Servers that have no
+     * such pool ignore it. Must be called before Start
+     */
+    void SetExecutorThreads(uint32_t threads) { executor_threads = threads; }
+
+    /**
+     * Sets dispatcher to execute commands through, by default commands are called virtually on any storage.
+     * Must be called before Start
+     */
+    void SetDispatcher(std::shared_ptr<Execute::Dispatcher> dispatcher) { this->dispatcher = std::move(dispatcher); }
+
+    /**
+     * Requests that have waited longer than that since they were read are answered with timeout error instead
+     * of being executed, 0 means requests never expire. Must be called before Start
+     */
+    void SetRequestTimeout(uint32_t milliseconds) { request_timeout = uint64_t(milliseconds) * 1000000; }
+
     /**
      * Starts network service. After method returns process should
      * listen on the given interface/port pair to process  incomming
@@ -55,6 +88,26 @@ protected:
      * Logging service to be used in order to report application progress
      */
     std::shared_ptr<Afina::Logging::Service> pLogging;
+
+    /**
+     * Protocols server speaks
+     */
+    Frontend frontend = Frontend::Memcached;
+
+    /**
+     * Threads to execute commands on, see SetExecutorThreads
+     */
+    uint32_t executor_threads = 0;
+
+    /**
+     * Executes commands on the storage, see SetDispatcher
+     */
+    std::shared_ptr<Execute::Dispatcher> dispatcher = std::make_shared<Execute::Dispatcher>();
+
+    /**
+     * Request timeout in nanoseconds, see SetRequestTimeout
+     */
+    uint64_t request_timeout = 0;
 };
 
 } // namespace Network
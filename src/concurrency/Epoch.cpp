@@ -0,0 +1,151 @@
+#include <afina/concurrency/Epoch.h>
+
+#include <mutex>
+#include <stdexcept>
+
+namespace Afina {
+namespace Concurrency {
+
+namespace {
+
+// Process wide thread indexes, reused once thread exits
+class ThreadIndex {
+public:
+    ThreadIndex() {
+        std::unique_lock<std::mutex> lock(mutex());
+        if (!free().empty()) {
+            index = free().back();
+            free().pop_back();
+        } else {
+            index = next()++;
+        }
+    }
+
+    ~ThreadIndex() {
+        std::unique_lock<std::mutex> lock(mutex());
+        free().push_back(index);
+    }
+
+    std::size_t index;
+
+private:
+    static std::mutex &mutex() {
+        static std::mutex m;
+        return m;
+    }
+
+    static std::vector<std::size_t> &free() {
+        static std::vector<std::size_t> f;
+        return f;
+    }
+
+    static std::size_t &next() {
+        static std::size_t n = 0;
+        return n;
+    }
+};
+
+std::size_t current_thread_index() {
+    static thread_local ThreadIndex index;
+    if (index.index >= EpochManager::kMaxThreads) {
+        throw std::runtime_error("Too many threads for epoch manager");
+    }
+    return index.index;
+}
+
+} // namespace
+
+const std::size_t EpochManager::kMaxThreads;
+const std::size_t EpochManager::kAdvancePeriod;
+
+// See Epoch.h
+EpochManager::EpochManager() : _epoch(2) {
+    for (auto &slot : _slots) {
+        slot.state.store(0, std::memory_order_relaxed);
+        slot.depth = 0;
+        slot.retired = 0;
+        for (auto &e : slot.limbo_epoch) {
+            e = 0;
+        }
+    }
+}
+
+// See Epoch.h
+EpochManager::~EpochManager() {
+    // Nobody could access structure anymore
+    for (auto &slot : _slots) {
+        for (auto &list : slot.limbo) {
+            Free(list);
+        }
+    }
+}
+
+// See Epoch.h
+void EpochManager::Retire(void *ptr, void (*deleter)(void *)) {
+    Slot &slot = _slots[current_thread_index()];
+    uint64_t epoch = _epoch.load();
+
+    std::size_t bucket = epoch % 3;
+    if (slot.limbo_epoch[bucket] != epoch) {
+        // Bucket keeps memory retired at least three epochs ago
+        Free(slot.limbo[bucket]);
+        slot.limbo_epoch[bucket] = epoch;
+    }
+    slot.limbo[bucket].push_back({ptr, deleter});
+
+    if (++slot.retired % kAdvancePeriod == 0) {
+        TryAdvance();
+    }
+}
+
+// See Epoch.h
+void EpochManager::Enter() {
+    Slot &slot = _slots[current_thread_index()];
+    if (slot.depth++ > 0) {
+        return;
+    }
+
+    uint64_t epoch = _epoch.load();
+    slot.state.store((epoch << 1) | 1);
+    Collect(slot, epoch);
+}
+
+// See Epoch.h
+void EpochManager::Leave() {
+    Slot &slot = _slots[current_thread_index()];
+    if (--slot.depth == 0) {
+        slot.state.store(0, std::memory_order_release);
+    }
+}
+
+// See Epoch.h
+void EpochManager::TryAdvance() {
+    uint64_t epoch = _epoch.load();
+    for (auto &slot : _slots) {
+        uint64_t state = slot.state.load();
+        if ((state & 1) && (state >> 1) != epoch) {
+            return;
+        }
+    }
+    _epoch.compare_exchange_strong(epoch, epoch + 1);
+}
+
+// See Epoch.h
+void EpochManager::Collect(Slot &slot, uint64_t epoch) {
+    for (std::size_t i = 0; i < 3; i++) {
+        if (!slot.limbo[i].empty() && slot.limbo_epoch[i] + 2 <= epoch) {
+            Free(slot.limbo[i]);
+        }
+    }
+}
+
+// See Epoch.h
+void EpochManager::Free(std::vector<Retired> &list) {
+    for (auto &r : list) {
+        r.deleter(r.ptr);
+    }
+    list.clear();
+}
+
+} // namespace Concurrency
+} // namespace Afina
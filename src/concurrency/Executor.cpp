@@ -1,5 +1,71 @@
 #include <afina/concurrency/Executor.h>
 
+#include <pthread.h>
+
 namespace Afina {
-namespace Concurrency {}
+namespace Concurrency {
+
+// See Executor.h
+void perform(Executor *executor) {
+    for (;;) {
+        std::function<void()> task;
+        {
+            std::unique_lock<std::mutex> lock(executor->mutex);
+            while (executor->tasks.empty() && executor->state == Executor::State::kRun) {
+                executor->empty_condition.wait(lock);
+            }
+
+            // Stopping pool completes all tasks added before the stop
+            if (executor->tasks.empty()) {
+                return;
+            }
+            task = std::move(executor->tasks.front());
+            executor->tasks.pop_front();
+        }
+
+        try {
+            task();
+        } catch (...) {
+            // Nobody to report to, task must handle its errors itself
+        }
+    }
+}
+
+// See Executor.h
+Executor::Executor(std::string name, int size) : state(State::kRun) {
+    threads.reserve(size);
+    for (int i = 0; i < size; i++) {
+        threads.emplace_back(perform, this);
+
+        // Thread names are limited by 15 characters
+        pthread_setname_np(threads.back().native_handle(), name.substr(0, 15).c_str());
+    }
+}
+
+// See Executor.h
+Executor::~Executor() { Stop(true); }
+
+// See Executor.h
+void Executor::Stop(bool await) {
+    {
+        std::unique_lock<std::mutex> lock(mutex);
+        if (state == State::kRun) {
+            state = State::kStopping;
+        }
+    }
+    empty_condition.notify_all();
+
+    if (await) {
+        for (auto &thread : threads) {
+            if (thread.joinable()) {
+                thread.join();
+            }
+        }
+
+        std::unique_lock<std::mutex> lock(mutex);
+        state = State::kStopped;
+    }
+}
+
+} // namespace Concurrency
 } // namespace Afina
@@ -1,7 +1,8 @@
 #include <afina/Storage.h>
+#include <afina/execute/Counters.h>
 #include <afina/execute/Add.h>
 
-#include <iostream>
+#include "Trace.h"
 
 namespace Afina {
 namespace Execute {
@@ -9,8 +10,15 @@ namespace Execute {
 // memcached protocol:  "add" means "store this data, but only if the server *doesn't* already
 // hold data for this key".
 void Add::Execute(Storage &storage, const std::string &args, std::string &out) {
-    std::cout << "Add(" << _key << ")" << args << std::endl;
-    out = storage.PutIfAbsent(_key, args) ? "STORED" : "NOT_STORED";
+    if (auto logger = tracer()) {
+        logger->trace("Add({}): {} bytes", _key, args.size());
+    }
+    Counters::Add(Counters::kCmdSet);
+    bool stored = storage.PutIfAbsent(_key, args);
+    if (stored && _expire != 0) {
+        storage.Touch(_key, memcached_ttl(_expire));
+    }
+    out = stored ? "STORED" : "NOT_STORED";
 }
 
 } // namespace Execute
@@ -1 +1,63 @@
 #include <afina/execute/Command.h>
+
+#include "Trace.h"
+
+#include <ctime>
+#include <utility>
+
+namespace Afina {
+namespace Execute {
+
+namespace {
+
+// Keeps logger given to set_logger alive, commands use raw pointer
+std::shared_ptr<spdlog::logger> logger_holder;
+
+} // namespace
+
+// See Trace.h
+spdlog::logger *trace_logger = nullptr;
+
+// See Command.h
+void set_logger(std::shared_ptr<spdlog::logger> logger) {
+    trace_logger = logger.get();
+    logger_holder = std::move(logger);
+}
+
+// See Command.h
+int64_t memcached_ttl(int64_t exptime) {
+    // memcached protocol: "the actual value sent may either be Unix time (number of seconds since January 1,
+    // 1970, as a 32-bit value), or a number of seconds starting from current time. In the latter case, this
+    // number of seconds may not exceed 60*60*24*30"
+    const int64_t max_relative = 60 * 60 * 24 * 30;
+    if (exptime <= max_relative) {
+        return exptime < 0 ? -1 : exptime;
+    }
+
+    int64_t ttl = exptime - static_cast<int64_t>(std::time(nullptr));
+    return ttl > 0 ? ttl : -1;
+}
+
+// See Command.h
+void Command::ExecuteChunked(Storage &storage, const std::string &args, std::vector<ValueChunk> &out) {
+    std::shared_ptr<std::string> result(new std::string());
+    Execute(storage, args, *result);
+    if (!result->empty()) {
+        out.push_back(std::move(result));
+    }
+}
+
+// See Command.h
+void Command::ExecuteOwned(Storage &storage, std::string &&args, std::vector<ValueChunk> &out) {
+    ExecuteChunked(storage, args, out);
+}
+
+// See Command.h
+void Command::ExecuteTo(Storage &storage, std::string &&args, OutputSink &out) {
+    std::size_t from = out.Values().size();
+    ExecuteOwned(storage, std::move(args), out.Values());
+    out.Reference(from);
+}
+
+} // namespace Execute
+} // namespace Afina
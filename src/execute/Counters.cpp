@@ -0,0 +1,83 @@
+#include <afina/execute/Counters.h>
+
+#include <algorithm>
+#include <mutex>
+#include <vector>
+
+namespace Afina {
+namespace Execute {
+
+namespace {
+
+// Slots of the running threads and totals of the finished ones
+struct Registry {
+    std::mutex lock;
+    std::vector<Counters::Slot *> slots;
+    uint64_t retired[Counters::kCount] = {};
+};
+
+// Threads might exit after static objects are destroyed, so registry is never destroyed
+Registry &registry() {
+    static Registry *instance = new Registry();
+    return *instance;
+}
+
+// Owns slot of the thread: registers it once thread counts something first time, folds it into the
+// retired totals when thread exits
+struct Owner {
+    Counters::Slot slot;
+
+    Owner() {
+        for (auto &value : slot.values) {
+            value.store(0, std::memory_order_relaxed);
+        }
+
+        Registry &r = registry();
+        std::lock_guard<std::mutex> guard(r.lock);
+        r.slots.push_back(&slot);
+    }
+
+    ~Owner() {
+        Registry &r = registry();
+        std::lock_guard<std::mutex> guard(r.lock);
+        for (std::size_t i = 0; i < Counters::kCount; i++) {
+            r.retired[i] += slot.values[i].load(std::memory_order_relaxed);
+        }
+        r.slots.erase(std::find(r.slots.begin(), r.slots.end(), &slot));
+    }
+};
+
+} // namespace
+
+thread_local Counters::Slot *Counters::_local = nullptr;
+
+// See Counters.h
+Counters::Slot *Counters::Register() {
+    // Thread local object with destructor costs a guard check on every access, so it is touched only here
+    // while Add goes through the plain pointer
+    static thread_local Owner owner;
+    _local = &owner.slot;
+    return _local;
+}
+
+// See Counters.h
+void Counters::Collect(uint64_t (&totals)[kCount]) {
+    Registry &r = registry();
+    std::lock_guard<std::mutex> guard(r.lock);
+    std::copy(r.retired, r.retired + kCount, totals);
+    for (auto slot : r.slots) {
+        for (std::size_t i = 0; i < kCount; i++) {
+            totals[i] += slot->values[i].load(std::memory_order_relaxed);
+        }
+    }
+}
+
+// See Counters.h
+uint64_t Counters::Get(Counter counter) {
+    uint64_t totals[kCount];
+    Collect(totals);
+    return totals[counter];
+}
+
+} // namespace Execute
+} // namespace Afina
@@ -0,0 +1,21 @@
+#include <afina/Storage.h>
+#include <afina/execute/Counters.h>
+#include <afina/execute/Delete.h>
+
+#include "Trace.h"
+
+namespace Afina {
+namespace Execute {
+
+// memcached protocol: "delete" removes an item with the given key, if there is one.
+void Delete::Execute(Storage &storage, const std::string &args, std::string &out) {
+    if (auto logger = tracer()) {
+        logger->trace("Delete({})", _key);
+    }
+    bool deleted = storage.Delete(_key);
+    Counters::Add(deleted ? Counters::kDeleteHits : Counters::kDeleteMisses);
+    out.assign(deleted ? "DELETED" : "NOT_FOUND");
+}
+
+} // namespace Execute
+} // namespace Afina
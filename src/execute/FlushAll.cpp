@@ -0,0 +1,26 @@
+#include <afina/Storage.h>
+#include <afina/execute/Counters.h>
+#include <afina/execute/FlushAll.h>
+
+#include "Trace.h"
+
+namespace Afina {
+namespace Execute {
+
+// memcached protocol: "flush_all" invalidates all existing items, optionally after the delay.
+void FlushAll::Execute(Storage &storage, const std::string &args, std::string &out) {
+    if (auto logger = tracer()) {
+        logger->trace("FlushAll({})", _delay);
+    }
+    Counters::Add(Counters::kCmdFlush);
+    if (_delay != 0) {
+        out = "CLIENT_ERROR delayed flush_all is not supported";
+    } else if (storage.Clear()) {
+        out = "OK";
+    } else {
+        out = "SERVER_ERROR flush_all is not supported by the storage";
+    }
+}
+
+} // namespace Execute
+} // namespace Afina
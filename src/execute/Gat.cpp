@@ -0,0 +1,45 @@
+#include <afina/Storage.h>
+#include <afina/execute/Counters.h>
+#include <afina/execute/Gat.h>
+
+#include <utility>
+
+namespace Afina {
+namespace Execute {
+
+// See Gat.h
+void Gat::TouchKeys(Storage &storage) const {
+    int64_t ttl = memcached_ttl(_expire);
+    std::size_t hits = 0;
+    for (auto &key : keys()) {
+        if (storage.Touch(key, ttl)) {
+            hits++;
+        }
+    }
+
+    // Keys are counted as fetched by Get as well, the way memcached does
+    Counters::Add(Counters::kCmdTouch, keys().size());
+    Counters::Add(Counters::kTouchHits, hits);
+    Counters::Add(Counters::kTouchMisses, keys().size() - hits);
+}
+
+// See Gat.h
+void Gat::Execute(Storage &storage, const std::string &args, std::string &out) {
+    TouchKeys(storage);
+    Get::Execute(storage, args, out);
+}
+
+// See Gat.h
+void Gat::ExecuteChunked(Storage &storage, const std::string &args, std::vector<ValueChunk> &out) {
+    TouchKeys(storage);
+    Get::ExecuteChunked(storage, args, out);
+}
+
+// See Gat.h
+void Gat::ExecuteTo(Storage &storage, std::string &&args, OutputSink &out) {
+    TouchKeys(storage);
+    Get::ExecuteTo(storage, std::move(args), out);
+}
+
+} // namespace Execute
+} // namespace Afina
@@ -1,9 +1,10 @@
 #include <afina/Storage.h>
+#include <afina/execute/Counters.h>
 #include <afina/execute/Get.h>
 
-#include <iostream>
-#include <iterator>
-#include <sstream>
+#include <utility>
+
+#include "Trace.h"
 
 namespace Afina {
 namespace Execute {
@@ -21,24 +22,96 @@ to indicate the end of response.
 
 */
 
-void Get::Execute(Storage &storage, const std::string &args, std::string &out) {
-    std::stringstream keyStream;
-    copy(_keys.begin(), _keys.end(), std::ostream_iterator<std::string>(keyStream, " "));
-    std::cout << "Get(" << keyStream.str() << ")" << std::endl;
+// See Get.h
+std::vector<std::string> &Get::Reset(std::size_t count) {
+    while (_keys.size() > count) {
+        _spare.push_back(std::move(_keys.back()));
+        _keys.pop_back();
+    }
+    while (_keys.size() < count) {
+        if (_spare.empty()) {
+            _keys.emplace_back();
+        } else {
+            _keys.push_back(std::move(_spare.back()));
+            _spare.pop_back();
+        }
+    }
+    return _keys;
+}
 
-    std::stringstream outStream;
+// See Get.h
+void Get::LogKeys() const {
+    spdlog::logger *logger = tracer();
+    if (logger == nullptr) {
+        return;
+    }
 
+    std::string keys;
+    for (auto &key : _keys) {
+        keys.append(key).append(" ");
+    }
+    logger->trace("Get({})", keys);
+}
+
+// See Get.h
+void Get::Count(std::size_t hits) const {
+    Counters::Add(Counters::kCmdGet, _keys.size());
+    Counters::Add(Counters::kGetHits, hits);
+    Counters::Add(Counters::kGetMisses, _keys.size() - hits);
+}
+
+void Get::Execute(Storage &storage, const std::string &args, std::string &out) {
+    LogKeys();
+
+    out.clear();
     std::string value;
+    std::size_t hits = 0;
     for (auto &key : _keys) {
         if (!storage.Get(key, value))
             continue;
-        outStream << "VALUE " << key << " 0 " << value.size() << "\r\n";
-        outStream << value << "\r\n";
+        hits++;
+        out.append("VALUE ").append(key).append(" 0 ").append(std::to_string(value.size())).append("\r\n");
+        out.append(value).append("\r\n");
     }
-    outStream << "END"; // networking layer should add the last \r\n
+    Count(hits);
+    out.append("END"); // networking layer should add the last \r\n
+}
+
+void Get::ExecuteChunked(Storage &storage, const std::string &args, std::vector<ValueChunk> &out) {
+    LogKeys();
+
+    // Text between two values is collected in a single chunk
+    std::shared_ptr<std::string> header(new std::string());
+
+    std::vector<ValueChunk> value;
+    std::size_t hits = 0;
+    for (auto &key : _keys) {
+        value.clear();
+        if (!storage.GetChunks(key, value)) {
+            continue;
+        }
+        hits++;
+
+        std::size_t size = 0;
+        for (auto &chunk : value) {
+            size += chunk->size();
+        }
+
+        header->append("VALUE ").append(key).append(" 0 ").append(std::to_string(size)).append("\r\n");
+        out.push_back(std::move(header));
+        out.insert(out.end(), value.begin(), value.end());
 
-    out = outStream.str();
+        header.reset(new std::string("\r\n"));
+    }
+    Count(hits);
+    header->append("END"); // networking layer should add the last \r\n
+    out.push_back(std::move(header));
 }
 
+void Get::ExecuteTo(Storage &storage, std::string &&args, OutputSink &out) { ExecuteOn(storage, out); }
+
+// See Get.h
+bool Get::ExecuteValue(Storage &storage, std::vector<ValueChunk> &value) { return ExecuteValueOn(storage, value); }
+
 } // namespace Execute
 } // namespace Afina
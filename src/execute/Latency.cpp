@@ -0,0 +1,206 @@
+#include <afina/execute/Latency.h>
+
+#include <algorithm>
+#include <cmath>
+#include <mutex>
+#include <stdexcept>
+
+namespace Afina {
+namespace Execute {
+
+const std::size_t Histogram::kBuckets;
+const std::size_t Latency::kMaxBackends;
+const std::size_t Latency::kMaxSeries;
+
+// See Latency.h
+uint64_t Histogram::Percentile(const Counts &counts, double share) {
+    uint64_t total = 0;
+    for (auto count : counts) {
+        total += count;
+    }
+    if (total == 0) {
+        return 0;
+    }
+
+    uint64_t rank = std::max<uint64_t>(1, static_cast<uint64_t>(std::ceil(share * total)));
+    uint64_t seen = 0;
+    for (std::size_t i = 0; i < kBuckets; i++) {
+        seen += counts[i];
+        if (seen >= rank) {
+            return Highest(i);
+        }
+    }
+    return Highest(kBuckets - 1);
+}
+
+// See Latency.h
+void Histogram::Collect(Counts &counts) const {
+    for (std::size_t i = 0; i < kBuckets; i++) {
+        counts[i] += _counts[i].load(std::memory_order_relaxed);
+    }
+}
+
+// See Latency.h
+void Histogram::Merge(const Counts &counts) {
+    for (std::size_t i = 0; i < kBuckets; i++) {
+        _counts[i].store(_counts[i].load(std::memory_order_relaxed) + counts[i], std::memory_order_relaxed);
+    }
+}
+
+namespace {
+
+// Names, slots of the running threads and histograms of the finished ones
+struct Registry {
+    std::mutex lock;
+    std::vector<std::string> backends;
+    std::vector<std::string> series;
+    std::vector<Latency::Slot *> slots;
+    Histogram *retired[Latency::kMaxBackends][Latency::kMaxSeries] = {};
+};
+
+// Threads might exit after static objects are destroyed, so registry is never destroyed
+Registry &registry() {
+    static Registry *instance = new Registry();
+    return *instance;
+}
+
+std::size_t intern(std::vector<std::string> &names, const std::string &name, std::size_t limit) {
+    auto it = std::find(names.begin(), names.end(), name);
+    if (it != names.end()) {
+        return it - names.begin();
+    }
+    if (names.size() == limit) {
+        throw std::runtime_error("Too many latency histograms, can't add " + name);
+    }
+    names.push_back(name);
+    return names.size() - 1;
+}
+
+// Owns slot of the thread, folds its histograms into the retired ones when thread exits
+struct Owner {
+    Latency::Slot slot;
+
+    Owner() {
+        for (auto &backend : slot.histograms) {
+            for (auto &histogram : backend) {
+                histogram.store(nullptr, std::memory_order_relaxed);
+            }
+        }
+
+        Registry &r = registry();
+        std::lock_guard<std::mutex> guard(r.lock);
+        r.slots.push_back(&slot);
+    }
+
+    ~Owner() {
+        Registry &r = registry();
+        std::lock_guard<std::mutex> guard(r.lock);
+        for (std::size_t b = 0; b < Latency::kMaxBackends; b++) {
+            for (std::size_t s = 0; s < Latency::kMaxSeries; s++) {
+                Histogram *histogram = slot.histograms[b][s].load(std::memory_order_relaxed);
+                if (histogram == nullptr) {
+                    continue;
+                }
+
+                Histogram::Counts counts = {};
+                histogram->Collect(counts);
+                if (r.retired[b][s] == nullptr) {
+                    r.retired[b][s] = new Histogram();
+                }
+                r.retired[b][s]->Merge(counts);
+                delete histogram;
+            }
+        }
+        r.slots.erase(std::find(r.slots.begin(), r.slots.end(), &slot));
+    }
+};
+
+// Collects histograms of all threads, registry lock must be held
+void collect(Registry &r, std::size_t backend, std::size_t series, Histogram::Counts &counts) {
+    std::fill(counts, counts + Histogram::kBuckets, 0);
+    if (r.retired[backend][series] != nullptr) {
+        r.retired[backend][series]->Collect(counts);
+    }
+    for (auto slot : r.slots) {
+        Histogram *histogram = slot->histograms[backend][series].load(std::memory_order_acquire);
+        if (histogram != nullptr) {
+            histogram->Collect(counts);
+        }
+    }
+}
+
+} // namespace
+
+thread_local Latency::Slot *Latency::_local = nullptr;
+
+// See Latency.h
+std::size_t Latency::Backend(const std::string &name) {
+    Registry &r = registry();
+    std::lock_guard<std::mutex> guard(r.lock);
+    return intern(r.backends, name, kMaxBackends);
+}
+
+// See Latency.h
+std::size_t Latency::Series(const std::string &name) {
+    Registry &r = registry();
+    std::lock_guard<std::mutex> guard(r.lock);
+    return intern(r.series, name, kMaxSeries);
+}
+
+// See Latency.h
+Latency::Slot *Latency::Register() {
+    // The same trick as in Counters: guarded thread local object is touched only once per thread
+    static thread_local Owner owner;
+    _local = &owner.slot;
+    return _local;
+}
+
+// See Latency.h
+Histogram *Latency::Create(std::size_t backend, std::size_t series) {
+    // Readers might see the pointer at once, so histogram is published only once it is zeroed
+    Histogram *histogram = new Histogram();
+    _local->histograms[backend][series].store(histogram, std::memory_order_release);
+    return histogram;
+}
+
+// See Latency.h
+void Latency::Collect(std::size_t backend, std::size_t series, Histogram::Counts &counts) {
+    Registry &r = registry();
+    std::lock_guard<std::mutex> guard(r.lock);
+    collect(r, backend, series, counts);
+}
+
+// See Latency.h
+void Latency::Report(std::vector<std::pair<std::string, std::string>> &stats) {
+    Registry &r = registry();
+    std::lock_guard<std::mutex> guard(r.lock);
+
+    Histogram::Counts counts;
+    for (std::size_t b = 0; b < r.backends.size(); b++) {
+        for (std::size_t s = 0; s < r.series.size(); s++) {
+            collect(r, b, s, counts);
+
+            uint64_t total = 0;
+            std::size_t last = 0;
+            for (std::size_t i = 0; i < Histogram::kBuckets; i++) {
+                total += counts[i];
+                if (counts[i] != 0) {
+                    last = i;
+                }
+            }
+            if (total == 0) {
+                continue;
+            }
+
+            const std::string prefix = r.backends[b] + ":" + r.series[s] + ":";
+            stats.emplace_back(prefix + "count", std::to_string(total));
+            stats.emplace_back(prefix + "p50", std::to_string(Histogram::Percentile(counts, 0.5)));
+            stats.emplace_back(prefix + "p99", std::to_string(Histogram::Percentile(counts, 0.99)));
+            stats.emplace_back(prefix + "p999", std::to_string(Histogram::Percentile(counts, 0.999)));
+            stats.emplace_back(prefix + "max", std::to_string(Histogram::Highest(last)));
+        }
+    }
+}
+
+} // namespace Execute
+} // namespace Afina
@@ -0,0 +1,298 @@
+#include <afina/Storage.h>
+#include <afina/execute/Counters.h>
+#include <afina/execute/Meta.h>
+
+#include <cctype>
+#include <cerrno>
+#include <cstdlib>
+#include <stdexcept>
+
+namespace Afina {
+namespace Execute {
+
+namespace {
+
+// Parses decimal token of the flag, throws if it isn't a number
+uint64_t parse_number(const std::string &token, char flag) {
+    char *end = nullptr;
+    errno = 0;
+    uint64_t result = std::strtoull(token.c_str(), &end, 10);
+    if (token.empty() || *end != '\0' || errno == ERANGE || token[0] == '-') {
+        throw std::runtime_error(std::string("Invalid token of meta flag ") + flag + ": " + token);
+    }
+    return result;
+}
+
+// Parses signed decimal token of the flag, throws if it isn't a number
+int64_t parse_signed(const std::string &token, char flag) {
+    char *end = nullptr;
+    errno = 0;
+    int64_t result = std::strtoll(token.c_str(), &end, 10);
+    if (token.empty() || *end != '\0' || errno == ERANGE) {
+        throw std::runtime_error(std::string("Invalid token of meta flag ") + flag + ": " + token);
+    }
+    return result;
+}
+
+// Response without value: status code and return flags
+void push_status(std::vector<ValueChunk> &out, const char *code, const std::string &flags) {
+    out.push_back(std::make_shared<std::string>(code + flags));
+}
+
+} // namespace
+
+// See Meta.h
+MetaCommand::MetaCommand(const std::string &key, const std::vector<std::string> &flags) : _key(key) {
+    for (auto &flag : flags) {
+        if (!flag.empty()) {
+            _flags.emplace_back(flag[0], flag.substr(1));
+        }
+    }
+}
+
+// See Meta.h
+bool MetaCommand::Has(char flag) const {
+    for (auto &f : _flags) {
+        if (f.first == flag) {
+            return true;
+        }
+    }
+    return false;
+}
+
+// See Meta.h
+const std::string &MetaCommand::Token(char flag) const {
+    static const std::string empty;
+    for (auto &f : _flags) {
+        if (f.first == flag) {
+            return f.second;
+        }
+    }
+    return empty;
+}
+
+// See Meta.h
+void MetaCommand::Execute(Storage &storage, const std::string &args, std::string &out) {
+    std::vector<ValueChunk> chunks;
+    ExecuteChunked(storage, args, chunks);
+    out.clear();
+    for (auto &chunk : chunks) {
+        out.append(*chunk);
+    }
+}
+
+// See Meta.h
+void MetaCommand::AppendReturnFlags(std::string &out) const {
+    for (auto &f : _flags) {
+        if (f.first == 'k') {
+            out.append(" k").append(_key);
+        } else if (f.first == 'O') {
+            out.append(" O").append(f.second);
+        }
+    }
+}
+
+// See Meta.h
+void MetaGet::ExecuteChunked(Storage &storage, const std::string &args, std::vector<ValueChunk> &out) {
+    std::vector<ValueChunk> value;
+    int64_t ttl = -1;
+
+    // Key could expire right between the two calls, then it is a miss
+    bool found = storage.GetChunks(_key, value) && (!Has('t') || storage.TimeToLive(_key, ttl));
+    Counters::Add(Counters::kCmdGet);
+    Counters::Add(found ? Counters::kGetHits : Counters::kGetMisses);
+    if (!found) {
+        if (!quiet()) {
+            out.push_back(std::make_shared<std::string>("EN"));
+        }
+        return;
+    }
+
+    std::size_t size = 0;
+    for (auto &chunk : value) {
+        size += chunk->size();
+    }
+
+    // Flags are echoed in the order client gave them
+    bool with_value = Has('v');
+    std::shared_ptr<std::string> header(new std::string(with_value ? "VA " + std::to_string(size) : "HD"));
+    for (auto &f : _flags) {
+        switch (f.first) {
+        case 's':
+            header->append(" s").append(std::to_string(size));
+            break;
+        case 'f':
+            header->append(" f0");
+            break;
+        case 't':
+            header->append(" t").append(std::to_string(ttl));
+            break;
+        case 'k':
+            header->append(" k").append(_key);
+            break;
+        case 'O':
+            header->append(" O").append(f.second);
+            break;
+        default:
+            break;
+        }
+    }
+
+    if (with_value) {
+        header->append("\r\n");
+        out.push_back(std::move(header));
+        out.insert(out.end(), value.begin(), value.end()); // networking layer should add the last \r\n
+    } else {
+        out.push_back(std::move(header));
+    }
+}
+
+// See Meta.h
+MetaSet::MetaSet(const std::string &key, const std::vector<std::string> &flags)
+    : MetaCommand(key, flags), _mode('S'), _expire(0) {
+    if (Has('M')) {
+        const std::string &mode = Token('M');
+        if (mode.size() != 1 || std::string("SEAPRseapr").find(mode[0]) == std::string::npos) {
+            throw std::runtime_error("Invalid meta set mode: " + mode);
+        }
+        _mode = std::toupper(mode[0]);
+    }
+    if (Has('T')) {
+        _expire = parse_signed(Token('T'), 'T');
+    }
+}
+
+// See Meta.h
+void MetaSet::ExecuteChunked(Storage &storage, const std::string &args, std::vector<ValueChunk> &out) {
+    Counters::Add(Counters::kCmdSet);
+    bool stored = false;
+    switch (_mode) {
+    case 'S':
+        stored = storage.Put(_key, args);
+        break;
+    case 'E':
+        stored = storage.PutIfAbsent(_key, args);
+        break;
+    case 'A':
+        stored = storage.Append(_key, args);
+        break;
+    case 'P':
+        stored = storage.Prepend(_key, args);
+        break;
+    case 'R':
+        stored = storage.Set(_key, args);
+        break;
+    }
+
+    // Put starts key without expiration and Set keeps the old one, so replace always sets the new one, the way
+    // replace command does. Append and prepend leave expiration as it is
+    if (stored && (_mode == 'R' || (_expire != 0 && (_mode == 'S' || _mode == 'E')))) {
+        storage.Touch(_key, memcached_ttl(_expire));
+    }
+
+    std::string flags;
+    AppendReturnFlags(flags);
+    if (!stored) {
+        push_status(out, "NS", flags);
+    } else if (!quiet()) {
+        push_status(out, "HD", flags);
+    }
+}
+
+// See Meta.h
+void MetaDelete::ExecuteChunked(Storage &storage, const std::string &args, std::vector<ValueChunk> &out) {
+    bool deleted = storage.Delete(_key);
+    Counters::Add(deleted ? Counters::kDeleteHits : Counters::kDeleteMisses);
+    if (!quiet()) {
+        std::string flags;
+        AppendReturnFlags(flags);
+        push_status(out, deleted ? "HD" : "NF", flags);
+    }
+}
+
+// See Meta.h
+MetaArithmetic::MetaArithmetic(const std::string &key, const std::vector<std::string> &flags)
+    : MetaCommand(key, flags), _increment(true), _delta(1), _initial(0), _expire(0) {
+    if (Has('M')) {
+        const std::string &mode = Token('M');
+        if (mode == "I" || mode == "i" || mode == "+") {
+            _increment = true;
+        } else if (mode == "D" || mode == "d" || mode == "-") {
+            _increment = false;
+        } else {
+            throw std::runtime_error("Invalid meta arithmetic mode: " + mode);
+        }
+    }
+    if (Has('D')) {
+        _delta = parse_number(Token('D'), 'D');
+    }
+    if (Has('J')) {
+        _initial = parse_number(Token('J'), 'J');
+    }
+    if (!Token('N').empty()) {
+        _expire = parse_signed(Token('N'), 'N');
+    }
+}
+
+// See Meta.h
+void MetaArithmetic::ExecuteChunked(Storage &storage, const std::string &args, std::vector<ValueChunk> &out) {
+    std::string flags;
+    AppendReturnFlags(flags);
+
+    // Value is read and written back as a single storage operation, concurrent updates never get lost
+    bool found = false, numeric = true;
+    std::string result;
+    bool stored = storage.Update(_key, [this, &found, &numeric, &result](bool present, std::string &value) {
+        found = present;
+        numeric = true;
+        uint64_t number = _initial;
+        if (present) {
+            char *end = nullptr;
+            errno = 0;
+            number = std::strtoull(value.c_str(), &end, 10);
+            if (value.empty() || *end != '\0' || errno == ERANGE || value[0] == '-') {
+                numeric = false;
+                return false;
+            }
+
+            if (_increment) {
+                number += _delta;
+            } else {
+                number = (number > _delta) ? number - _delta : 0;
+            }
+        } else if (!Has('N')) {
+            return false;
+        }
+
+        value = std::to_string(number);
+        result = value;
+        return true;
+    });
+
+    if (!stored && !found && numeric && !Has('N')) {
+        if (!quiet()) {
+            push_status(out, "NF", flags);
+        }
+        return;
+    } else if (!stored) {
+        push_status(out, "NS", flags);
+        return;
+    }
+
+    // Created item expires the way N asks, existing one keeps its expiration
+    if (!found && _expire != 0) {
+        storage.Touch(_key, memcached_ttl(_expire));
+    }
+
+    if (Has('v')) {
+        out.push_back(std::make_shared<std::string>("VA " + std::to_string(result.size()) + flags + "\r\n" + result));
+    } else if (!quiet()) {
+        push_status(out, "HD", flags);
+    }
+}
+
+// See Meta.h
+void MetaNoop::Execute(Storage &storage, const std::string &args, std::string &out) { out = "MN"; }
+
+} // namespace Execute
+} // namespace Afina
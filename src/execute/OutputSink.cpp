@@ -0,0 +1,117 @@
+#include <afina/execute/OutputSink.h>
+
+#include <cstring>
+#include <utility>
+
+namespace Afina {
+namespace Execute {
+
+const std::size_t OutputSink::kText;
+
+// See OutputSink.h
+void OutputSink::Append(const char *data, std::size_t size) {
+    if (size == 0) {
+        return;
+    }
+
+    // Consecutive text fragments make up a single part
+    Part *last = _parts.empty() ? nullptr : &_parts.back();
+    if (last != nullptr && last->value == kText && last->offset + last->size == _buffer.size()) {
+        last->size += size;
+    } else {
+        _parts.push_back(Part{kText, _buffer.size(), size});
+    }
+    _buffer.append(data, size);
+}
+
+// See OutputSink.h
+void OutputSink::Append(const char *text) { Append(text, std::strlen(text)); }
+
+// See OutputSink.h
+void OutputSink::AppendNumber(uint64_t number) {
+    char digits[20];
+    std::size_t pos = sizeof(digits);
+    do {
+        digits[--pos] = '0' + number % 10;
+        number /= 10;
+    } while (number != 0);
+    Append(digits + pos, sizeof(digits) - pos);
+}
+
+// See OutputSink.h
+void OutputSink::Reference(std::size_t from, std::size_t to) {
+    for (std::size_t i = from; i < to; i++) {
+        if (!_values[i]->empty()) {
+            _parts.push_back(Part{i, 0, _values[i]->size()});
+        }
+    }
+}
+
+// See OutputSink.h
+void OutputSink::Reference(ValueChunk chunk) {
+    _values.push_back(std::move(chunk));
+    Reference(_values.size() - 1);
+}
+
+// See OutputSink.h
+void OutputSink::Truncate(const Mark &mark) {
+    _buffer.resize(mark.buffer);
+    _values.resize(mark.values);
+    _parts.resize(mark.parts);
+
+    // Text part could be extended after the mark
+    if (!_parts.empty() && _parts.back().value == kText) {
+        _parts.back().size = _buffer.size() - _parts.back().offset;
+    }
+}
+
+// See OutputSink.h
+std::size_t OutputSink::Written(const Mark &mark) const {
+    std::size_t size = _buffer.size() - mark.buffer;
+    for (std::size_t i = mark.parts; i < _parts.size(); i++) {
+        if (_parts[i].value != kText) {
+            size += _parts[i].size;
+        }
+    }
+    return size;
+}
+
+// See OutputSink.h
+void OutputSink::CopyTo(const Mark &mark, std::string &out) const {
+    out.reserve(out.size() + Written(mark));
+
+    // Text part that was there at the mark could be extended after it
+    if (mark.parts > 0 && _parts[mark.parts - 1].value == kText) {
+        const Part &last = _parts[mark.parts - 1];
+        if (last.offset + last.size > mark.buffer) {
+            out.append(_buffer, mark.buffer, last.offset + last.size - mark.buffer);
+        }
+    }
+    for (std::size_t i = mark.parts; i < _parts.size(); i++) {
+        const Part &part = _parts[i];
+        const std::string &source = (part.value == kText) ? _buffer : *_values[part.value];
+        out.append(source, part.offset, part.size);
+    }
+}
+
+// See OutputSink.h
+std::vector<struct iovec> &OutputSink::Iov() {
+    // Buffer could be reallocated while written, so pointers are resolved only now
+    _iov.clear();
+    for (auto &part : _parts) {
+        const char *base = (part.value == kText) ? _buffer.data() : _values[part.value]->data();
+        _iov.push_back({const_cast<char *>(base + part.offset), part.size});
+    }
+    return _iov;
+}
+
+// See OutputSink.h
+void OutputSink::Clear() {
+    _buffer.clear();
+    _values.clear();
+    _parts.clear();
+    _iov.clear();
+}
+
+} // namespace Execute
+} // namespace Afina
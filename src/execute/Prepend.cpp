@@ -0,0 +1,20 @@
+#include <afina/Storage.h>
+#include <afina/execute/Counters.h>
+#include <afina/execute/Prepend.h>
+
+#include "Trace.h"
+
+namespace Afina {
+namespace Execute {
+
+// memcached protocol: "prepend" means "add this data to an existing key before existing data".
+void Prepend::Execute(Storage &storage, const std::string &args, std::string &out) {
+    if (auto logger = tracer()) {
+        logger->trace("Prepend({}): {} bytes", _key, args.size());
+    }
+    Counters::Add(Counters::kCmdSet);
+    out.assign(storage.Prepend(_key, args) ? "STORED" : "NOT_STORED");
+}
+
+} // namespace Execute
+} // namespace Afina
@@ -1,7 +1,8 @@
 #include <afina/Storage.h>
+#include <afina/execute/Counters.h>
 #include <afina/execute/Replace.h>
 
-#include <iostream>
+#include "Trace.h"
 
 namespace Afina {
 namespace Execute {
@@ -10,10 +11,13 @@ namespace Execute {
 // already hold data for this key".
 
 void Replace::Execute(Storage &storage, const std::string &args, std::string &out) {
-    std::cout << "Replace(" << _key << "): " << args << std::endl;
-    std::string value;
-    if (storage.Get(_key, value)) {
-        storage.Set(_key, args);
+    if (auto logger = tracer()) {
+        logger->trace("Replace({}): {} bytes", _key, args.size());
+    }
+    Counters::Add(Counters::kCmdSet);
+    // Set keeps expiration of the key, replace sets the new one
+    if (storage.Set(_key, args)) {
+        storage.Touch(_key, memcached_ttl(_expire));
         out = "STORED";
     } else {
         out = "NOT_STORED";
@@ -0,0 +1,182 @@
+#include <afina/Storage.h>
+#include <afina/execute/Counters.h>
+#include <afina/execute/Resp.h>
+
+#include <cerrno>
+#include <cstdlib>
+#include <limits>
+
+namespace Afina {
+namespace Execute {
+
+namespace {
+
+// Replies that carry no data are shared by all commands
+ValueChunk reply(const char *text) { return std::make_shared<std::string>(text); }
+
+const ValueChunk &reply_ok() {
+    static const ValueChunk chunk = reply("+OK");
+    return chunk;
+}
+
+const ValueChunk &reply_null() {
+    static const ValueChunk chunk = reply("$-1");
+    return chunk;
+}
+
+ValueChunk reply_integer(int64_t number) { return std::make_shared<std::string>(":" + std::to_string(number)); }
+
+} // namespace
+
+// See Resp.h
+bool RespCommand::ParseInteger(const std::string &token, int64_t &number) {
+    // strtoll skips leading spaces and accepts "+", Redis doesn't
+    std::size_t digits = (!token.empty() && token[0] == '-') ? 1 : 0;
+    if (token.size() == digits || token.size() > 20) {
+        return false;
+    }
+    for (std::size_t i = digits; i < token.size(); i++) {
+        if (token[i] < '0' || token[i] > '9') {
+            return false;
+        }
+    }
+
+    errno = 0;
+    number = std::strtoll(token.c_str(), nullptr, 10);
+    return errno != ERANGE;
+}
+
+// See Resp.h
+void RespCommand::Execute(Storage &storage, const std::string &args, std::string &out) {
+    std::vector<ValueChunk> chunks;
+    ExecuteChunked(storage, args, chunks);
+    out.clear();
+    for (auto &chunk : chunks) {
+        out.append(*chunk);
+    }
+}
+
+// See Resp.h
+void RespGet::ExecuteChunked(Storage &storage, const std::string &args, std::vector<ValueChunk> &out) {
+    // Header goes before the value, but it's known only once value chunks are there
+    std::size_t header = out.size();
+    out.emplace_back();
+    bool found = storage.GetChunks(_key, out);
+    Counters::Add(Counters::kCmdGet);
+    Counters::Add(found ? Counters::kGetHits : Counters::kGetMisses);
+    if (!found) {
+        out[header] = reply_null();
+        return;
+    }
+
+    std::size_t size = 0;
+    for (std::size_t i = header + 1; i < out.size(); i++) {
+        size += out[i]->size();
+    }
+    out[header] = std::make_shared<std::string>("$" + std::to_string(size) + "\r\n");
+}
+
+// See Resp.h
+void RespSet::ExecuteChunked(Storage &storage, const std::string &args, std::vector<ValueChunk> &out) {
+    Counters::Add(Counters::kCmdSet);
+    bool stored = false;
+    switch (_condition) {
+    case Condition::Always:
+        stored = storage.Put(_key, args);
+        break;
+    case Condition::IfAbsent:
+        stored = storage.PutIfAbsent(_key, args);
+        break;
+    case Condition::IfPresent:
+        stored = storage.Set(_key, args);
+        break;
+    }
+
+    if (!stored) {
+        out.push_back(_condition == Condition::Always ? reply("-ERR value is too large to be stored") : reply_null());
+        return;
+    }
+
+    // Set keeps expiration of the key, but SET without EX/PX must drop it
+    if (_ttl != 0 || _condition == Condition::IfPresent) {
+        storage.Touch(_key, _ttl);
+    }
+    out.push_back(reply_ok());
+}
+
+// See Resp.h
+void RespSet::ExecuteOwned(Storage &storage, std::string &&args, std::vector<ValueChunk> &out) {
+    if (_condition != Condition::Always) {
+        ExecuteChunked(storage, args, out);
+        return;
+    }
+
+    Counters::Add(Counters::kCmdSet);
+    if (!storage.Adopt(_key, std::move(args))) {
+        out.push_back(reply("-ERR value is too large to be stored"));
+        return;
+    }
+
+    if (_ttl != 0) {
+        storage.Touch(_key, _ttl);
+    }
+    out.push_back(reply_ok());
+}
+
+// See Resp.h
+void RespDelete::ExecuteChunked(Storage &storage, const std::string &args, std::vector<ValueChunk> &out) {
+    int64_t deleted = 0;
+    for (auto &key : _keys) {
+        if (storage.Delete(key)) {
+            deleted++;
+        }
+    }
+    Counters::Add(Counters::kDeleteHits, deleted);
+    Counters::Add(Counters::kDeleteMisses, _keys.size() - deleted);
+    out.push_back(reply_integer(deleted));
+}
+
+// See Resp.h
+void RespIncrement::ExecuteChunked(Storage &storage, const std::string &args, std::vector<ValueChunk> &out) {
+    // Value is read and written back as a single storage operation, concurrent increments never get lost
+    const char *error = nullptr;
+    int64_t number = 0;
+    storage.Update(_key, [this, &error, &number](bool present, std::string &value) {
+        error = nullptr;
+        number = 0;
+        if (present && !ParseInteger(value, number)) {
+            error = "-ERR value is not an integer or out of range";
+            return false;
+        }
+        if ((_delta > 0 && number > std::numeric_limits<int64_t>::max() - _delta) ||
+            (_delta < 0 && number < std::numeric_limits<int64_t>::min() - _delta)) {
+            error = "-ERR increment or decrement would overflow";
+            return false;
+        }
+
+        number += _delta;
+        value = std::to_string(number);
+        return true;
+    });
+
+    if (error != nullptr) {
+        out.push_back(reply(error));
+    } else {
+        out.push_back(reply_integer(number));
+    }
+}
+
+// See Resp.h
+void RespExpire::ExecuteChunked(Storage &storage, const std::string &args, std::vector<ValueChunk> &out) {
+    bool found = (_ttl > 0) ? storage.Touch(_key, _ttl) : storage.Delete(_key);
+    out.push_back(reply_integer(found ? 1 : 0));
+}
+
+// See Resp.h
+void RespPing::Execute(Storage &storage, const std::string &args, std::string &out) { out = "+PONG"; }
+
+// See Resp.h
+void RespError::Execute(Storage &storage, const std::string &args, std::string &out) { out = "-ERR " + _message; }
+
+} // namespace Execute
+} // namespace Afina
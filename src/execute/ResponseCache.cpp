@@ -0,0 +1,142 @@
+#include <afina/execute/Counters.h>
+#include <afina/execute/ResponseCache.h>
+
+#include <chrono>
+#include <functional>
+#include <utility>
+
+#include "storage/Versioned.h"
+
+namespace Afina {
+namespace Execute {
+
+const std::size_t ResponseCache::kShards;
+const std::size_t ResponseCache::kShardCapacity;
+
+namespace {
+
+uint64_t now() {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+               std::chrono::steady_clock::now().time_since_epoch())
+        .count();
+}
+
+// Only gets of several keys are worth caching, the single key ones are a storage lookup anyway
+bool cached(const Get &get) { return get.keys().size() > 1; }
+
+} // namespace
+
+// See ResponseCache.h
+ResponseCache::ResponseCache(std::shared_ptr<Dispatcher> next, uint32_t lifetime)
+    : _next(std::move(next)), _lifetime(uint64_t(lifetime) * 1000000) {}
+
+// See ResponseCache.h
+void ResponseCache::ExecuteTo(Storage &storage, Command &command, std::string &&args, OutputSink &out) {
+    if (command.kind() == Command::Kind::kGet && cached(static_cast<Get &>(command))) {
+        Execute(static_cast<Backend::Versioned &>(storage), static_cast<Get &>(command), out);
+    } else {
+        _next->ExecuteTo(storage, command, std::move(args), out);
+    }
+}
+
+// See ResponseCache.h
+void ResponseCache::ExecuteGets(Storage &storage, Get *const *gets, std::size_t count, OutputSink &out) {
+    std::size_t from = 0;
+    for (std::size_t i = 0; i < count; i++) {
+        if (!cached(*gets[i])) {
+            continue;
+        }
+        if (from < i) {
+            _next->ExecuteGets(storage, gets + from, i - from, out);
+        }
+        Execute(static_cast<Backend::Versioned &>(storage), *gets[i], out);
+        out.Append("\r\n", 2);
+        from = i + 1;
+    }
+    if (from < count) {
+        _next->ExecuteGets(storage, gets + from, count - from, out);
+    }
+}
+
+// See ResponseCache.h
+void ResponseCache::Execute(Backend::Versioned &storage, Get &get, OutputSink &out) {
+    std::string key;
+    for (auto &k : get.keys()) {
+        if (!key.empty()) {
+            key.push_back(' ');
+        }
+        key.append(k);
+    }
+
+    uint64_t started = now();
+    Shard &shard = _shards[std::hash<std::string>()(key) % kShards];
+    std::shared_ptr<const Entry> entry;
+    {
+        std::lock_guard<std::mutex> lock(shard.lock);
+        auto it = shard.entries.find(key);
+        if (it != shard.entries.end()) {
+            entry = it->second;
+        }
+    }
+
+    if (entry && Fresh(storage, *entry, started)) {
+        get.LogKeys();
+        get.Count(entry->hits);
+        Counters::Add(Counters::kResponseCacheHits);
+        out.Reference(entry->response);
+        return;
+    }
+    Counters::Add(Counters::kResponseCacheMisses);
+
+    // Versions are taken before values are read: change made meanwhile makes response stale at once
+    std::shared_ptr<Entry> built(new Entry());
+    for (auto &k : get.keys()) {
+        std::size_t slot = Backend::Versioned::Slot(k);
+        built->slots.push_back(slot);
+        built->versions.push_back(storage.Version(slot));
+    }
+
+    OutputSink::Mark before = out.Position();
+    built->hits = get.ExecuteOn(storage, out);
+
+    std::shared_ptr<std::string> response(new std::string());
+    out.CopyTo(before, *response);
+    built->response = std::move(response);
+    built->expires = started + _lifetime;
+    Insert(shard, storage, std::move(key), std::move(built), started);
+}
+
+// See ResponseCache.h
+bool ResponseCache::Fresh(const Backend::Versioned &storage, const Entry &entry, uint64_t now) {
+    if (entry.expires <= now) {
+        return false;
+    }
+    for (std::size_t i = 0; i < entry.slots.size(); i++) {
+        if (storage.Version(entry.slots[i]) != entry.versions[i]) {
+            return false;
+        }
+    }
+    return true;
+}
+
+// See ResponseCache.h
+void ResponseCache::Insert(Shard &shard, const Backend::Versioned &storage, std::string &&key,
+                           std::shared_ptr<const Entry> &&entry, uint64_t now) {
+    std::lock_guard<std::mutex> lock(shard.lock);
+    if (shard.entries.size() >= kShardCapacity && shard.entries.count(key) == 0) {
+        for (auto it = shard.entries.begin(); it != shard.entries.end();) {
+            if (Fresh(storage, *it->second, now)) {
+                ++it;
+            } else {
+                it = shard.entries.erase(it);
+            }
+        }
+        if (shard.entries.size() >= kShardCapacity) {
+            shard.entries.erase(shard.entries.begin());
+        }
+    }
+    shard.entries[key] = std::move(entry);
+}
+
+} // namespace Execute
+} // namespace Afina
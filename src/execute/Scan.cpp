@@ -0,0 +1,42 @@
+#include <afina/Storage.h>
+#include <afina/execute/Scan.h>
+
+#include <algorithm>
+#include <vector>
+
+namespace Afina {
+namespace Execute {
+
+const std::size_t Scan::kDefaultLimit;
+const std::size_t Scan::kChunkSize;
+
+// Not a part of memcached protocol: each storage call holds storage (and its locks) only
+// for kChunkSize keys, the last key of a chunk is used as cursor for the next one
+void Scan::Execute(Storage &storage, const std::string &args, std::string &out) {
+    std::vector<std::string> keys;
+    std::string cursor = _start;
+
+    out.clear();
+    std::size_t remains = _limit;
+    while (remains > 0) {
+        keys.clear();
+        Storage::ScanResult result = storage.Scan(_prefix, cursor, std::min(remains, kChunkSize), keys);
+        if (result == Storage::ScanResult::kUnsupported) {
+            out = "SERVER_ERROR scan is not supported by the storage";
+            return;
+        }
+        for (auto &key : keys) {
+            out.append("KEY ").append(key).append("\r\n");
+        }
+
+        remains -= keys.size();
+        if (result == Storage::ScanResult::kEnd || keys.empty()) {
+            break;
+        }
+        cursor = keys.back();
+    }
+    out.append("END"); // networking layer should add the last \r\n
+}
+
+} // namespace Execute
+} // namespace Afina
@@ -1,17 +1,39 @@
 #include <afina/Storage.h>
+#include <afina/execute/Counters.h>
 #include <afina/execute/Set.h>
 
-#include <iostream>
+#include <utility>
+
+#include "Trace.h"
 
 namespace Afina {
 namespace Execute {
 
 // memcached protocol: "set" means "store this data".
 void Set::Execute(Storage &storage, const std::string &args, std::string &out) {
-    std::cout << "Set(" << _key << "): " << args << std::endl;
-    storage.Put(_key, args);
+    Trace(args.size());
+    Counters::Add(Counters::kCmdSet);
+    if (storage.Put(_key, args) && _expire != 0) {
+        storage.Touch(_key, memcached_ttl(_expire));
+    }
     out = "STORED";
 }
 
+// See Set.h
+void Set::ExecuteOwned(Storage &storage, std::string &&args, std::vector<ValueChunk> &out) {
+    Adopt(storage, std::move(args));
+    out.push_back(std::make_shared<std::string>("STORED"));
+}
+
+// See Set.h
+void Set::ExecuteTo(Storage &storage, std::string &&args, OutputSink &out) { ExecuteOn(storage, std::move(args), out); }
+
+// See Set.h
+void Set::Trace(std::size_t size) const {
+    if (auto logger = tracer()) {
+        logger->trace("Set({}): {} bytes", _key, size);
+    }
+}
+
 } // namespace Execute
 } // namespace Afina
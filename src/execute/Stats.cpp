@@ -1,14 +1,115 @@
 #include <afina/Storage.h>
+#include <afina/execute/Counters.h>
+#include <afina/execute/Latency.h>
 #include <afina/execute/Stats.h>
 
-#include <iostream>
-#include <iterator>
-#include <sstream>
+#include <chrono>
+#include <cstdio>
+#include <ctime>
+
+#include <sys/resource.h>
+#include <unistd.h>
 
 namespace Afina {
 namespace Execute {
 
-void Stats::Execute(Storage &storage, const std::string &args, std::string &out) { out.assign("END"); }
+namespace {
+
+// Server uptime is counted from the moment library is loaded, that is the process start
+const std::chrono::steady_clock::time_point started = std::chrono::steady_clock::now();
+
+void append_stat(std::string &out, const char *name, const std::string &value) {
+    out.append("STAT ").append(name).append(" ").append(value).append("\r\n");
+}
+
+void append_stat(std::string &out, const char *name, uint64_t value) { append_stat(out, name, std::to_string(value)); }
+
+void append_stats(std::string &out, const std::vector<std::pair<std::string, std::string>> &stats) {
+    for (auto &stat : stats) {
+        append_stat(out, stat.first.c_str(), stat.second);
+    }
+}
+
+// CPU time the way memcached prints it: seconds.microseconds
+std::string seconds(const struct timeval &time) {
+    char buffer[32];
+    std::snprintf(buffer, sizeof(buffer), "%ld.%06ld", static_cast<long>(time.tv_sec), static_cast<long>(time.tv_usec));
+    return buffer;
+}
+
+} // namespace
+
+/* memcached protocol:
+
+The server responds with a list of statistics items, each one is a line:
+
+STAT <name> <value>\r\n
+
+The server terminates this list with the line
+
+END\r\n
+
+*/
+void Stats::Execute(Storage &storage, const std::string &args, std::string &out) {
+    out.clear();
+    if (_section == "latency") {
+        std::vector<std::pair<std::string, std::string>> stats;
+        Latency::Report(stats);
+        append_stats(out, stats);
+        out.append("END");
+        return;
+    } else if (!_section.empty()) {
+        out = "CLIENT_ERROR unknown stats section " + _section;
+        return;
+    }
+
+    uint64_t counters[Counters::kCount];
+    Counters::Collect(counters);
+
+    append_stat(out, "pid", static_cast<uint64_t>(getpid()));
+    append_stat(out, "uptime",
+                std::chrono::duration_cast<std::chrono::seconds>(std::chrono::steady_clock::now() - started).count());
+    append_stat(out, "time", static_cast<uint64_t>(std::time(nullptr)));
+    append_stat(out, "pointer_size", 8 * sizeof(void *));
+
+    struct rusage usage;
+    if (getrusage(RUSAGE_SELF, &usage) == 0) {
+        append_stat(out, "rusage_user", seconds(usage.ru_utime));
+        append_stat(out, "rusage_system", seconds(usage.ru_stime));
+    }
+
+    // Counters are read one by one, connection could be closed in between
+    uint64_t opened = counters[Counters::kConnectionsOpened];
+    uint64_t closed = counters[Counters::kConnectionsClosed];
+    append_stat(out, "curr_connections", opened > closed ? opened - closed : 0);
+    append_stat(out, "total_connections", opened);
+
+    append_stat(out, "cmd_get", counters[Counters::kCmdGet]);
+    append_stat(out, "cmd_set", counters[Counters::kCmdSet]);
+    append_stat(out, "cmd_flush", counters[Counters::kCmdFlush]);
+    append_stat(out, "cmd_touch", counters[Counters::kCmdTouch]);
+    append_stat(out, "get_hits", counters[Counters::kGetHits]);
+    append_stat(out, "get_misses", counters[Counters::kGetMisses]);
+    append_stat(out, "delete_misses", counters[Counters::kDeleteMisses]);
+    append_stat(out, "delete_hits", counters[Counters::kDeleteHits]);
+    append_stat(out, "touch_hits", counters[Counters::kTouchHits]);
+    append_stat(out, "touch_misses", counters[Counters::kTouchMisses]);
+    append_stat(out, "requests_timed_out", counters[Counters::kTimedOut]);
+
+    uint64_t cache_hits = counters[Counters::kResponseCacheHits];
+    uint64_t cache_lookups = cache_hits + counters[Counters::kResponseCacheMisses];
+    char ratio[32];
+    std::snprintf(ratio, sizeof(ratio), "%.3f", cache_lookups == 0 ? 0.0 : double(cache_hits) / cache_lookups);
+    append_stat(out, "response_cache_hits", cache_hits);
+    append_stat(out, "response_cache_misses", counters[Counters::kResponseCacheMisses]);
+    append_stat(out, "response_cache_hit_ratio", ratio);
+
+    // Items, bytes and evictions are known to the storage only
+    std::vector<std::pair<std::string, std::string>> stats;
+    storage.GetStats(stats);
+    append_stats(out, stats);
+    out.append("END"); // networking layer should add the last \r\n
+}
 
 } // namespace Execute
 } // namespace Afina
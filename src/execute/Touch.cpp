@@ -0,0 +1,24 @@
+#include <afina/Storage.h>
+#include <afina/execute/Counters.h>
+#include <afina/execute/Touch.h>
+
+#include "Trace.h"
+
+namespace Afina {
+namespace Execute {
+
+// memcached protocol: "touch" is used to update the expiration time of an existing item without fetching it.
+void Touch::Execute(Storage &storage, const std::string &args, std::string &out) {
+    if (auto logger = tracer()) {
+        logger->trace("Touch({}): {}", _key, _expire);
+    }
+
+    // Item expired by touch is gone, but it was found
+    bool found = storage.Touch(_key, memcached_ttl(_expire));
+    Counters::Add(Counters::kCmdTouch);
+    Counters::Add(found ? Counters::kTouchHits : Counters::kTouchMisses);
+    out.assign(found ? "TOUCHED" : "NOT_FOUND");
+}
+
+} // namespace Execute
+} // namespace Afina
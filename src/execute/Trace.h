@@ -0,0 +1,24 @@
+#ifndef AFINA_EXECUTE_TRACE_H
+#define AFINA_EXECUTE_TRACE_H
+
+#include <spdlog/logger.h>
+
+namespace Afina {
+namespace Execute {
+
+// Logger given to set_logger, nullptr if there is none
+extern spdlog::logger *trace_logger;
+
+/**
+ * Returns logger if command execution should be traced and nullptr otherwise. That is just a pointer and
+ * a level check, so commands call it before building anything for the log message
+ */
+inline spdlog::logger *tracer() {
+    spdlog::logger *logger = trace_logger;
+    return (logger != nullptr && logger->should_log(spdlog::level::trace)) ? logger : nullptr;
+}
+
+} // namespace Execute
+} // namespace Afina
+
+#endif // AFINA_EXECUTE_TRACE_H
@@ -3,6 +3,8 @@
 #include <memory>
 
 #include <atomic>
+#include <condition_variable>
+#include <mutex>
 #include <semaphore.h>
 #include <signal.h>
 #include <thread>
@@ -11,6 +13,10 @@
 
 #include <afina/Storage.h>
 #include <afina/Version.h>
+#include <afina/execute/Command.h>
+#include <afina/execute/Dispatcher.h>
+#include <afina/execute/Latency.h>
+#include <afina/execute/ResponseCache.h>
 #include <afina/logging/Service.h>
 #include <afina/network/Server.h>
 
@@ -21,8 +27,12 @@
 #include "network/st_coroutine/ServerImpl.h"
 #include "network/st_nonblocking/ServerImpl.h"
 
+#include "storage/ARC.h"
+#include "storage/ConcurrentHash.h"
 #include "storage/SimpleLRU.h"
+#include "storage/ThreadSafeARC.h"
 #include "storage/ThreadSafeSimpleLRU.h"
+#include "storage/Versioned.h"
 
 using namespace Afina;
 
@@ -51,32 +61,93 @@ public:
             storage_type = options["storage"].as<std::string>();
         }
 
+        // Optional second tier on the local disk
+        std::unique_ptr<Afina::Backend::FileTier> tier;
+        if (options.count("tier2-file") > 0) {
+            std::size_t tier_size = 64 * 1024 * 1024;
+            if (options.count("tier2-size") > 0) {
+                tier_size = options["tier2-size"].as<std::size_t>();
+            }
+            tier.reset(new Afina::Backend::FileTier(options["tier2-file"].as<std::string>(), tier_size));
+        }
+
+        // Commands are dispatched on the concrete storage type, see Execute::StaticDispatcher
         if (storage_type == "st_lru") {
-            storage = std::make_shared<Afina::Backend::SimpleLRU>();
+            auto lru = std::make_shared<Afina::Backend::SimpleLRU>();
+            lru->SetSecondTier(std::move(tier));
+            storage = lru;
+            dispatcher = std::make_shared<Execute::StaticDispatcher<Afina::Backend::SimpleLRU>>();
         } else if (storage_type == "mt_lru") {
-            storage = std::make_shared<Afina::Backend::ThreadSafeSimplLRU>();
+            auto lru = std::make_shared<Afina::Backend::ThreadSafeSimplLRU>();
+            lru->SetSecondTier(std::move(tier));
+            storage = lru;
+            dispatcher = std::make_shared<Execute::StaticDispatcher<Afina::Backend::ThreadSafeSimplLRU>>();
+        } else if (storage_type == "st_arc") {
+            storage = std::make_shared<Afina::Backend::ARC>();
+            dispatcher = std::make_shared<Execute::StaticDispatcher<Afina::Backend::ARC>>();
+        } else if (storage_type == "mt_arc") {
+            storage = std::make_shared<Afina::Backend::ThreadSafeARC>();
+            dispatcher = std::make_shared<Execute::StaticDispatcher<Afina::Backend::ThreadSafeARC>>();
+        } else if (storage_type == "mt_hash") {
+            storage = std::make_shared<Afina::Backend::ConcurrentHash>();
+            dispatcher = std::make_shared<Execute::StaticDispatcher<Afina::Backend::ConcurrentHash>>();
         } else {
             throw std::runtime_error("Unknown storage type");
         }
 
+        // Optional cache of the multi-get responses, it needs storage to count changes of the keys
+        if (options.count("response-cache") > 0) {
+            uint32_t lifetime = options["response-cache"].as<uint32_t>();
+            if (lifetime > 0) {
+                storage = std::make_shared<Afina::Backend::Versioned>(storage);
+                dispatcher = std::make_shared<Execute::ResponseCache>(
+                    std::make_shared<Execute::StaticDispatcher<Afina::Backend::Versioned>>(), lifetime);
+            }
+        }
+
         // Step 2: Configure network
         std::string network_type = "st_block";
         if (options.count("network") > 0) {
             network_type = options["network"].as<std::string>();
         }
 
-        if (network_type == "st_block") {
-            server = std::make_shared<Afina::Network::STblocking::ServerImpl>(storage, logService);
-        } else if (network_type == "mt_block") {
-            server = std::make_shared<Afina::Network::MTblocking::ServerImpl>(storage, logService);
-        } else if (network_type == "st_nonblock") {
-            server = std::make_shared<Afina::Network::STnonblock::ServerImpl>(storage, logService);
-        } else if (network_type == "mt_nonblock") {
-            server = std::make_shared<Afina::Network::MTnonblock::ServerImpl>(storage, logService);
-        } else if (network_type == "st_coroutine") {
-            server = std::make_shared<Afina::Network::STcoroutine::ServerImpl>(storage, logService);
-        } else {
-            throw std::runtime_error("Unknown network type");
+        server = MakeServer(network_type);
+
+        // Optional second port for Redis clients, served by the same kind of network service
+        if (options.count("resp-port") > 0) {
+            // Two services run in parallel and share the storage
+            if (storage_type.compare(0, 3, "st_") == 0) {
+                throw std::runtime_error("RESP port requires thread safe storage");
+            }
+            resp_port = options["resp-port"].as<uint16_t>();
+            resp_server = MakeServer(network_type);
+            resp_server->SetFrontend(Network::Server::Frontend::Resp);
+        }
+
+        // Optional threads to execute commands on, off the network threads
+        if (options.count("executor-threads") > 0) {
+            uint32_t executor_threads = options["executor-threads"].as<uint32_t>();
+            if (executor_threads > 0 && storage_type.compare(0, 3, "st_") == 0) {
+                throw std::runtime_error("Executor threads require thread safe storage");
+            }
+            server->SetExecutorThreads(executor_threads);
+            if (resp_server) {
+                resp_server->SetExecutorThreads(executor_threads);
+            }
+        }
+
+        // Optional deadline of the requests, expired ones are answered with an error instead of being executed
+        if (options.count("request-timeout") > 0) {
+            uint32_t request_timeout = options["request-timeout"].as<uint32_t>();
+            server->SetRequestTimeout(request_timeout);
+            if (resp_server) {
+                resp_server->SetRequestTimeout(request_timeout);
+            }
+        }
+
+        // Step 3: optional latency report
+        if (options.count("latency-log") > 0) {
+            latency_period = options["latency-log"].as<uint32_t>();
         }
     }
 
@@ -86,6 +157,9 @@ public:
         auto log = logService->select("root");
         log->warn("Start afina server {}", Afina::get_version());
 
+        // Commands trace their execution if "execute" logger is at trace level
+        Execute::set_logger(logService->select("execute"));
+
         log->warn("Start storage");
         storage->Start();
 
@@ -93,25 +167,107 @@ public:
         const uint16_t port = 8080;
         log->warn("Start network on {}", port);
         server->Start(port, 2, 2);
+
+        if (resp_server) {
+            log->warn("Start RESP network on {}", resp_port);
+            resp_server->Start(resp_port, 2, 2);
+        }
+
+        if (latency_period > 0) {
+            latency_thread = std::thread(&Application::LogLatency, this);
+        }
     }
 
     // Stop services in correct order
     void Stop() {
         auto log = logService->select("root");
         log->warn("Stop application");
+        if (latency_thread.joinable()) {
+            {
+                std::lock_guard<std::mutex> lock(latency_mutex);
+                latency_stop = true;
+            }
+            latency_stopped.notify_all();
+            latency_thread.join();
+        }
+
         server->Stop();
+        if (resp_server) {
+            resp_server->Stop();
+        }
         server->Join();
+        if (resp_server) {
+            resp_server->Join();
+        }
 
         storage->Stop();
+        Execute::set_logger(nullptr);
         logService->Stop();
     }
 
 private:
+    // Writes latency histograms of all the series into the log once per latency_period seconds
+    void LogLatency() {
+        auto log = logService->select("latency");
+        std::unique_lock<std::mutex> lock(latency_mutex);
+        while (!latency_stopped.wait_for(lock, std::chrono::seconds(latency_period), [this] { return latency_stop; })) {
+            std::vector<std::pair<std::string, std::string>> stats;
+            Execute::Latency::Report(stats);
+
+            // Stats of a series go one after another, named "<backend>:<series>:<stat>"
+            std::string series, line;
+            for (auto &stat : stats) {
+                std::size_t colon = stat.first.rfind(':');
+                if (stat.first.compare(0, colon, series) != 0) {
+                    if (!line.empty()) {
+                        log->warn("{}", line);
+                    }
+                    series = stat.first.substr(0, colon);
+                    line = series;
+                }
+                line.append(" ").append(stat.first, colon + 1, std::string::npos).append("=").append(stat.second);
+            }
+            if (!line.empty()) {
+                log->warn("{}", line);
+            }
+        }
+    }
+
+    // Creates network service of the given type
+    std::shared_ptr<Network::Server> MakeServer(const std::string &network_type) {
+        std::shared_ptr<Network::Server> result;
+        if (network_type == "st_block") {
+            result = std::make_shared<Afina::Network::STblocking::ServerImpl>(storage, logService);
+        } else if (network_type == "mt_block") {
+            result = std::make_shared<Afina::Network::MTblocking::ServerImpl>(storage, logService);
+        } else if (network_type == "st_nonblock") {
+            result = std::make_shared<Afina::Network::STnonblock::ServerImpl>(storage, logService);
+        } else if (network_type == "mt_nonblock") {
+            result = std::make_shared<Afina::Network::MTnonblock::ServerImpl>(storage, logService);
+        } else if (network_type == "st_coroutine") {
+            result = std::make_shared<Afina::Network::STcoroutine::ServerImpl>(storage, logService);
+        } else {
+            throw std::runtime_error("Unknown network type");
+        }
+        result->SetDispatcher(dispatcher);
+        return result;
+    }
+
     std::shared_ptr<Logging::Config> logConfig;
     std::shared_ptr<Logging::Service> logService;
 
     std::shared_ptr<Afina::Storage> storage;
+    std::shared_ptr<Execute::Dispatcher> dispatcher;
     std::shared_ptr<Network::Server> server;
+
+    uint16_t resp_port = 0;
+    std::shared_ptr<Network::Server> resp_server;
+
+    uint32_t latency_period = 0;
+    std::thread latency_thread;
+    std::mutex latency_mutex;
+    std::condition_variable latency_stopped;
+    bool latency_stop = false;
 };
 
 // Signal set that to notify application about time to stop
@@ -131,7 +287,23 @@ int main(int argc, char **argv) {
         // TODO: use custom cxxopts::value to print options possible values in help message
         // and simplify validation below
         options.add_options()("s,storage", "Type of storage service to use", cxxopts::value<std::string>());
+        options.add_options()("tier2-file", "File to spill items evicted from memory to",
+                              cxxopts::value<std::string>());
+        options.add_options()("tier2-size", "Maximum size of the spill file in bytes", cxxopts::value<std::size_t>());
         options.add_options()("n,network", "Type of network service to use", cxxopts::value<std::string>());
+        options.add_options()("resp-port", "Port to serve Redis protocol clients on, disabled by default",
+                              cxxopts::value<uint16_t>());
+        options.add_options()("executor-threads",
+                              "Threads to execute commands on, 0 to execute on the network thread (st_nonblock only)",
+                              cxxopts::value<uint32_t>());
+        options.add_options()("request-timeout",
+                              "Answer requests that waited longer than given number of milliseconds with an error",
+                              cxxopts::value<uint32_t>());
+        options.add_options()("response-cache",
+                              "Cache responses of multi-key gets for given number of milliseconds, disabled by default",
+                              cxxopts::value<uint32_t>());
+        options.add_options()("latency-log", "Log request latency histograms every given number of seconds",
+                              cxxopts::value<uint32_t>());
         options.add_options()("h,help", "Print usage info");
         options.parse(argc, argv);
 
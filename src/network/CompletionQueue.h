@@ -0,0 +1,73 @@
+#ifndef AFINA_NETWORK_COMPLETION_QUEUE_H
+#define AFINA_NETWORK_COMPLETION_QUEUE_H
+
+#include <cerrno>
+#include <cstring>
+#include <mutex>
+#include <stdexcept>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include <sys/eventfd.h>
+#include <unistd.h>
+
+namespace Afina {
+namespace Network {
+
+/**
+ * # Work done off the network thread
+ * Executor threads push items whose work is complete, network thread finds them out through the eventfd it
+ * waits on along with the sockets. Any number of pushes between two pops wake network thread up once
+ */
+template <typename T> class CompletionQueue {
+public:
+    CompletionQueue() : _event_fd(eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC)) {
+        if (_event_fd == -1) {
+            throw std::runtime_error("Failed to create completion eventfd: " + std::string(strerror(errno)));
+        }
+    }
+
+    ~CompletionQueue() { close(_event_fd); }
+
+    /**
+     * Descriptor to wait on, it is readable while queue is not empty
+     */
+    int Descriptor() const { return _event_fd; }
+
+    /**
+     * Adds complete item, any thread
+     */
+    void Push(T *item) {
+        {
+            std::lock_guard<std::mutex> lock(_mutex);
+            _items.push_back(item);
+        }
+        eventfd_write(_event_fd, 1);
+    }
+
+    /**
+     * Takes all complete items, network thread only
+     */
+    void Pop(std::vector<T *> &items) {
+        eventfd_t count;
+        eventfd_read(_event_fd, &count);
+
+        items.clear();
+        std::lock_guard<std::mutex> lock(_mutex);
+        std::swap(items, _items);
+    }
+
+private:
+    CompletionQueue(const CompletionQueue &);            // = delete;
+    CompletionQueue &operator=(const CompletionQueue &); // = delete;
+
+    int _event_fd;
+    std::mutex _mutex;
+    std::vector<T *> _items;
+};
+
+} // namespace Network
+} // namespace Afina
+
+#endif // AFINA_NETWORK_COMPLETION_QUEUE_H
@@ -0,0 +1,46 @@
+#include "RequestTimer.h"
+
+namespace Afina {
+namespace Network {
+
+const std::size_t RequestTimer::kBinary;
+const std::size_t RequestTimer::kResp;
+const std::size_t RequestTimer::kKinds;
+
+namespace {
+
+// Series are the same for all backends, so names are registered once per process
+struct Names {
+    std::size_t execute[RequestTimer::kKinds];
+    std::size_t total[RequestTimer::kKinds];
+    std::size_t write;
+
+    Names() {
+        for (std::size_t kind = 0; kind < RequestTimer::kKinds; kind++) {
+            std::string name;
+            if (kind == RequestTimer::kBinary) {
+                name = "binary";
+            } else if (kind == RequestTimer::kResp) {
+                name = "resp";
+            } else {
+                name = Protocol::command_name(static_cast<Protocol::CommandType>(kind));
+            }
+            execute[kind] = Execute::Latency::Series(name + ":execute");
+            total[kind] = Execute::Latency::Series(name + ":total");
+        }
+        write = Execute::Latency::Series("write");
+    }
+};
+
+} // namespace
+
+// See RequestTimer.h
+RequestTimer::RequestTimer(const std::string &backend) : _backend(Execute::Latency::Backend(backend)) {
+    static const Names names;
+    _execute = names.execute;
+    _total = names.total;
+    _write = names.write;
+}
+
+} // namespace Network
+} // namespace Afina
@@ -0,0 +1,108 @@
+#ifndef AFINA_NETWORK_REQUEST_TIMER_H
+#define AFINA_NETWORK_REQUEST_TIMER_H
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include <afina/execute/Latency.h>
+
+#include "protocol/CommandType.h"
+
+namespace Afina {
+namespace Network {
+
+/**
+ * # Latency of the requests of a single connection
+ * Records into Execute::Latency histograms of the backend:
+ * - "<command>:execute": time command took to execute
+ * - "<command>:total": from the moment request is parsed out of the input till its response is written
+ * - "write": time of a single write of the responses batch
+ *
+ * Commands of the text protocol are told apart by the type, binary and Redis protocol requests are counted
+ * as "binary" and "resp". Clock is read once per command and twice per batch. Timer is not thread safe,
+ * it lives as long as connection does
+ */
+class RequestTimer {
+public:
+    // Request kinds that are not text protocol commands
+    static const std::size_t kBinary = static_cast<std::size_t>(Protocol::CommandType::kMetaNoop) + 1;
+    static const std::size_t kResp = kBinary + 1;
+    static const std::size_t kKinds = kResp + 1;
+
+    static std::size_t Kind(Protocol::CommandType type) { return static_cast<std::size_t>(type); }
+
+    explicit RequestTimer(const std::string &backend);
+
+    /**
+     * Requests read so far are parsed, their time starts now. Drops requests of the batch that failed
+     */
+    void Parsed() {
+        _pending.clear();
+        _parsed = _last = Now();
+    }
+
+    /**
+     * Request of the given kind has just been executed
+     */
+    void Executed(std::size_t kind) {
+        uint64_t time = Now();
+        Execute::Latency::Record(_backend, _execute[kind], time - _last);
+        _last = time;
+        _pending.push_back(static_cast<uint8_t>(kind));
+    }
+
+    /**
+     * Responses of the batch have just been written
+     */
+    void Written() {
+        uint64_t time = Now();
+        Execute::Latency::Record(_backend, _write, time - _last);
+        _last = time;
+    }
+
+    /**
+     * Batch is over: records total time of every request executed since Parsed
+     */
+    void Finished() {
+        for (auto kind : _pending) {
+            Execute::Latency::Record(_backend, _total[kind], _last - _parsed);
+        }
+        _pending.clear();
+    }
+
+    /**
+     * Time of the latest event timer got, requests of the batch are not executed before it
+     */
+    uint64_t Last() const { return _last; }
+
+    /**
+     * Clock timer reads, steady clock nanoseconds
+     */
+    static uint64_t Now() {
+        return std::chrono::duration_cast<std::chrono::nanoseconds>(
+                   std::chrono::steady_clock::now().time_since_epoch())
+            .count();
+    }
+
+private:
+
+    // Histogram indices: series of every request kind are shared by all timers
+    std::size_t _backend;
+    const std::size_t *_execute;
+    const std::size_t *_total;
+    std::size_t _write;
+
+    uint64_t _parsed = 0;
+    uint64_t _last = 0;
+
+    // Kinds of the requests executed since Parsed
+    std::vector<uint8_t> _pending;
+};
+
+} // namespace Network
+} // namespace Afina
+
+#endif // AFINA_NETWORK_REQUEST_TIMER_H
@@ -0,0 +1,217 @@
+#include "Utils.h"
+
+#include <algorithm>
+#include <cerrno>
+#include <cstdlib>
+#include <cstring>
+#include <stdexcept>
+
+#include <limits.h>
+#include <sys/uio.h>
+
+#include <afina/Storage.h>
+#include <afina/execute/Counters.h>
+#include <afina/execute/Dispatcher.h>
+#include <afina/execute/Get.h>
+#include <afina/execute/Meta.h>
+
+namespace Afina {
+namespace Network {
+
+namespace {
+
+// Longest run of gets looked up at once, storage might hold a lock all that time
+const std::size_t kMaxCoalesced = 32;
+
+inline bool coalesced(const Protocol::Parser::Request &request) {
+    return request.command->kind() == Execute::Command::Kind::kGet && !request.noreply;
+}
+
+// Checks if request has waited for too long by the time now
+bool expired(const Protocol::Parser::Request &request, bool resp, uint64_t timeout, uint64_t now) {
+    switch (resp ? Protocol::CommandType::kUnknown : request.type) {
+    case Protocol::CommandType::kMetaGet:
+    case Protocol::CommandType::kMetaSet:
+    case Protocol::CommandType::kMetaDelete:
+    case Protocol::CommandType::kMetaArithmetic: {
+        const std::string &deadline = static_cast<const Execute::MetaCommand &>(*request.command).Token('L');
+        // Client could only make deadline shorter, L0 means client has no deadline of its own
+        uint64_t client = deadline.empty() ? 0 : std::strtoull(deadline.c_str(), nullptr, 10) * 1000000;
+        if (client != 0 && (timeout == 0 || client < timeout)) {
+            timeout = client;
+        }
+        break;
+    }
+    case Protocol::CommandType::kMetaNoop:
+        // Pipeline terminator costs nothing, client waits for it to see the batch is over
+        return false;
+    default:
+        break;
+    }
+    return timeout != 0 && request.received != 0 && now > request.received + timeout;
+}
+
+bool expired(const Protocol::BinaryParser::Request &request, uint64_t timeout, uint64_t now) {
+    if (request.opcode == Protocol::BinaryParser::opNoop) {
+        return false;
+    }
+    return timeout != 0 && request.received != 0 && now > request.received + timeout;
+}
+
+} // namespace
+
+// See Utils.h
+void stamp_requests(std::vector<Protocol::Parser::Request> &requests, std::size_t from) {
+    uint64_t now = RequestTimer::Now();
+    for (std::size_t i = from; i < requests.size(); i++) {
+        requests[i].received = now;
+    }
+}
+
+// See Utils.h
+void stamp_requests(std::vector<Protocol::BinaryParser::Request> &requests, std::size_t from) {
+    uint64_t now = RequestTimer::Now();
+    for (std::size_t i = from; i < requests.size(); i++) {
+        requests[i].received = now;
+    }
+}
+
+// See Utils.h
+void execute_requests(Execute::Dispatcher &dispatcher, Storage &storage,
+                      std::vector<Protocol::Parser::Request> &requests, Execute::OutputSink &output,
+                      RequestTimer &timer, bool resp, uint64_t timeout) {
+    // Batch might have waited for the executor, so clock is read once it starts. After that timer knows the time
+    // the last command is done, that is when the next one starts
+    uint64_t started = std::max(RequestTimer::Now(), timer.Last());
+
+    Execute::Get *gets[kMaxCoalesced];
+    for (std::size_t i = 0; i < requests.size();) {
+        uint64_t now = std::max(started, timer.Last());
+        if (expired(requests[i], resp, timeout, now)) {
+            Execute::Counters::Add(Execute::Counters::kTimedOut);
+            if (!requests[i].noreply) {
+                output.Append(resp ? "-ERR timeout\r\n" : "SERVER_ERROR timeout\r\n");
+            }
+            i++;
+            continue;
+        }
+
+        std::size_t count = 0;
+        while (i + count < requests.size() && count < kMaxCoalesced && coalesced(requests[i + count]) &&
+               !expired(requests[i + count], resp, timeout, now)) {
+            gets[count] = static_cast<Execute::Get *>(requests[i + count].command.get());
+            count++;
+        }
+        if (count > 1) {
+            dispatcher.ExecuteGets(storage, gets, count, output);
+            for (; count > 0; count--, i++) {
+                timer.Executed(RequestTimer::Kind(requests[i].type));
+            }
+            continue;
+        }
+
+        Protocol::Parser::Request &request = requests[i++];
+        Execute::OutputSink::Mark before = output.Position();
+        dispatcher.ExecuteTo(storage, *request.command, std::move(request.argument), output);
+        if (request.noreply) {
+            output.Truncate(before);
+        } else if (output.Written(before) != 0) {
+            output.Append("\r\n", 2);
+        }
+        timer.Executed(resp ? RequestTimer::kResp : RequestTimer::Kind(request.type));
+    }
+}
+
+// See Utils.h
+void execute_binary_requests(Execute::Dispatcher &dispatcher, Storage &storage,
+                             std::vector<Protocol::BinaryParser::Request> &requests, Execute::OutputSink &output,
+                             RequestTimer &timer, uint64_t timeout) {
+    uint64_t started = std::max(RequestTimer::Now(), timer.Last());
+    for (auto &request : requests) {
+        if (expired(request, timeout, std::max(started, timer.Last()))) {
+            Execute::Counters::Add(Execute::Counters::kTimedOut);
+            request.status = Protocol::BinaryParser::stTemporaryFailure;
+        }
+        Protocol::BinaryParser::Execute(dispatcher, storage, request, output);
+        timer.Executed(RequestTimer::kBinary);
+    }
+}
+
+// See Utils.h
+void append_parse_error(Execute::OutputSink &output, bool resp, const std::string &error) {
+    // Error could quote client input, that must not break the response line
+    std::string line = error;
+    std::replace(line.begin(), line.end(), '\r', ' ');
+    std::replace(line.begin(), line.end(), '\n', ' ');
+    output.Append(resp ? "-ERR " : "CLIENT_ERROR ");
+    output.Append(line);
+    output.Append("\r\n", 2);
+}
+
+// See Utils.h
+void send_output(int socket, Execute::OutputSink &output) {
+    std::vector<struct iovec> &iov = output.Iov();
+
+    std::size_t first = 0; // first part which is not fully written yet
+    while (first < iov.size()) {
+        int count = std::min<std::size_t>(iov.size() - first, IOV_MAX);
+        ssize_t written = writev(socket, iov.data() + first, count);
+        if (written < 0 && errno == EINTR) {
+            continue;
+        } else if (written <= 0) {
+            throw std::runtime_error("Failed to send response: " + std::string(strerror(errno)));
+        }
+
+        // Drop fully written parts
+        while (first < iov.size() && std::size_t(written) >= iov[first].iov_len) {
+            written -= iov[first].iov_len;
+            first++;
+        }
+        if (first < iov.size()) {
+            iov[first].iov_base = static_cast<char *>(iov[first].iov_base) + written;
+            iov[first].iov_len -= written;
+        }
+    }
+}
+
+// See Utils.h
+bool write_output(int socket, Execute::OutputSink &output, std::size_t &sent) {
+    std::vector<struct iovec> &iov = output.Iov();
+
+    // Skip parts written by the previous calls
+    std::size_t first = 0, skip = sent;
+    while (first < iov.size() && skip >= iov[first].iov_len) {
+        skip -= iov[first].iov_len;
+        first++;
+    }
+    if (first < iov.size()) {
+        iov[first].iov_base = static_cast<char *>(iov[first].iov_base) + skip;
+        iov[first].iov_len -= skip;
+    }
+
+    while (first < iov.size()) {
+        int count = std::min<std::size_t>(iov.size() - first, IOV_MAX);
+        ssize_t written = writev(socket, iov.data() + first, count);
+        if (written < 0 && errno == EINTR) {
+            continue;
+        } else if (written < 0 && (errno == EAGAIN || errno == EWOULDBLOCK)) {
+            return false;
+        } else if (written <= 0) {
+            throw std::runtime_error("Failed to send response: " + std::string(strerror(errno)));
+        }
+
+        sent += written;
+        while (first < iov.size() && std::size_t(written) >= iov[first].iov_len) {
+            written -= iov[first].iov_len;
+            first++;
+        }
+        if (first < iov.size()) {
+            iov[first].iov_base = static_cast<char *>(iov[first].iov_base) + written;
+            iov[first].iov_len -= written;
+        }
+    }
+    return true;
+}
+
+} // namespace Network
+} // namespace Afina
@@ -0,0 +1,100 @@
+#ifndef AFINA_NETWORK_UTILS_H
+#define AFINA_NETWORK_UTILS_H
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include <unistd.h>
+
+#include <afina/execute/OutputSink.h>
+
+#include "network/RequestTimer.h"
+#include "protocol/BinaryParser.h"
+#include "protocol/Parser.h"
+
+namespace Afina {
+class Storage;
+
+namespace Execute {
+class Dispatcher;
+}
+
+namespace Network {
+
+/**
+ * Stamps requests starting from the given one with the current time, as they have just been read
+ */
+void stamp_requests(std::vector<Protocol::Parser::Request> &requests, std::size_t from);
+void stamp_requests(std::vector<Protocol::BinaryParser::Request> &requests, std::size_t from);
+
+/**
+ * Executes parsed requests in order writing their responses into the output, each one terminated with \r\n,
+ * responses of noreply requests are dropped. Runs of consecutive gets are executed at once, keys of the whole
+ * run are looked up by a single storage call, see Execute::Get::ExecuteBatch. Requests are left in place.
+ *
+ * Request that has waited longer than timeout nanoseconds since it was stamped is answered with timeout error
+ * without touching the storage, 0 timeout means requests never expire. Meta commands might set deadline of
+ * their own with L flag, see Execute::MetaCommand
+ */
+void execute_requests(Execute::Dispatcher &dispatcher, Storage &storage,
+                      std::vector<Protocol::Parser::Request> &requests, Execute::OutputSink &output,
+                      RequestTimer &timer, bool resp, uint64_t timeout);
+
+/**
+ * Executes parsed binary protocol requests in order through the dispatcher writing their response packets into
+ * the output, see Protocol::BinaryParser::Execute. Requests are left in place.
+ *
+ * Request that has waited longer than timeout nanoseconds since it was stamped is answered with temporary
+ * failure status without touching the storage, the way execute_requests answers timeout error. Noop never expires
+ */
+void execute_binary_requests(Execute::Dispatcher &dispatcher, Storage &storage,
+                             std::vector<Protocol::BinaryParser::Request> &requests, Execute::OutputSink &output,
+                             RequestTimer &timer, uint64_t timeout);
+
+/**
+ * Appends answer to the request parser failed on: CLIENT_ERROR or -ERR with the error text. Requests parsed
+ * before it are still executed and answered first, connection is closed once this answer is sent
+ */
+void append_parse_error(Execute::OutputSink &output, bool resp, const std::string &error);
+
+/**
+ * Writes whole output into the given blocking socket using vectored writes, so values
+ * are never copied into a single buffer. Throws runtime_error if socket fails before
+ * all data has been written
+ */
+void send_output(int socket, Execute::OutputSink &output);
+
+/**
+ * Writes as much of the output into the non blocking socket as it takes without blocking. Sent is the number
+ * of bytes written by the previous calls, those are skipped, it is increased by the bytes written now.
+ * Returns true once whole output is written, throws runtime_error if socket fails
+ */
+bool write_output(int socket, Execute::OutputSink &output, std::size_t &sent);
+
+/**
+ * Reads the rest of the large data block parser waits for from the blocking socket right into the buffer
+ * parser keeps block in, bypassing client buffer of the given size. Blocks smaller than client buffer are
+ * left for the usual reads along with the commands that follow them.
+ *
+ * Returns result of the failed read: 0 if connection is closed, -1 on error; or 1 if nothing has failed
+ */
+template <typename Parser, typename Request>
+int read_body(int socket, Parser &parser, std::size_t buffer_size, std::vector<Request> &requests) {
+    std::size_t body_size = 0;
+    char *body = parser.BodyBuffer(body_size);
+    while (body != nullptr && body_size >= buffer_size) {
+        int readed_bytes = read(socket, body, body_size);
+        if (readed_bytes <= 0) {
+            return readed_bytes;
+        }
+        parser.BodyReceived(readed_bytes, requests);
+        body = parser.BodyBuffer(body_size);
+    }
+    return 1;
+}
+
+} // namespace Network
+} // namespace Afina
+
+#endif // AFINA_NETWORK_UTILS_H
@@ -5,6 +5,7 @@
 #include <iostream>
 #include <memory>
 #include <stdexcept>
+#include <utility>
 
 #include <arpa/inet.h>
 #include <netdb.h>
@@ -19,9 +20,15 @@
 
 #include <afina/Storage.h>
 #include <afina/execute/Command.h>
+#include <afina/execute/Counters.h>
+#include <afina/execute/OutputSink.h>
 #include <afina/logging/Service.h>
 
+#include "network/RequestTimer.h"
+#include "network/Utils.h"
+#include "protocol/BinaryParser.h"
 #include "protocol/Parser.h"
+#include "protocol/RespParser.h"
 
 namespace Afina {
 namespace Network {
@@ -104,83 +111,96 @@ void ServerImpl::Join() {
 void ServerImpl::RunThread(const int client_socket)
 {
     // - parser: parse state of the stream
-    // - command_to_execute: last command parsed out of stream
-    // - arg_remains: how many bytes to read from stream to get command argument
-    // - argument_for_command: buffer stores argument
-    std::size_t arg_remains = 0;
+    // - requests: commands parsed out of the last read along with their arguments
+    // - binary_parser, binary_requests: the same for connections speaking binary protocol
+    // - resp_parser: parse state of the stream for the server speaking Redis protocol
+    // - result: responses of the commands, values are referenced right in the storage chunks
+    // - timer: latency of the requests, see RequestTimer
     Protocol::Parser parser;
-    std::string argument_for_command;
-    std::unique_ptr<Execute::Command> command_to_execute;
+    std::vector<Protocol::Parser::Request> requests;
+    Protocol::BinaryParser binary_parser;
+    std::vector<Protocol::BinaryParser::Request> binary_requests;
+    Protocol::RespParser resp_parser;
+    Execute::OutputSink result;
+    RequestTimer timer("mt_blocking");
+    Execute::Counters::Add(Execute::Counters::kConnectionsOpened);
 
     try {
         int readed_bytes = -1;
+        bool first_read = true, binary = false;
+        const bool resp = (frontend == Frontend::Resp);
         char client_buffer[4096] = "\0";
         while ((readed_bytes = read(client_socket, client_buffer, sizeof(client_buffer))) > 0) {
             _logger->debug("Got {} bytes from socket", readed_bytes);
 
-            // Single block of data readed from the socket could trigger inside actions a multiple times,
-            // for example:
-            // - read#0: [<command1 start>]
-            // - read#1: [<command1 end> <argument> <command2> <argument for command 2> <command3> ... ]
-            while (readed_bytes > 0) {
-                _logger->debug("Process {} bytes", readed_bytes);
-                // There is no command yet
-                if (!command_to_execute) {
-                    std::size_t parsed = 0;
-                    if (parser.Parse(client_buffer, readed_bytes, parsed)) {
-                        // There is no command to be launched, continue to parse input stream
-                        // Here we are, current chunk finished some command, process it
-                        _logger->debug("Found new command: {} in {} bytes", parser.Name(), parsed);
-                        command_to_execute = parser.Build(arg_remains);
-                        if (arg_remains > 0) {
-                            arg_remains += 2;
-                        }
-                    }
+            // Protocol is picked by the first byte of the connection, binary packets always start with 0x80
+            if (first_read && !resp) {
+                binary = (static_cast<uint8_t>(client_buffer[0]) == Protocol::BinaryParser::kRequestMagic);
+                first_read = false;
+            }
 
-                    // Parsed might fails to consume any bytes from input stream. In real life that could happens,
-                    // for example, because we are working with UTF-16 chars and only 1 byte left in stream
-                    if (parsed == 0) {
-                        break;
+            // Requests parsed before a malformed one are still answered, then connection is closed
+            std::string parse_error;
+            if (binary) {
+                try {
+                    binary_parser.ParseBatch(client_buffer, readed_bytes, binary_requests);
+                } catch (std::runtime_error &ex) {
+                    parse_error = ex.what();
+                }
+                stamp_requests(binary_requests, 0);
+                timer.Parsed();
+                _logger->debug("Found {} new packets", binary_requests.size());
+
+                // Packets go through the same dispatcher and deadline as text commands, values of gets are referenced
+                // by the response, other commands are encoded out of their text results
+                execute_binary_requests(*dispatcher, *pStorage, binary_requests, result, timer, request_timeout);
+                binary_requests.clear();
+            } else {
+                // Single block of data readed from the socket could contain a multiple commands, parse them all
+                // at once, tail of the last incomplete command is kept inside of the parser
+                // - read#0: [<command1 start>]
+                // - read#1: [<command1 end> <argument> <command2> <argument for command 2> <command3> ... ]
+                // Large data block is read from the socket right into the buffer storage is going to keep.
+                // RESP commands are executed and answered the same way as memcached ones
+                try {
+                    if (resp) {
+                        resp_parser.ParseBatch(client_buffer, readed_bytes, requests);
+                        readed_bytes = read_body(client_socket, resp_parser, sizeof(client_buffer), requests);
                     } else {
-                        std::memmove(client_buffer, client_buffer + parsed, readed_bytes - parsed);
-                        readed_bytes -= parsed;
+                        parser.ParseBatch(client_buffer, readed_bytes, requests);
+                        readed_bytes = read_body(client_socket, parser, sizeof(client_buffer), requests);
                     }
+                } catch (std::runtime_error &ex) {
+                    parse_error = ex.what();
                 }
-
-                // There is command, but we still wait for argument to arrive...
-                if (command_to_execute && arg_remains > 0) {
-                    _logger->debug("Fill argument: {} bytes of {}", readed_bytes, arg_remains);
-                    // There is some parsed command, and now we are reading argument
-                    std::size_t to_read = std::min(arg_remains, std::size_t(readed_bytes));
-                    argument_for_command.append(client_buffer, to_read);
-
-                    std::memmove(client_buffer, client_buffer + to_read, readed_bytes - to_read);
-                    arg_remains -= to_read;
-                    readed_bytes -= to_read;
+                stamp_requests(requests, 0);
+                timer.Parsed();
+                _logger->debug("Found {} new commands", requests.size());
+
+                // Whole batch is sent with a single writev: text is copied into the connection buffer,
+                // values are sent right from the storage chunks. Quiet and noreply commands produce no bytes at all
+                execute_requests(*dispatcher, *pStorage, requests, result, timer, resp, request_timeout);
+                requests.clear();
+                if (!parse_error.empty()) {
+                    append_parse_error(result, resp, parse_error);
                 }
+            }
 
-                // Thre is command & argument - RUN!
-                if (command_to_execute && arg_remains == 0) {
-                    _logger->debug("Start command execution");
-
-                    std::string result;
-                    if (argument_for_command.size()) {
-                        argument_for_command.resize(argument_for_command.size() - 2);
-                    }
-                    command_to_execute->Execute(*pStorage, argument_for_command, result);
+            if (!result.Empty()) {
+                send_output(client_socket, result);
+                timer.Written();
+                result.Clear();
+            }
+            timer.Finished();
 
-                    // Send response
-                    result += "\r\n";
-                    if (send(client_socket, result.data(), result.size(), 0) <= 0) {
-                        throw std::runtime_error("Failed to send response");
-                    }
+            if (!parse_error.empty()) {
+                throw std::runtime_error(parse_error);
+            }
 
-                    // Prepare for the next command
-                    command_to_execute.reset();
-                    argument_for_command.resize(0);
-                    parser.Reset();
-                }
-            } // while (readed_bytes)
+            // Connection failed while reading data block
+            if (readed_bytes <= 0) {
+                break;
+            }
         }
 
         if (readed_bytes == 0) {
@@ -194,6 +214,7 @@ void ServerImpl::RunThread(const int client_socket)
 
     // We are done with this connection
     close(client_socket);
+    Execute::Counters::Add(Execute::Counters::kConnectionsClosed);
 
     {
         std::unique_lock<std::mutex> _ul_ms(_mutex_set);
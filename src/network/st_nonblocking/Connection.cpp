@@ -1,25 +1,238 @@
 #include "Connection.h"
 
-#include <iostream>
+#include <cerrno>
+#include <stdexcept>
+#include <string>
+#include <utility>
+
+#include <unistd.h>
+
+#include <spdlog/logger.h>
+
+#include <afina/Storage.h>
+#include <afina/concurrency/Executor.h>
+#include <afina/execute/Command.h>
+#include <afina/execute/Dispatcher.h>
+
+#include "network/Utils.h"
 
 namespace Afina {
 namespace Network {
 namespace STnonblock {
 
+const std::size_t Connection::kMaxQueued;
+
+// See Connection.h
+Connection::Connection(int s, std::shared_ptr<Afina::Storage> storage,
+                       std::shared_ptr<Execute::Dispatcher> dispatcher, std::shared_ptr<spdlog::logger> logger,
+                       bool resp, uint64_t timeout, Concurrency::Executor *executor,
+                       CompletionQueue<Connection> *completions)
+    : _socket(s), _storage(std::move(storage)), _dispatcher(std::move(dispatcher)), _logger(std::move(logger)),
+      _resp(resp), _timeout(timeout), _executor(executor), _completions(completions), _alive(true), _eof(false),
+      _busy(false), _failed(false), _started(false), _binary(false), _sent(0), _timer("st_nonblocking") {
+    std::memset(&_event, 0, sizeof(struct epoll_event));
+    _event.data.ptr = this;
+}
+
+// See Connection.h
+void Connection::Start() {
+    _logger->debug("Start connection on descriptor {}", _socket);
+    _event.events = EPOLLIN;
+}
+
+// See Connection.h
+void Connection::OnError() {
+    _logger->debug("Connection on descriptor {} failed", _socket);
+    _alive = false;
+}
+
+// See Connection.h
+void Connection::OnClose() { _logger->debug("Connection on descriptor {} closed", _socket); }
+
 // See Connection.h
-void Connection::Start() { std::cout << "Start" << std::endl; }
+void Connection::DoRead() {
+    try {
+        // Socket is read out, unless too many requests wait already
+        char buffer[4096];
+        while (Queued() < kMaxQueued) {
+            ssize_t readed_bytes = read(_socket, buffer, sizeof(buffer));
+            if (readed_bytes > 0) {
+                _logger->debug("Got {} bytes from socket", readed_bytes);
+
+                // Protocol is picked by the first byte of the connection, binary packets always start with 0x80
+                if (!_started && !_resp) {
+                    _binary = (static_cast<uint8_t>(buffer[0]) == Protocol::BinaryParser::kRequestMagic);
+                    _started = true;
+                }
+
+                std::size_t from = Queued();
+                try {
+                    if (_binary) {
+                        _binary_parser.ParseBatch(buffer, readed_bytes, _binary_requests);
+                    } else if (_resp) {
+                        _resp_parser.ParseBatch(buffer, readed_bytes, _requests);
+                    } else {
+                        _parser.ParseBatch(buffer, readed_bytes, _requests);
+                    }
+                } catch (std::runtime_error &ex) {
+                    // Requests parsed before the malformed one are still answered, nothing is read after it.
+                    // Binary protocol has no error for a broken stream, connection is just closed
+                    _logger->error("Failed to parse input on descriptor {}: {}", _socket, ex.what());
+                    if (!_binary) {
+                        _parse_error = ex.what();
+                    }
+                    _eof = true;
+                }
+                if (_binary) {
+                    stamp_requests(_binary_requests, from);
+                } else {
+                    stamp_requests(_requests, from);
+                }
+                if (_eof) {
+                    break;
+                }
+            } else if (readed_bytes == 0) {
+                _eof = true;
+                break;
+            } else if (errno == EAGAIN || errno == EWOULDBLOCK) {
+                break;
+            } else if (errno != EINTR) {
+                throw std::runtime_error(std::string(strerror(errno)));
+            }
+        }
+        Process();
+    } catch (std::runtime_error &ex) {
+        _logger->error("Failed to process connection on descriptor {}: {}", _socket, ex.what());
+        OnError();
+    }
+}
 
 // See Connection.h
-void Connection::OnError() { std::cout << "OnError" << std::endl; }
+void Connection::DoWrite() {
+    if (_busy || _output.Empty()) {
+        UpdateEvents();
+        return;
+    }
+
+    try {
+        if (!write_output(_socket, _output, _sent)) {
+            UpdateEvents();
+            return;
+        }
+    } catch (std::runtime_error &ex) {
+        _logger->error("Failed to process connection on descriptor {}: {}", _socket, ex.what());
+        OnError();
+        return;
+    }
+
+    _timer.Written();
+    _timer.Finished();
+    _output.Clear();
+    _sent = 0;
+    Process();
+}
 
 // See Connection.h
-void Connection::OnClose() { std::cout << "OnClose" << std::endl; }
+void Connection::OnExecuted() {
+    _busy = false;
+    if (_alive) {
+        Complete();
+    }
+}
 
 // See Connection.h
-void Connection::DoRead() { std::cout << "DoRead" << std::endl; }
+void Connection::Process() {
+    if (_busy || !_output.Empty()) {
+        UpdateEvents();
+        return;
+    }
+    if (Queued() == 0) {
+        if (_parse_error.empty()) {
+            UpdateEvents();
+        } else {
+            // Every request before the malformed one is answered, connection is closed once error is sent
+            append_parse_error(_output, _resp, _parse_error);
+            _parse_error.clear();
+            DoWrite();
+        }
+        return;
+    }
+
+    // Requests parsed so far make up the batch, the following ones wait for it to be done
+    if (_binary) {
+        std::swap(_binary_batch, _binary_requests);
+    } else {
+        std::swap(_batch, _requests);
+    }
+    _timer.Parsed();
+
+    if (_executor == nullptr) {
+        RunBatch();
+        Complete();
+        return;
+    }
+
+    _busy = _executor->Execute([this]() {
+        RunBatch();
+        _completions->Push(this);
+    });
+    if (!_busy) {
+        // Executor is stopped, so is the server
+        OnError();
+        return;
+    }
+    UpdateEvents();
+}
 
 // See Connection.h
-void Connection::DoWrite() { std::cout << "DoWrite" << std::endl; }
+void Connection::RunBatch() {
+    try {
+        if (_binary) {
+            execute_binary_requests(*_dispatcher, *_storage, _binary_batch, _output, _timer, _timeout);
+        } else {
+            execute_requests(*_dispatcher, *_storage, _batch, _output, _timer, _resp, _timeout);
+        }
+    } catch (std::exception &) {
+        _failed = true;
+    }
+}
+
+// See Connection.h
+void Connection::Complete() {
+    _batch.clear();
+    _binary_batch.clear();
+    if (_failed) {
+        _logger->error("Failed to execute commands on descriptor {}", _socket);
+        OnError();
+        return;
+    }
+
+    if (_output.Empty()) {
+        // Nothing to write for noreply and quiet commands
+        _timer.Finished();
+        Process();
+    } else {
+        DoWrite();
+    }
+}
+
+// See Connection.h
+void Connection::UpdateEvents() {
+    // Output belongs to the executor while connection is busy
+    bool writing = !_busy && !_output.Empty();
+    if (_eof && !_busy && !writing && Queued() == 0) {
+        _alive = false;
+        return;
+    }
+
+    _event.events = 0;
+    if (!_eof && Queued() < kMaxQueued) {
+        _event.events |= EPOLLIN;
+    }
+    if (writing) {
+        _event.events |= EPOLLOUT;
+    }
+}
 
 } // namespace STnonblock
 } // namespace Network
@@ -2,21 +2,60 @@
 #define AFINA_NETWORK_ST_NONBLOCKING_CONNECTION_H
 
 #include <cstring>
+#include <memory>
+#include <string>
+#include <vector>
 
 #include <sys/epoll.h>
 
+#include <afina/execute/OutputSink.h>
+
+#include "network/CompletionQueue.h"
+#include "network/RequestTimer.h"
+#include "protocol/BinaryParser.h"
+#include "protocol/Parser.h"
+#include "protocol/RespParser.h"
+
+namespace spdlog {
+class logger;
+}
+
 namespace Afina {
+class Storage;
+
+namespace Concurrency {
+class Executor;
+}
+
+namespace Execute {
+class Dispatcher;
+}
+
 namespace Network {
 namespace STnonblock {
 
+/**
+ * # Client connection of the epoll server
+ * Connection reads and parses whatever socket has, then runs parsed requests as a batch and writes responses
+ * out. Requests parsed while previous batch is executed or its responses are written wait for the next one,
+ * so responses always go in the order requests came. Speaks memcached text protocol or Redis one, memcached
+ * binary protocol is picked by the first byte of the connection the way blocking servers do it.
+ *
+ * Batch is executed right on the network thread, unless executor is given: then batch runs on the executor
+ * and network thread serves other connections meanwhile, see OnExecuted. Connection has at most one batch
+ * on the executor, that keeps its requests in order. Requests are still destroyed on the network thread only,
+ * as parser pools commands without any locks
+ */
 class Connection {
 public:
-    Connection(int s) : _socket(s) {
-        std::memset(&_event, 0, sizeof(struct epoll_event));
-        _event.data.ptr = this;
-    }
+    // Connection stops reading once that many requests wait for execution
+    static const std::size_t kMaxQueued = 4096;
 
-    inline bool isAlive() const { return true; }
+    Connection(int s, std::shared_ptr<Afina::Storage> storage, std::shared_ptr<Execute::Dispatcher> dispatcher,
+               std::shared_ptr<spdlog::logger> logger, bool resp, uint64_t timeout, Concurrency::Executor *executor,
+               CompletionQueue<Connection> *completions);
+
+    inline bool isAlive() const { return _alive; }
 
     void Start();
 
@@ -26,11 +65,76 @@ protected:
     void DoRead();
     void DoWrite();
 
+    /**
+     * Batch handed to the executor is done, network thread only
+     */
+    void OnExecuted();
+
 private:
     friend class ServerImpl;
 
+    // Starts the next batch if connection isn't busy with the previous one
+    void Process();
+
+    // Runs batch writing responses to the output, the only method that might run off the network thread
+    void RunBatch();
+
+    // Batch is done: its requests are dropped and responses go out
+    void Complete();
+
+    // Picks events to wait for by connection state
+    void UpdateEvents();
+
+    // Number of requests waiting for the next batch
+    std::size_t Queued() const { return _binary ? _binary_requests.size() : _requests.size(); }
+
     int _socket;
     struct epoll_event _event;
+
+    std::shared_ptr<Afina::Storage> _storage;
+    std::shared_ptr<Execute::Dispatcher> _dispatcher;
+    std::shared_ptr<spdlog::logger> _logger;
+    const bool _resp;
+
+    // Requests waited longer than that in nanoseconds are not executed, see execute_requests
+    const uint64_t _timeout;
+
+    Concurrency::Executor *_executor;
+    CompletionQueue<Connection> *_completions;
+
+    // - alive: false once connection must be closed
+    // - eof: client has nothing more to send, connection is closed once all responses are written
+    // - busy: batch is on the executor, nothing but the flags above could be touched until it is done
+    // - failed: batch execution threw, set by the executor
+    // - started: first byte is read, so protocol is known
+    // - binary: connection speaks memcached binary protocol
+    bool _alive;
+    bool _eof;
+    bool _busy;
+    bool _failed;
+    bool _started;
+    bool _binary;
+
+    Protocol::Parser _parser;
+    Protocol::RespParser _resp_parser;
+
+    // Input can't be parsed past this error, it is answered after the requests parsed before
+    std::string _parse_error;
+
+    // Requests waiting for the next batch and requests of the batch being executed
+    std::vector<Protocol::Parser::Request> _requests;
+    std::vector<Protocol::Parser::Request> _batch;
+
+    // The same for connections speaking binary protocol
+    Protocol::BinaryParser _binary_parser;
+    std::vector<Protocol::BinaryParser::Request> _binary_requests;
+    std::vector<Protocol::BinaryParser::Request> _binary_batch;
+
+    // Responses of the batch and number of bytes of them already sent
+    Execute::OutputSink _output;
+    std::size_t _sent;
+
+    RequestTimer _timer;
 };
 
 } // namespace STnonblock
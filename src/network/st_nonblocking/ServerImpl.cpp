@@ -19,6 +19,8 @@
 #include <spdlog/logger.h>
 
 #include <afina/Storage.h>
+#include <afina/concurrency/Executor.h>
+#include <afina/execute/Counters.h>
 #include <afina/logging/Service.h>
 
 #include "Connection.h"
@@ -80,6 +82,11 @@ void ServerImpl::Start(uint16_t port, uint32_t n_acceptors, uint32_t n_workers)
         throw std::runtime_error("Failed to create epoll file descriptor: " + std::string(strerror(errno)));
     }
 
+    if (executor_threads > 0) {
+        _executor.reset(new Concurrency::Executor("executor", executor_threads));
+        _completions.reset(new CompletionQueue<Connection>());
+    }
+
     _work_thread = std::thread(&ServerImpl::OnRun, this);
 }
 
@@ -121,6 +128,15 @@ void ServerImpl::OnRun() {
         throw std::runtime_error("Failed to add file descriptor to epoll");
     }
 
+    if (_completions) {
+        struct epoll_event event3;
+        event3.events = EPOLLIN;
+        event3.data.fd = _completions->Descriptor();
+        if (epoll_ctl(epoll_descr, EPOLL_CTL_ADD, _completions->Descriptor(), &event3)) {
+            throw std::runtime_error("Failed to add file descriptor to epoll");
+        }
+    }
+
     bool run = true;
     std::array<struct epoll_event, 64> mod_list;
     while (run) {
@@ -136,48 +152,60 @@ void ServerImpl::OnRun() {
             } else if (current_event.data.fd == _server_socket) {
                 OnNewConnection(epoll_descr);
                 continue;
+            } else if (_completions && current_event.data.fd == _completions->Descriptor()) {
+                OnExecuted(epoll_descr);
+                continue;
             }
 
             // That is some connection!
             Connection *pc = static_cast<Connection *>(current_event.data.ptr);
+            if (pc->_socket == -1) {
+                // Closed by one of the previous events
+                continue;
+            }
 
             auto old_mask = pc->_event.events;
             if ((current_event.events & EPOLLERR) || (current_event.events & EPOLLHUP)) {
                 pc->OnError();
-            } else if (current_event.events & EPOLLRDHUP) {
-                pc->OnClose();
             } else {
                 // Depends on what connection wants...
                 if (current_event.events & EPOLLIN) {
                     pc->DoRead();
                 }
-                if (current_event.events & EPOLLOUT) {
+                if (pc->isAlive() && (current_event.events & EPOLLOUT)) {
                     pc->DoWrite();
                 }
             }
+            Update(epoll_descr, pc, old_mask);
+        }
 
-            // Does it alive?
-            if (!pc->isAlive()) {
-                if (epoll_ctl(epoll_descr, EPOLL_CTL_DEL, pc->_socket, &pc->_event)) {
-                    _logger->error("Failed to delete connection from epoll");
-                }
-
-                close(pc->_socket);
-                pc->OnClose();
-
-                delete pc;
-            } else if (pc->_event.events != old_mask) {
-                if (epoll_ctl(epoll_descr, EPOLL_CTL_MOD, pc->_socket, &pc->_event)) {
-                    _logger->error("Failed to change connection event mask");
-
-                    close(pc->_socket);
-                    pc->OnClose();
+        // Events above might still refer closed connections, so they are deleted only now
+        for (auto pc : _closed) {
+            delete pc;
+        }
+        _closed.clear();
+    }
 
-                    delete pc;
-                }
-            }
+    // Batches on the executor are let to finish, their responses are dropped along with connections
+    if (_executor) {
+        _executor->Stop(true);
+    }
+    for (auto pc : _connections) {
+        if (pc->_socket != -1) {
+            close(pc->_socket);
+            pc->OnClose();
+            Execute::Counters::Add(Execute::Counters::kConnectionsClosed);
         }
+        delete pc;
     }
+    _connections.clear();
+    for (auto pc : _closed) {
+        delete pc;
+    }
+    _closed.clear();
+    close(epoll_descr);
+    close(_server_socket);
+    close(_event_fd);
     _logger->warn("Acceptor stopped");
 }
 
@@ -207,19 +235,66 @@ void ServerImpl::OnNewConnection(int epoll_descr) {
         }
 
         // Register the new FD to be monitored by epoll.
-        Connection *pc = new(std::nothrow) Connection(infd);
+        Connection *pc = new (std::nothrow) Connection(infd, pStorage, dispatcher, _logger, frontend == Frontend::Resp,
+                                                       request_timeout, _executor.get(), _completions.get());
         if (pc == nullptr) {
             throw std::runtime_error("Failed to allocate connection");
         }
+        Execute::Counters::Add(Execute::Counters::kConnectionsOpened);
 
         // Register connection in worker's epoll
+        _connections.insert(pc);
         pc->Start();
         if (pc->isAlive()) {
             if (epoll_ctl(epoll_descr, EPOLL_CTL_ADD, pc->_socket, &pc->_event)) {
                 pc->OnError();
-                delete pc;
             }
         }
+        if (!pc->isAlive()) {
+            Close(epoll_descr, pc);
+        }
+    }
+}
+
+// See ServerImpl.h
+void ServerImpl::OnExecuted(int epoll_descr) {
+    std::vector<Connection *> done;
+    _completions->Pop(done);
+    for (auto pc : done) {
+        auto old_mask = pc->_event.events;
+        pc->OnExecuted();
+        Update(epoll_descr, pc, old_mask);
+    }
+}
+
+// See ServerImpl.h
+void ServerImpl::Update(int epoll_descr, Connection *pc, uint32_t old_mask) {
+    // Does it alive?
+    if (!pc->isAlive()) {
+        Close(epoll_descr, pc);
+    } else if (pc->_event.events != old_mask) {
+        if (epoll_ctl(epoll_descr, EPOLL_CTL_MOD, pc->_socket, &pc->_event)) {
+            _logger->error("Failed to change connection event mask");
+            pc->OnError();
+            Close(epoll_descr, pc);
+        }
+    }
+}
+
+// See ServerImpl.h
+void ServerImpl::Close(int epoll_descr, Connection *pc) {
+    if (pc->_socket != -1) {
+        // Connection might be not in epoll yet, error is fine then
+        epoll_ctl(epoll_descr, EPOLL_CTL_DEL, pc->_socket, &pc->_event);
+        close(pc->_socket);
+        pc->OnClose();
+        pc->_socket = -1;
+        Execute::Counters::Add(Execute::Counters::kConnectionsClosed);
+    }
+
+    // Batch on the executor still refers the connection, it is deleted once batch is done, see OnExecuted
+    if (!pc->_busy && _connections.erase(pc) != 0) {
+        _closed.push_back(pc);
     }
 }
 
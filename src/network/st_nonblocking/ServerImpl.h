@@ -1,25 +1,34 @@
 #ifndef AFINA_NETWORK_ST_NONBLOCKING_SERVER_H
 #define AFINA_NETWORK_ST_NONBLOCKING_SERVER_H
 
+#include <memory>
+#include <set>
 #include <thread>
 #include <vector>
 
 #include <afina/network/Server.h>
 
+#include "network/CompletionQueue.h"
+
 namespace spdlog {
 class logger;
 }
 
 namespace Afina {
+namespace Concurrency {
+class Executor;
+}
+
 namespace Network {
 namespace STnonblock {
 
-// Forward declaration, see Worker.h
-class Worker;
+// Forward declaration, see Connection.h
+class Connection;
 
 /**
  * # Network resource manager implementation
- * Epoll based server
+ * Epoll based server. Commands are executed on the network thread or, if executor threads are set, on the
+ * executor, see Connection
  */
 class ServerImpl : public Server {
 public:
@@ -39,6 +48,15 @@ protected:
     void OnRun();
     void OnNewConnection(int);
 
+    // Takes connections whose batches are done on the executor
+    void OnExecuted(int epoll_descr);
+
+    // Closes dead connection or updates its event mask
+    void Update(int epoll_descr, Connection *pc, uint32_t old_mask);
+
+    // Closes connection socket, connection itself is deleted later unless executor still runs its batch
+    void Close(int epoll_descr, Connection *pc);
+
 private:
     // logger to use
     std::shared_ptr<spdlog::logger> _logger;
@@ -56,6 +74,14 @@ private:
 
     // IO thread
     std::thread _work_thread;
+
+    // Threads to execute commands on, if any, and batches they are done with
+    std::unique_ptr<Concurrency::Executor> _executor;
+    std::unique_ptr<CompletionQueue<Connection>> _completions;
+
+    // Connections alive and connections closed while processing current events, IO thread only
+    std::set<Connection *> _connections;
+    std::vector<Connection *> _closed;
 };
 
 } // namespace STnonblock
@@ -0,0 +1,359 @@
+#include "BinaryParser.h"
+
+#include <algorithm>
+#include <cstring>
+#include <stdexcept>
+#include <utility>
+
+#include <afina/Storage.h>
+#include <afina/execute/Add.h>
+#include <afina/execute/Append.h>
+#include <afina/execute/Delete.h>
+#include <afina/execute/Dispatcher.h>
+#include <afina/execute/Get.h>
+#include <afina/execute/Prepend.h>
+#include <afina/execute/Replace.h>
+#include <afina/execute/Set.h>
+
+namespace Afina {
+namespace Protocol {
+
+const uint8_t BinaryParser::kRequestMagic;
+const uint8_t BinaryParser::kResponseMagic;
+const std::size_t BinaryParser::kHeaderSize;
+
+namespace {
+
+// Packets larger than that are treated as a garbage rather than allocating for them
+const uint32_t kMaxBodySize = 64 * 1024 * 1024;
+
+uint16_t read16(const char *p) {
+    const unsigned char *u = reinterpret_cast<const unsigned char *>(p);
+    return uint16_t((u[0] << 8) | u[1]);
+}
+
+uint32_t read32(const char *p) {
+    const unsigned char *u = reinterpret_cast<const unsigned char *>(p);
+    return (uint32_t(u[0]) << 24) | (uint32_t(u[1]) << 16) | (uint32_t(u[2]) << 8) | uint32_t(u[3]);
+}
+
+void put16(char *p, uint16_t v) {
+    p[0] = char(v >> 8);
+    p[1] = char(v);
+}
+
+void put32(char *p, uint32_t v) {
+    put16(p, uint16_t(v >> 16));
+    put16(p + 2, uint16_t(v));
+}
+
+// Header layout: magic, opcode, key length, extras length, data type, status (vbucket in request),
+// total body length, opaque, cas. Body length is checked as soon as header is there, before anything of the
+// body is collected
+uint32_t body_length(const char *header) {
+    uint32_t size = read32(header + 8);
+    if (size > kMaxBodySize) {
+        throw std::runtime_error("Binary protocol packet is too large");
+    }
+    return size;
+}
+
+// Writes header, extras and key of the response, value of the given size must follow
+void write_head(Execute::OutputSink &out, uint8_t opcode, BinaryParser::Status status, uint32_t opaque,
+                const char *extras, std::size_t extras_size, const std::string &key, std::size_t value_size) {
+    char header[BinaryParser::kHeaderSize];
+    header[0] = char(BinaryParser::kResponseMagic);
+    header[1] = char(opcode);
+    put16(header + 2, uint16_t(key.size()));
+    header[4] = char(extras_size);
+    header[5] = 0;
+    put16(header + 6, status);
+    put32(header + 8, uint32_t(extras_size + key.size() + value_size));
+    put32(header + 12, opaque);
+    put32(header + 16, 0);
+    put32(header + 20, 0);
+    out.Append(header, sizeof(header));
+    out.Append(extras, extras_size);
+    out.Append(key);
+}
+
+void write_response(Execute::OutputSink &out, uint8_t opcode, BinaryParser::Status status, uint32_t opaque,
+                    const char *value) {
+    std::size_t value_size = std::strlen(value);
+    write_head(out, opcode, status, opaque, nullptr, 0, std::string(), value_size);
+    out.Append(value, value_size);
+}
+
+bool is_get(BinaryParser::Opcode opcode) {
+    return opcode == BinaryParser::opGet || opcode == BinaryParser::opGetQ || opcode == BinaryParser::opGetK ||
+           opcode == BinaryParser::opGetKQ;
+}
+
+void write_error(Execute::OutputSink &out, uint8_t opcode, BinaryParser::Status status, uint32_t opaque) {
+    const char *message = "Error";
+    switch (status) {
+    case BinaryParser::stKeyNotFound:
+        message = "Not found";
+        break;
+    case BinaryParser::stKeyExists:
+        message = "Data exists for key.";
+        break;
+    case BinaryParser::stInvalidArguments:
+        message = "Invalid arguments";
+        break;
+    case BinaryParser::stItemNotStored:
+        message = "Not stored.";
+        break;
+    case BinaryParser::stUnknownCommand:
+        message = "Unknown command";
+        break;
+    case BinaryParser::stTemporaryFailure:
+        message = "Temporary failure";
+        break;
+    default:
+        break;
+    }
+    write_response(out, opcode, status, opaque, message);
+}
+
+} // namespace
+
+// See BinaryParser.h
+std::size_t BinaryParser::ParseBatch(const char *input, const size_t size, std::vector<Request> &requests) {
+    std::size_t pos = 0;
+    while (pos < size) {
+        if (static_cast<uint8_t>(partial.empty() ? input[pos] : partial[0]) != kRequestMagic) {
+            throw std::runtime_error("Invalid magic byte of binary protocol packet");
+        }
+
+        // Whole packet is in the input, no need to copy it
+        if (partial.empty() && size - pos >= kHeaderSize) {
+            std::size_t total = kHeaderSize + body_length(input + pos);
+            if (size - pos >= total) {
+                Decode(input + pos, requests);
+                pos += total;
+                continue;
+            }
+        }
+
+        // Packet spans several reads, collect it. Body size is checked by Missing once header is complete
+        std::size_t to_read = std::min(Missing(), size - pos);
+        partial.append(input + pos, to_read);
+        pos += to_read;
+        if (Missing() == 0) {
+            Decode(partial.data(), requests);
+            partial.clear();
+        }
+    }
+    return pos;
+}
+
+// See BinaryParser.h
+std::size_t BinaryParser::Missing() const {
+    if (partial.size() < kHeaderSize) {
+        return kHeaderSize - partial.size();
+    }
+    return kHeaderSize + body_length(partial.data()) - partial.size();
+}
+
+// See BinaryParser.h
+void BinaryParser::Decode(const char *packet, std::vector<Request> &requests) const {
+    uint16_t key_size = read16(packet + 2);
+    uint8_t extras_size = static_cast<uint8_t>(packet[4]);
+    uint32_t body_size = body_length(packet);
+
+    Request request;
+    request.opcode = static_cast<Opcode>(packet[1]);
+    request.opaque = read32(packet + 12);
+    request.status = stSuccess;
+    request.received = 0;
+    if (std::size_t(key_size) + extras_size > body_size) {
+        request.status = stInvalidArguments;
+        requests.push_back(std::move(request));
+        return;
+    }
+
+    const char *extras = packet + kHeaderSize;
+    request.key.assign(extras + extras_size, key_size);
+    const char *value = extras + extras_size + key_size;
+    std::size_t value_size = body_size - extras_size - key_size;
+
+    switch (request.opcode) {
+    case opGet:
+    case opGetQ:
+    case opGetK:
+    case opGetKQ: {
+        if (key_size == 0 || extras_size != 0 || value_size != 0) {
+            request.status = stInvalidArguments;
+            break;
+        }
+        request.command.reset(new Execute::Get(std::vector<std::string>(1, request.key)));
+        break;
+    }
+
+    case opSet:
+    case opSetQ:
+    case opAdd:
+    case opAddQ:
+    case opReplace:
+    case opReplaceQ: {
+        // Extras are 4 bytes of flags and 4 bytes of expiration time
+        if (key_size == 0 || extras_size != 8) {
+            request.status = stInvalidArguments;
+            break;
+        }
+        uint32_t flags = read32(extras);
+        int32_t expire = static_cast<int32_t>(read32(extras + 4));
+        if (request.opcode == opSet || request.opcode == opSetQ) {
+            request.command.reset(new Execute::Set(request.key, flags, expire));
+        } else if (request.opcode == opAdd || request.opcode == opAddQ) {
+            request.command.reset(new Execute::Add(request.key, flags, expire));
+        } else {
+            request.command.reset(new Execute::Replace(request.key, flags, expire));
+        }
+        request.argument.assign(value, value_size);
+        break;
+    }
+
+    case opAppend:
+    case opAppendQ:
+    case opPrepend:
+    case opPrependQ: {
+        if (key_size == 0 || extras_size != 0) {
+            request.status = stInvalidArguments;
+            break;
+        }
+        if (request.opcode == opAppend || request.opcode == opAppendQ) {
+            request.command.reset(new Execute::Append(request.key, 0, 0));
+        } else {
+            request.command.reset(new Execute::Prepend(request.key, 0, 0));
+        }
+        request.argument.assign(value, value_size);
+        break;
+    }
+
+    case opDelete:
+    case opDeleteQ: {
+        if (key_size == 0 || extras_size != 0 || value_size != 0) {
+            request.status = stInvalidArguments;
+            break;
+        }
+        request.command.reset(new Execute::Delete(request.key));
+        break;
+    }
+
+    case opNoop:
+        break;
+
+    default:
+        request.status = stUnknownCommand;
+        break;
+    }
+    requests.push_back(std::move(request));
+}
+
+// See BinaryParser.h
+void BinaryParser::Execute(Execute::Dispatcher &dispatcher, Storage &storage, Request &request,
+                           Execute::OutputSink &out) {
+    if (request.status == stSuccess && is_get(request.opcode)) {
+        // Value is never parsed back out of the text response: key could hold any bytes. Chunks are fetched
+        // right into the sink and referenced by the response
+        std::size_t from = out.Values().size();
+        bool found =
+            dispatcher.ExecuteValue(storage, static_cast<Execute::Get &>(*request.command), out.Values());
+        EncodeValue(request, found, from, out);
+        return;
+    }
+
+    // Short text result is taken back out of the sink and replaced with the binary status
+    std::string text;
+    if (request.status == stSuccess && request.command) {
+        Execute::OutputSink::Mark before = out.Position();
+        dispatcher.ExecuteTo(storage, *request.command, std::move(request.argument), out);
+        out.CopyTo(before, text);
+        out.Truncate(before);
+    }
+    Encode(request, text, out);
+}
+
+// See BinaryParser.h
+void BinaryParser::EncodeValue(const Request &request, bool found, std::size_t from, Execute::OutputSink &out) {
+    if (request.status != stSuccess) {
+        write_error(out, request.opcode, request.status, request.opaque);
+        return;
+    }
+
+    bool quiet = (request.opcode == opGetQ || request.opcode == opGetKQ);
+    bool with_key = (request.opcode == opGetK || request.opcode == opGetKQ);
+    if (!found) {
+        if (!quiet) {
+            write_error(out, request.opcode, stKeyNotFound, request.opaque);
+        }
+        return;
+    }
+
+    const std::vector<ValueChunk> &value = out.Values();
+    std::size_t size = 0;
+    for (std::size_t i = from; i < value.size(); i++) {
+        size += value[i]->size();
+    }
+
+    // Storage keeps no flags, they are always 0 the way text get reports them
+    const char extras[4] = {0, 0, 0, 0};
+    write_head(out, request.opcode, stSuccess, request.opaque, extras, sizeof(extras),
+               with_key ? request.key : std::string(), size);
+    out.Reference(from);
+}
+
+// See BinaryParser.h
+void BinaryParser::Encode(const Request &request, const std::string &result, Execute::OutputSink &out) {
+    if (request.status != stSuccess) {
+        write_error(out, request.opcode, request.status, request.opaque);
+        return;
+    }
+
+    switch (request.opcode) {
+    case opSet:
+    case opSetQ:
+    case opAdd:
+    case opAddQ:
+    case opReplace:
+    case opReplaceQ:
+    case opAppend:
+    case opAppendQ:
+    case opPrepend:
+    case opPrependQ: {
+        if (result == "STORED") {
+            bool quiet = (request.opcode == opSetQ || request.opcode == opAddQ || request.opcode == opReplaceQ ||
+                          request.opcode == opAppendQ || request.opcode == opPrependQ);
+            if (!quiet) {
+                write_response(out, request.opcode, stSuccess, request.opaque, "");
+            }
+        } else if (request.opcode == opAdd || request.opcode == opAddQ) {
+            write_error(out, request.opcode, stKeyExists, request.opaque);
+        } else if (request.opcode == opReplace || request.opcode == opReplaceQ) {
+            write_error(out, request.opcode, stKeyNotFound, request.opaque);
+        } else {
+            write_error(out, request.opcode, stItemNotStored, request.opaque);
+        }
+        return;
+    }
+
+    case opDelete:
+    case opDeleteQ: {
+        if (result != "DELETED") {
+            write_error(out, request.opcode, stKeyNotFound, request.opaque);
+        } else if (request.opcode == opDelete) {
+            write_response(out, request.opcode, stSuccess, request.opaque, "");
+        }
+        return;
+    }
+
+    default:
+        write_response(out, request.opcode, stSuccess, request.opaque, "");
+        return;
+    }
+}
+
+} // namespace Protocol
+} // namespace Afina
@@ -0,0 +1,143 @@
+#ifndef AFINA_PROTOCOL_BINARY_PARSER_H
+#define AFINA_PROTOCOL_BINARY_PARSER_H
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include <cstddef>
+#include <cstdint>
+
+#include <afina/execute/Command.h>
+#include <afina/execute/OutputSink.h>
+
+namespace Afina {
+class Storage;
+
+namespace Execute {
+class Dispatcher;
+}
+
+namespace Protocol {
+
+/**
+ * # Memcached binary protocol parser
+ * Parser supports subset of memcached binary protocol: get, set, add, replace, append, prepend, delete (all
+ * with quiet and key-returning variants where protocol has them) and noop. Each packet is turned into the same Execute
+ * command text protocol builds and runs through the same dispatcher. Value of the get is referenced right in the
+ * storage chunks by the binary response, short text result of the other commands is encoded back into the binary
+ * status.
+ *
+ * Every packet starts with 0x80 magic byte, that is never a first byte of text command, so server could pick
+ * parser by the first byte of the connection.
+ */
+class BinaryParser {
+public:
+    static const uint8_t kRequestMagic = 0x80;
+    static const uint8_t kResponseMagic = 0x81;
+    static const std::size_t kHeaderSize = 24;
+
+    enum Opcode : uint8_t {
+        opGet = 0x00,
+        opSet = 0x01,
+        opAdd = 0x02,
+        opReplace = 0x03,
+        opDelete = 0x04,
+        opGetQ = 0x09,
+        opNoop = 0x0a,
+        opGetK = 0x0c,
+        opGetKQ = 0x0d,
+        opAppend = 0x0e,
+        opPrepend = 0x0f,
+        opSetQ = 0x11,
+        opAddQ = 0x12,
+        opReplaceQ = 0x13,
+        opDeleteQ = 0x14,
+        opAppendQ = 0x19,
+        opPrependQ = 0x1a
+    };
+
+    enum Status : uint16_t {
+        stSuccess = 0x0000,
+        stKeyNotFound = 0x0001,
+        stKeyExists = 0x0002,
+        stInvalidArguments = 0x0004,
+        stItemNotStored = 0x0005,
+        stUnknownCommand = 0x0081,
+        stTemporaryFailure = 0x0086
+    };
+
+    /**
+     * Packet parsed out of the stream
+     */
+    struct Request {
+        Opcode opcode;
+        uint32_t opaque;
+        std::string key;
+
+        // Command to run, null for noop and for packets server can't execute
+        std::unique_ptr<Execute::Command> command;
+
+        // Value of the storage commands
+        std::string argument;
+
+        // Response status if packet is rejected without execution
+        Status status;
+
+        // Time request was read at, see RequestTimer::Now. Requests are never expired if it is 0
+        uint64_t received;
+    };
+
+    BinaryParser() { Reset(); }
+
+    /**
+     * Parses out every complete packet from the given buffer in a single pass and appends them to requests.
+     * Incomplete packet at the end of the buffer is kept inside of the parser and will be finished by
+     * following calls. Throws runtime_error if stream is not a binary protocol
+     *
+     * @param input buffer to be parsed
+     * @param size number of bytes in the input buffer that could be read
+     * @param requests output parameter, complete requests are appended there
+     * @return number of bytes consumed from the input
+     */
+    std::size_t ParseBatch(const char *input, const size_t size, std::vector<Request> &requests);
+
+    /**
+     * Executes request through the dispatcher and appends its response packet to out, see Encode and
+     * EncodeValue. Request rejected with an error status is answered without touching the storage
+     */
+    static void Execute(Execute::Dispatcher &dispatcher, Storage &storage, Request &request,
+                        Execute::OutputSink &out);
+
+    /**
+     * Appends response packet for the request executed with the given text result to out. Quiet requests
+     * may produce no response at all. Gets are encoded by EncodeValue instead
+     */
+    static void Encode(const Request &request, const std::string &result, Execute::OutputSink &out);
+
+    /**
+     * Appends response packet for the get that found its value or found nothing. Value is made of the chunks
+     * of out.Values() starting from the given index, they are referenced by the response, not copied
+     */
+    static void EncodeValue(const Request &request, bool found, std::size_t from, Execute::OutputSink &out);
+
+    /**
+     * Drops incomplete packet if any
+     */
+    void Reset() { partial.clear(); }
+
+private:
+    // Bytes missing to complete packet collected in partial
+    std::size_t Missing() const;
+
+    // Builds request out of the complete packet
+    void Decode(const char *packet, std::vector<Request> &requests) const;
+
+    // Packet that spans several reads
+    std::string partial;
+};
+
+} // namespace Protocol
+} // namespace Afina
+
+#endif // AFINA_PROTOCOL_BINARY_PARSER_H
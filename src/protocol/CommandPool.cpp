@@ -0,0 +1,51 @@
+#include "CommandPool.h"
+
+#include <utility>
+
+namespace Afina {
+namespace Protocol {
+
+// See CommandPool.h
+CommandPool::CommandPool(std::size_t max_free) : _state(new State()) { _state->max_free = max_free; }
+
+// See CommandPool.h
+std::size_t CommandPool::FreeCount(CommandType type) const {
+    std::size_t index = static_cast<std::size_t>(type);
+    return index < _state->free.size() ? _state->free[index].size() : 0;
+}
+
+// See CommandPool.h
+Execute::Command *CommandPool::Take(CommandType type) {
+    std::size_t index = static_cast<std::size_t>(type);
+    if (index >= _state->free.size() || _state->free[index].empty()) {
+        return nullptr;
+    }
+
+    Execute::Command *command = _state->free[index].back().release();
+    _state->free[index].pop_back();
+    return command;
+}
+
+// See CommandPool.h
+void CommandPool::Deleter::operator()(Execute::Command *command) const {
+    if (state) {
+        state->Release(command, type);
+    } else {
+        delete command;
+    }
+}
+
+void CommandPool::State::Release(Execute::Command *command, CommandType type) {
+    std::unique_ptr<Execute::Command> ptr(command);
+
+    std::size_t index = static_cast<std::size_t>(type);
+    if (index >= free.size()) {
+        free.resize(index + 1);
+    }
+    if (free[index].size() < max_free) {
+        free[index].push_back(std::move(ptr));
+    }
+}
+
+} // namespace Protocol
+} // namespace Afina
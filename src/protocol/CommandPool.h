@@ -0,0 +1,87 @@
+#ifndef AFINA_PROTOCOL_COMMAND_POOL_H
+#define AFINA_PROTOCOL_COMMAND_POOL_H
+
+#include <cstddef>
+#include <memory>
+#include <vector>
+
+#include <afina/execute/Command.h>
+
+#include "CommandType.h"
+
+namespace Afina {
+namespace Protocol {
+
+/**
+ * # Commands recycled by the connection
+ * Every parser keeps its own pool. Once network layer drops executed request, its command goes back to the
+ * pool instead of the allocator, and parser initializes it again for the next request of the same type. Command
+ * keeps capacity of its strings, so after a few requests parsing allocates neither commands nor their keys.
+ *
+ * Commands not taken from the pool have no pool in their deleter and are deleted as usual. Pool internals are
+ * shared with deleters, so commands could outlive the pool itself. Unlike ChunkPool, this one is not thread
+ * safe: commands must be dropped by the thread that parses requests of the connection.
+ */
+class CommandPool {
+public:
+    struct State;
+
+    /**
+     * Deleter of the command, returns pooled command to the pool
+     */
+    struct Deleter {
+        std::shared_ptr<State> state;
+        CommandType type;
+
+        Deleter() : type(CommandType::kUnknown) {}
+        Deleter(std::shared_ptr<State> state, CommandType type) : state(std::move(state)), type(type) {}
+
+        void operator()(Execute::Command *command) const;
+    };
+
+    using Pointer = std::unique_ptr<Execute::Command, Deleter>;
+
+    /**
+     * @param max_free maximum number of released commands of each type kept for reuse
+     */
+    CommandPool(std::size_t max_free = 64);
+    ~CommandPool() {}
+
+    /**
+     * Returns command of type T released earlier with the same type, or a new default constructed one.
+     * Caller must initialize it through the command pointer
+     */
+    template <typename T> Pointer Acquire(CommandType type, T *&command) {
+        Execute::Command *released = Take(type);
+        command = released ? static_cast<T *>(released) : new T();
+        return Pointer(command, Deleter(_state, type));
+    }
+
+    /**
+     * Number of commands of the given type waiting for reuse
+     */
+    std::size_t FreeCount(CommandType type) const;
+
+    struct State {
+        std::size_t max_free;
+
+        // Released commands indexed by type
+        std::vector<std::vector<std::unique_ptr<Execute::Command>>> free;
+
+        void Release(Execute::Command *command, CommandType type);
+    };
+
+private:
+    CommandPool(const CommandPool &) = delete;
+    CommandPool &operator=(const CommandPool &) = delete;
+
+    // Takes released command of the given type out of the pool, nullptr if there is none
+    Execute::Command *Take(CommandType type);
+
+    std::shared_ptr<State> _state;
+};
+
+} // namespace Protocol
+} // namespace Afina
+
+#endif // AFINA_PROTOCOL_COMMAND_POOL_H
@@ -0,0 +1,153 @@
+#ifndef AFINA_PROTOCOL_COMMAND_TYPE_H
+#define AFINA_PROTOCOL_COMMAND_TYPE_H
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+
+namespace Afina {
+namespace Protocol {
+
+/**
+ * Commands of the text protocol known by the parser
+ */
+enum class CommandType : uint8_t {
+    kUnknown,
+    kSet,
+    kAdd,
+    kReplace,
+    kAppend,
+    kPrepend,
+    kGet,
+    kGets,
+    kGat,
+    kTouch,
+    kDelete,
+    kFlushAll,
+    kScan,
+    kStats,
+    kMetaGet,
+    kMetaSet,
+    kMetaDelete,
+    kMetaArithmetic,
+    kMetaNoop
+};
+
+/**
+ * Packs command name of up to 8 bytes into the integer, so that name could be compared with all known
+ * commands by a single switch. Evaluated at compile time for the case labels
+ */
+constexpr uint64_t pack_name(const char *name, std::size_t size) {
+    return size == 0 ? 0 : (pack_name(name, size - 1) << 8) | static_cast<uint8_t>(name[size - 1]);
+}
+
+template <std::size_t N> constexpr uint64_t pack_name(const char (&name)[N]) { return pack_name(name, N - 1); }
+
+/**
+ * Maps command name to its type, kUnknown if there is no such command
+ */
+inline CommandType command_type(const char *name, std::size_t size) {
+    // The only name that doesn't fit into the packed integer
+    if (size == 9 && std::memcmp(name, "flush_all", 9) == 0) {
+        return CommandType::kFlushAll;
+    }
+    if (size == 0 || size > sizeof(uint64_t)) {
+        return CommandType::kUnknown;
+    }
+
+    uint64_t packed = 0;
+    for (std::size_t i = 0; i < size; i++) {
+        packed = (packed << 8) | static_cast<uint8_t>(name[i]);
+    }
+
+    switch (packed) {
+    case pack_name("set"):
+        return CommandType::kSet;
+    case pack_name("add"):
+        return CommandType::kAdd;
+    case pack_name("replace"):
+        return CommandType::kReplace;
+    case pack_name("append"):
+        return CommandType::kAppend;
+    case pack_name("prepend"):
+        return CommandType::kPrepend;
+    case pack_name("get"):
+        return CommandType::kGet;
+    case pack_name("gets"):
+        return CommandType::kGets;
+    case pack_name("gat"):
+        return CommandType::kGat;
+    case pack_name("touch"):
+        return CommandType::kTouch;
+    case pack_name("delete"):
+        return CommandType::kDelete;
+    case pack_name("scan"):
+        return CommandType::kScan;
+    case pack_name("stats"):
+        return CommandType::kStats;
+    case pack_name("mg"):
+        return CommandType::kMetaGet;
+    case pack_name("ms"):
+        return CommandType::kMetaSet;
+    case pack_name("md"):
+        return CommandType::kMetaDelete;
+    case pack_name("ma"):
+        return CommandType::kMetaArithmetic;
+    case pack_name("mn"):
+        return CommandType::kMetaNoop;
+    default:
+        return CommandType::kUnknown;
+    }
+}
+
+/**
+ * Name of the command as client sends it, "unknown" for kUnknown
+ */
+inline const char *command_name(CommandType type) {
+    switch (type) {
+    case CommandType::kSet:
+        return "set";
+    case CommandType::kAdd:
+        return "add";
+    case CommandType::kReplace:
+        return "replace";
+    case CommandType::kAppend:
+        return "append";
+    case CommandType::kPrepend:
+        return "prepend";
+    case CommandType::kGet:
+        return "get";
+    case CommandType::kGets:
+        return "gets";
+    case CommandType::kGat:
+        return "gat";
+    case CommandType::kTouch:
+        return "touch";
+    case CommandType::kDelete:
+        return "delete";
+    case CommandType::kFlushAll:
+        return "flush_all";
+    case CommandType::kScan:
+        return "scan";
+    case CommandType::kStats:
+        return "stats";
+    case CommandType::kMetaGet:
+        return "mg";
+    case CommandType::kMetaSet:
+        return "ms";
+    case CommandType::kMetaDelete:
+        return "md";
+    case CommandType::kMetaArithmetic:
+        return "ma";
+    case CommandType::kMetaNoop:
+        return "mn";
+    case CommandType::kUnknown:
+        break;
+    }
+    return "unknown";
+}
+
+} // namespace Protocol
+} // namespace Afina
+
+#endif // AFINA_PROTOCOL_COMMAND_TYPE_H
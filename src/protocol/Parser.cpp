@@ -1,78 +1,165 @@
 #include "Parser.h"
+#include "Scanner.h"
 
+#include <algorithm>
+#include <cerrno>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
 #include <iostream>
 #include <sstream>
 #include <stdexcept>
+#include <utility>
 
 #include <afina/execute/Add.h>
 #include <afina/execute/Append.h>
 #include <afina/execute/Command.h>
 #include <afina/execute/Delete.h>
+#include <afina/execute/FlushAll.h>
+#include <afina/execute/Gat.h>
 #include <afina/execute/Get.h>
+#include <afina/execute/Meta.h>
+#include <afina/execute/Prepend.h>
+#include <afina/execute/Replace.h>
+#include <afina/execute/Scan.h>
 #include <afina/execute/Set.h>
 #include <afina/execute/Stats.h>
+#include <afina/execute/Touch.h>
 
 namespace Afina {
 namespace Protocol {
 
+const std::size_t Parser::kMaxBodySize;
+
+namespace {
+
+// Parses expiration time argument of touch, gat and flush_all
+int32_t parse_exptime(const std::string &arg) {
+    char *end = nullptr;
+    errno = 0;
+    long value = std::strtol(arg.c_str(), &end, 10);
+    if (arg.empty() || *end != '\0' || errno == ERANGE || value < INT32_MIN || value > INT32_MAX) {
+        throw std::runtime_error("Invalid expiration time: " + arg);
+    }
+    return static_cast<int32_t>(value);
+}
+
+// Takes storage command out of the pool and initializes it
+template <typename T>
+CommandPool::Pointer insert_command(CommandPool &pool, CommandType type, const Parser::View &key, uint32_t flags,
+                                    int32_t expire) {
+    T *command;
+    CommandPool::Pointer result = pool.Acquire(type, command);
+    command->Reset(key.data, key.size, flags, expire);
+    return result;
+}
+
+} // namespace
+
+// See Parse.h
+bool Parser::View::operator==(const char *other) const {
+    return std::strlen(other) == size && std::memcmp(data, other, size) == 0;
+}
+
 // See Parse.h
 bool Parser::Parse(const char *input, const size_t size, size_t &parsed) {
     size_t pos;
     parsed = 0;
+    this->input = input;
 
     for (pos = 0; pos < size && !parse_complete; pos++) {
+        // Tokens are cut out of input as a whole, state machine below sees only delimiters
+        if (state == State::sName || state == State::sgKey || state == State::spNoreply) {
+            std::size_t len = find_any_of(input + pos, size - pos, ' ', '\r');
+            Extend(input, pos, len);
+            pos += len;
+        } else if (state == State::spKey) {
+            std::size_t len = find_first(input + pos, size - pos, ' ');
+            Extend(input, pos, len);
+            pos += len;
+        }
+
+        if (pos == size) {
+            break;
+        }
+
         char c = input[pos];
         // std::cout << "[" << pos << "] '" << c << "': state=" << int(state) << std::endl;
 
         switch (state) {
         case State::sName: {
-            if (c == ' ' || c == '\r') {
-                // std::cout << "parser debug: name='" << name << "'" << std::endl;
-                if (name == "set" || name == "add" || name == "append" || name == "prepend") {
-                    state = State::spKey;
-                } else if (name == "get" || name == "gets") {
-                    state = State::sgKey;
-                } else if (name == "stats") {
-                    state = State::sLF;
-                    continue;
-                } else {
-                    throw std::runtime_error("Unknown command name: " + name);
-                }
-            } else {
-                name.push_back(c);
+            // Token loop above stops only on ' ' or '\r'
+            name = curKey;
+            curKey = Token{0, 0, false};
+
+            View cmd = NameView();
+            type = command_type(cmd.data, cmd.size);
+            switch (type) {
+            case CommandType::kSet:
+            case CommandType::kAdd:
+            case CommandType::kReplace:
+            case CommandType::kAppend:
+            case CommandType::kPrepend:
+                state = State::spKey;
+                has_body = true;
+                break;
+
+            case CommandType::kGet:
+            case CommandType::kGets:
+            case CommandType::kScan:
+            case CommandType::kMetaGet:
+            case CommandType::kMetaDelete:
+            case CommandType::kMetaArithmetic:
+                // Meta commands: key and flags are collected as get keys
+                state = State::sgKey;
+                break;
+
+            case CommandType::kMetaSet:
+                state = State::sgKey;
+                has_body = true;
+                break;
+
+            case CommandType::kGat:
+            case CommandType::kTouch:
+            case CommandType::kDelete:
+            case CommandType::kFlushAll:
+            case CommandType::kStats:
+                // Arguments are collected as get keys, flush_all and stats might have none
+                state = (c == '\r') ? State::sLF : State::sgKey;
+                break;
+
+            case CommandType::kMetaNoop:
+                state = State::sLF;
+                continue;
+
+            default:
+                throw std::runtime_error("Unknown command name: " + cmd.str());
             }
             break;
         }
 
         case State::spKey: {
-            if (c == ' ') {
-                state = State::spFlags;
-                keys.push_back(curKey);
-                // std::cout << "parser debug: key[" << keys.size() - 1 << "]='" << curKey << "'" << std::endl;
-            } else {
-                curKey.push_back(c);
-            }
+            // Token loop above stops only on ' '
+            state = State::spFlags;
+            keys.push_back(curKey);
+            curKey = Token{0, 0, false};
             break;
         }
 
         case State::sgKey: {
-            if (c == '\r') {
-                keys.push_back(curKey);
-                // std::cout << "parser debug: total '" << keys.size() << " keys" << std::endl;
-
-                if (keys.size() == 0) {
-                    throw std::runtime_error("Client provides no key to retrive");
+            if (type == CommandType::kTouch || type == CommandType::kDelete || type == CommandType::kFlushAll) {
+                // noreply is the last argument of these commands
+                if (Resolve(curKey) == "noreply") {
+                    noreply = true;
+                } else {
+                    keys.push_back(curKey);
                 }
-
-                curKey.clear();
-                state = State::sLF;
-            } else if (c == ' ') {
-                // std::cout << "parser debug: key[" << keys.size() << "]='" << curKey << "'" << std::endl;
-                state = State::sgKey;
-                keys.push_back(curKey);
-                curKey.clear();
             } else {
-                curKey.push_back(c);
+                keys.push_back(curKey);
+            }
+            curKey = Token{0, 0, false};
+            if (c == '\r') {
+                state = State::sLF;
             }
             break;
         }
@@ -109,19 +196,11 @@ bool Parser::Parse(const char *input, const size_t size, size_t &parsed) {
                 state = State::spBytes;
                 // std::cout << "parser debug: ExprTime='" << exprtime << "'" << std::endl;
             } else if (c >= '0' && c <= '9') {
-                int32_t et = exprtime;
-                if (negative) {
-                    et -= (c - '0');
-                    if (et > exprtime) {
-                        throw std::runtime_error("Expire time field overflow");
-                    }
-                } else {
-                    et += (c - '0');
-                    if (et < exprtime) {
-                        throw std::runtime_error("Expire time field overflow");
-                    }
+                int64_t et = int64_t(exprtime) * 10 + (negative ? -(c - '0') : (c - '0'));
+                if (et < INT32_MIN || et > INT32_MAX) {
+                    throw std::runtime_error("Expire time field overflow");
                 }
-                exprtime = et;
+                exprtime = static_cast<int32_t>(et);
             }
             break;
         }
@@ -130,6 +209,8 @@ bool Parser::Parse(const char *input, const size_t size, size_t &parsed) {
             if (c == '\r') {
                 state = State::sLF;
                 // std::cout << "parser debug: bytes='" << bytes << "'" << std::endl;
+            } else if (c == ' ') {
+                state = State::spNoreply;
             } else if (c >= '0' && c <= '9') {
                 uint32_t b = (bytes * 10) + (c - '0');
                 if (b < bytes) {
@@ -141,6 +222,22 @@ bool Parser::Parse(const char *input, const size_t size, size_t &parsed) {
             break;
         }
 
+        case State::spNoreply: {
+            // Token loop above stops only on ' ' or '\r'
+            View token = Resolve(curKey);
+            if (token == "noreply") {
+                noreply = true;
+            } else if (token.size != 0) {
+                throw std::runtime_error("Unexpected argument: " + token.str());
+            }
+
+            curKey = Token{0, 0, false};
+            if (c == '\r') {
+                state = State::sLF;
+            }
+            break;
+        }
+
         case State::sLF: {
             if (c == '\n') {
                 parse_complete = true;
@@ -157,28 +254,284 @@ bool Parser::Parse(const char *input, const size_t size, size_t &parsed) {
         }
     }
 
+    if (!parse_complete) {
+        // Caller may drop consumed part of the buffer before the next call
+        OwnAll();
+    }
+
     parsed += pos;
     return parse_complete;
 }
 
 // See Parse.h
-std::unique_ptr<Execute::Command> Parser::Build(size_t &body_size) const {
+Parser::View Parser::Resolve(const Token &token) const {
+    return View{(token.owned ? spill.data() : input) + token.offset, token.length};
+}
+
+// See Parse.h
+void Parser::Extend(const char *input, std::size_t pos, std::size_t len) {
+    if (curKey.owned) {
+        spill.append(input + pos, len);
+    } else if (curKey.length == 0) {
+        curKey.offset = pos;
+    }
+    curKey.length += len;
+}
+
+// See Parse.h
+void Parser::OwnAll() {
+    Own(name);
+    for (auto &key : keys) {
+        Own(key);
+    }
+    // Current token must be the last one in spill as next call will continue it
+    Own(curKey);
+}
+
+// See Parse.h
+void Parser::Own(Token &token) {
+    if (!token.owned) {
+        std::size_t offset = spill.size();
+        spill.append(input + token.offset, token.length);
+        token = Token{offset, token.length, true};
+    }
+}
+
+// See Parse.h
+std::size_t Parser::ParseBatch(const char *input, const size_t size, std::vector<Request> &requests) {
+    std::size_t pos = 0;
+    while (pos < size) {
+        if (!pending.command) {
+            std::size_t parsed = 0;
+            bool complete = Parse(input + pos, size - pos, parsed);
+            pos += parsed;
+            if (!complete) {
+                break;
+            }
+
+            // Storage commands are always followed by the data block, even an empty one
+            std::size_t body_size = 0;
+            CommandPool::Pointer command = Make(body_size);
+            bool body = has_body;
+            bool quiet = noreply;
+            CommandType parsed_type = type;
+            Reset();
+
+            if (body_size > kMaxBodySize) {
+                throw std::runtime_error("Data block is too large: " + std::to_string(body_size));
+            }
+
+            // Buffer gets its final size right away, so that caller could read the block directly there
+            pending.command = std::move(command);
+            pending.noreply = quiet;
+            pending.type = parsed_type;
+            pending_remains = body ? body_size + 2 : 0;
+            pending.argument.resize(pending_remains);
+        }
+
+        if (pending_remains > 0) {
+            std::size_t to_read = std::min(pending_remains, size - pos);
+            std::memcpy(&pending.argument[pending.argument.size() - pending_remains], input + pos, to_read);
+            pending_remains -= to_read;
+            pos += to_read;
+            if (pending_remains > 0) {
+                break;
+            }
+        }
+
+        Complete(requests);
+    }
+    return pos;
+}
+
+// See Parse.h
+char *Parser::BodyBuffer(std::size_t &size) {
+    if (!pending.command || pending_remains == 0) {
+        size = 0;
+        return nullptr;
+    }
+
+    size = pending_remains;
+    return &pending.argument[pending.argument.size() - pending_remains];
+}
+
+// See Parse.h
+void Parser::BodyReceived(std::size_t size, std::vector<Request> &requests) {
+    if (size > pending_remains) {
+        throw std::runtime_error("More data received than requested");
+    }
+
+    pending_remains -= size;
+    if (pending.command && pending_remains == 0) {
+        Complete(requests);
+    }
+}
+
+// See Parse.h
+void Parser::Complete(std::vector<Request> &requests) {
+    if (!pending.argument.empty()) {
+        // Cut trailing \r\n
+        pending.argument.resize(pending.argument.size() - 2);
+    }
+
+    requests.push_back(std::move(pending));
+    pending.command.reset();
+    pending.argument.clear();
+}
+
+// See Parse.h
+CommandPool::Pointer Parser::Make(size_t &body_size) {
     if (state != State::sLF) {
-        return std::unique_ptr<Execute::Command>(nullptr);
+        return CommandPool::Pointer();
     }
 
     body_size = bytes;
-    if (name == "set") {
-        return std::unique_ptr<Execute::Command>(new Execute::Set(keys[0], flags, exprtime));
-    } else if (name == "add") {
-        return std::unique_ptr<Execute::Command>(new Execute::Add(keys[0], flags, exprtime));
-    } else if (name == "append") {
-        return std::unique_ptr<Execute::Command>(new Execute::Append(keys[0], flags, exprtime));
-    } else if (name == "get") {
-        return std::unique_ptr<Execute::Command>(new Execute::Get(keys));
-    } else if (name == "stats") {
-        return std::unique_ptr<Execute::Command>(new Execute::Stats());
-    } else {
+    switch (type) {
+    case CommandType::kSet:
+        return insert_command<Execute::Set>(pool, type, KeyView(0), flags, exprtime);
+
+    case CommandType::kAdd:
+        return insert_command<Execute::Add>(pool, type, KeyView(0), flags, exprtime);
+
+    case CommandType::kAppend:
+        return insert_command<Execute::Append>(pool, type, KeyView(0), flags, exprtime);
+
+    case CommandType::kPrepend:
+        return insert_command<Execute::Prepend>(pool, type, KeyView(0), flags, exprtime);
+
+    case CommandType::kReplace:
+        return insert_command<Execute::Replace>(pool, type, KeyView(0), flags, exprtime);
+
+    case CommandType::kDelete: {
+        // delete <key> [0] [noreply], old clients still send zero time
+        if (keys.empty() || keys.size() > 2 || KeyView(0).size == 0) {
+            throw std::runtime_error("Invalid arguments for delete");
+        }
+        if (keys.size() == 2 && !(KeyView(1) == "0")) {
+            throw std::runtime_error("Bad command line format. Usage: delete <key> [noreply]");
+        }
+        Execute::Delete *del;
+        CommandPool::Pointer result = pool.Acquire(type, del);
+        del->Reset(KeyView(0).data, KeyView(0).size);
+        return result;
+    }
+
+    case CommandType::kTouch: {
+        // touch <key> <exptime> [noreply]
+        if (keys.size() != 2 || KeyView(0).size == 0) {
+            throw std::runtime_error("Invalid arguments for touch");
+        }
+        int32_t expire = parse_exptime(KeyView(1).str());
+        Execute::Touch *touch;
+        CommandPool::Pointer result = pool.Acquire(type, touch);
+        touch->Reset(KeyView(0).data, KeyView(0).size, expire);
+        return result;
+    }
+
+    case CommandType::kGat: {
+        // gat <exptime> <key>*
+        if (keys.size() < 2) {
+            throw std::runtime_error("Not enough arguments for gat");
+        }
+        int32_t expire = parse_exptime(KeyView(0).str());
+        Execute::Gat *gat;
+        CommandPool::Pointer result = pool.Acquire(type, gat);
+        std::vector<std::string> &args = gat->Reset(expire, keys.size() - 1);
+        for (std::size_t i = 1; i < keys.size(); i++) {
+            View key = KeyView(i);
+            args[i - 1].assign(key.data, key.size);
+        }
+        return result;
+    }
+
+    case CommandType::kFlushAll: {
+        // flush_all [delay] [noreply]
+        if (keys.size() > 1) {
+            throw std::runtime_error("Too many arguments for flush_all");
+        }
+        int32_t delay = keys.empty() ? 0 : parse_exptime(KeyView(0).str());
+        return CommandPool::Pointer(new Execute::FlushAll(delay));
+    }
+
+    case CommandType::kGet: {
+        Execute::Get *get;
+        CommandPool::Pointer result = pool.Acquire(type, get);
+        std::vector<std::string> &args = get->Reset(keys.size());
+        for (std::size_t i = 0; i < keys.size(); i++) {
+            View key = KeyView(i);
+            args[i].assign(key.data, key.size);
+        }
+        return result;
+    }
+
+    case CommandType::kStats: {
+        // stats [section]
+        if (keys.size() > 1) {
+            throw std::runtime_error("Too many arguments for stats");
+        }
+        return CommandPool::Pointer(keys.empty() ? new Execute::Stats() : new Execute::Stats(KeyView(0).str()));
+    }
+
+    case CommandType::kMetaGet:
+    case CommandType::kMetaSet:
+    case CommandType::kMetaDelete:
+    case CommandType::kMetaArithmetic: {
+        // <cmd> <key> [<datalen>] <flags>*
+        std::size_t flags_from = (type == CommandType::kMetaSet) ? 2 : 1;
+        if (keys.size() < flags_from || KeyView(0).size == 0) {
+            throw std::runtime_error("Not enough arguments for " + Name());
+        }
+
+        std::vector<std::string> meta_flags;
+        for (std::size_t i = flags_from; i < keys.size(); i++) {
+            meta_flags.push_back(KeyView(i).str());
+        }
+
+        std::string key = KeyView(0).str();
+        if (type == CommandType::kMetaGet) {
+            return CommandPool::Pointer(new Execute::MetaGet(key, meta_flags));
+        } else if (type == CommandType::kMetaDelete) {
+            return CommandPool::Pointer(new Execute::MetaDelete(key, meta_flags));
+        } else if (type == CommandType::kMetaArithmetic) {
+            return CommandPool::Pointer(new Execute::MetaArithmetic(key, meta_flags));
+        }
+
+        std::string arg = KeyView(1).str();
+        char *end = nullptr;
+        body_size = std::strtoul(arg.c_str(), &end, 10);
+        if (arg.empty() || *end != '\0') {
+            throw std::runtime_error("Invalid data length: " + arg);
+        }
+        return CommandPool::Pointer(new Execute::MetaSet(key, meta_flags));
+    }
+
+    case CommandType::kMetaNoop:
+        return CommandPool::Pointer(new Execute::MetaNoop());
+
+    case CommandType::kScan: {
+        // scan <prefix> [<limit> [<start>]]
+        if (keys.size() > 3) {
+            throw std::runtime_error("Too many arguments for scan");
+        }
+
+        std::size_t limit = Execute::Scan::kDefaultLimit;
+        if (keys.size() > 1) {
+            std::string arg = KeyView(1).str();
+            char *end = nullptr;
+            limit = std::strtoul(arg.c_str(), &end, 10);
+            if (arg.empty() || *end != '\0') {
+                throw std::runtime_error("Invalid scan limit: " + arg);
+            }
+        }
+
+        std::string start;
+        if (keys.size() > 2) {
+            start = KeyView(2).str();
+        }
+        return CommandPool::Pointer(new Execute::Scan(KeyView(0).str(), start, limit));
+    }
+
+    default:
         throw std::runtime_error("Unsupported command");
     }
 }
@@ -186,10 +539,20 @@ std::unique_ptr<Execute::Command> Parser::Build(size_t &body_size) const {
 // See Parse.h
 void Parser::Reset() {
     state = State::sName;
-    name.clear();
+    input = nullptr;
+    spill.clear();
+    name = Token{0, 0, false};
     keys.clear();
-    curKey.clear();
+    curKey = Token{0, 0, false};
     parse_complete = false;
+    type = CommandType::kUnknown;
+    has_body = false;
+    noreply = false;
+    pending.command.reset();
+    pending.noreply = false;
+    pending.type = CommandType::kUnknown;
+    pending.argument.clear();
+    pending_remains = 0;
     flags = 0;
     bytes = 0;
     exprtime = 0;
@@ -8,28 +8,75 @@
 #include <cstddef>
 #include <cstdint>
 
+#include <afina/execute/Command.h>
+
+#include "CommandPool.h"
+#include "CommandType.h"
+
 namespace Afina {
-namespace Execute {
-class Command;
-} // namespace Execute
 namespace Protocol {
 
 /**
  * # Memcached protocol parser
  * Parser supports subset of memcached protocol
+ *
+ * Command name and keys are not copied out of the input: parser remembers offset and length of each token in
+ * the buffer given to the last Parse call, those could be read with NameView/KeyView until caller changes the
+ * buffer. Only if command spans several Parse calls its tokens are copied into the parser's own buffer, because
+ * caller is free to drop consumed bytes.
  */
 class Parser {
 public:
+    /**
+     * Bytes of the parsed token. Valid until next call to Parse/Reset or until caller modifies its buffer
+     */
+    struct View {
+        const char *data;
+        std::size_t size;
+
+        std::string str() const { return std::string(data, size); }
+        bool operator==(const char *other) const;
+    };
+
+    /**
+     * Command parsed out of the stream together with its data block
+     */
+    struct Request {
+        // Commands of the batch requests are recycled by the parser once request is dropped
+        CommandPool::Pointer command;
+
+        // Data block without trailing \r\n, empty for commands that have no one
+        std::string argument;
+
+        // Client asked not to send any response
+        bool noreply;
+
+        CommandType type;
+
+        // Time request was read at, steady clock nanoseconds. Set by network layer to expire requests
+        // that waited for too long, parser leaves it 0
+        uint64_t received = 0;
+    };
+
+    // Data blocks larger than that are rejected rather than allocated
+    static const std::size_t kMaxBodySize = 64 * 1024 * 1024;
+
     Parser() { Reset(); }
     /**
      * Push given string into parser input. Method returns true if it was a command parsed out
      * from comulative input. In a such case method Build will return new command
      *
+     * String could be a temporary, so unlike the method below this one copies parsed tokens
+     *
      * @param input sttring to be added to the parsed input
      * @param parsed output parameter tells how many bytes was consumed from the string
      * @return true if command has been parsed out
      */
-    bool Parse(const std::string &input, size_t &parsed) { return Parse(&input[0], input.size(), parsed); }
+    bool Parse(const std::string &input, size_t &parsed) {
+        bool complete = Parse(&input[0], input.size(), parsed);
+        OwnAll();
+        return complete;
+    }
 
     /**
      * Push given string into parser input. Method returns true if it was a command parsed out
@@ -42,18 +89,74 @@ public:
      */
     bool Parse(const char *input, const size_t size, size_t &parsed);
 
+    /**
+     * Parses out every complete command along with its data block from the given buffer in a single pass and
+     * appends them to requests. Incomplete command at the end of the buffer is kept inside of the parser and
+     * will be finished by following calls, so caller doesn't need to keep unconsumed bytes around.
+     *
+     * Must not be mixed with Parse/Build for the same stream
+     *
+     * @param input buffer to be parsed
+     * @param size number of bytes in the input buffer that could be read
+     * @param requests output parameter, complete requests are appended there
+     * @return number of bytes consumed from the input
+     */
+    std::size_t ParseBatch(const char *input, const size_t size, std::vector<Request> &requests);
+
+    /**
+     * In case if batch parsing stopped in the middle of the data block, returns pointer to the place in the
+     * request buffer where the rest of the block goes, so that caller could read it there directly instead of
+     * passing through its own buffer. Returns nullptr if parser doesn't wait for a data block.
+     *
+     * @param size output parameter, number of bytes still missing
+     */
+    char *BodyBuffer(std::size_t &size);
+
+    /**
+     * Tells parser that size bytes were written to the buffer returned by BodyBuffer. Once data block is
+     * complete request is appended to requests
+     */
+    void BodyReceived(std::size_t size, std::vector<Request> &requests);
+
     /**
      * Builds new command from parsed input. In case if it wasn't enough input to prse command out
      * method return nullptr
      */
-    std::unique_ptr<Execute::Command> Build(size_t &body_size) const;
+    std::unique_ptr<Execute::Command> Build(size_t &body_size) {
+        return std::unique_ptr<Execute::Command>(Make(body_size).release());
+    }
 
     /**
-     * Reset parse so that it could be used to parse out new command
+     * Reset parse so that it could be used to parse out new command, drops incomplete batch request if any
      */
     void Reset();
 
-    inline const std::string &Name() const { return name; }
+    inline std::string Name() const { return NameView().str(); }
+
+    /**
+     * Type of the parsed command, known as soon as command name is tokenized
+     */
+    inline CommandType Type() const { return type; }
+
+    /**
+     * Storage command has trailing noreply token, so client doesn't expect any response
+     */
+    inline bool Noreply() const { return noreply; }
+
+    /**
+     * Command name, see View for lifetime
+     */
+    View NameView() const { return Resolve(name); }
+
+    /**
+     * Number of tokens following the command name (keys for get, key for set etc)
+     */
+    std::size_t KeysCount() const { return keys.size(); }
+
+    /**
+     * Token following the command name, see View for lifetime
+     */
+    View KeyView(std::size_t i) const { return Resolve(keys[i]); }
 
 private:
     /**
@@ -62,14 +165,56 @@ private:
      * - sp: for PUT commands only
      * - sg: for GET commands only
      */
-    enum State : uint16_t { sCR, sLF, sName, spKey, spFlags, spExprTimeStart, spExprTime, spBytes, sgKey };
+    enum State : uint16_t {
+        sCR,
+        sLF,
+        sName,
+        spKey,
+        spFlags,
+        spExprTimeStart,
+        spExprTime,
+        spBytes,
+        spNoreply,
+        sgKey
+    };
+
+    /**
+     * Position of the token: either in the input of the last Parse call or, if owned, in the spill buffer
+     */
+    struct Token {
+        std::size_t offset;
+        std::size_t length;
+        bool owned;
+    };
+
+    View Resolve(const Token &token) const;
+
+    // Builds command from parsed input, commands of the common types are taken from the pool
+    CommandPool::Pointer Make(size_t &body_size);
+
+    // Adds len bytes of input starting from pos to the current token
+    void Extend(const char *input, std::size_t pos, std::size_t len);
+
+    // Moves pending request with complete data block into requests
+    void Complete(std::vector<Request> &requests);
+
+    // Copies token into spill buffer, so that it survives changes of the caller's buffer
+    void Own(Token &token);
+    void OwnAll();
 
     // Current parser state
     State state;
 
+    // Input of the last Parse call, tokens not owned point there
+    const char *input;
+
+    // Storage for tokens that span several Parse calls
+    std::string spill;
+
     // vrious fields of the command
-    std::string name;
-    std::vector<std::string> keys;
+    Token name;
+    CommandType type;
+    std::vector<Token> keys;
 
     // <flags> is an arbitrary 16-bit unsigned integer (written out in decimal) that the server stores along with
     // the data and sends back when the item is retrieved. Clients may use this as a bit field to store data-specific
@@ -89,8 +234,19 @@ private:
     uint32_t bytes;
 
     bool negative;
-    std::string curKey;
+    bool noreply;
+    Token curKey;
     bool parse_complete;
+
+    // Parsed command is followed by the data block
+    bool has_body;
+
+    // Batch mode: command waiting for its data block and how many bytes of it (including \r\n) are missing
+    Request pending;
+    std::size_t pending_remains;
+
+    // Commands of the dropped requests waiting for reuse
+    CommandPool pool;
 };
 
 } // namespace Protocol
@@ -0,0 +1,301 @@
+#include "RespParser.h"
+
+#include <algorithm>
+#include <cctype>
+#include <cstring>
+#include <limits>
+#include <stdexcept>
+#include <utility>
+
+#include <afina/execute/Resp.h>
+
+#include "Scanner.h"
+
+namespace Afina {
+namespace Protocol {
+
+namespace {
+
+// Header line is a prefix, a number and \r\n, anything longer is not a RESP
+const std::size_t kMaxLine = 32;
+
+std::string upper(const std::string &token) {
+    std::string result(token);
+    for (auto &c : result) {
+        c = std::toupper(static_cast<unsigned char>(c));
+    }
+    return result;
+}
+
+std::string lower(const std::string &token) {
+    std::string result(token);
+    for (auto &c : result) {
+        c = std::tolower(static_cast<unsigned char>(c));
+    }
+    return result;
+}
+
+} // namespace
+
+// See RespParser.h
+std::size_t RespParser::ParseBatch(const char *input, const size_t size, std::vector<Request> &requests) {
+    std::size_t pos = 0;
+    while (pos < size) {
+        switch (state) {
+        case sArray: {
+            int64_t number;
+            if (!Header(input, size, pos, '*', number)) {
+                return pos;
+            }
+            if (number > static_cast<int64_t>(kMaxArguments)) {
+                throw std::runtime_error("Protocol error: invalid multibulk length");
+            }
+
+            // Empty and null arrays are skipped, Redis does the same
+            if (number > 0) {
+                args.clear();
+                count = number;
+                state = sBulkHeader;
+            }
+            break;
+        }
+
+        case sBulkHeader: {
+            int64_t number;
+            if (!Header(input, size, pos, '$', number)) {
+                return pos;
+            }
+            if (number < 0 || number > static_cast<int64_t>(kMaxBulkSize)) {
+                throw std::runtime_error("Protocol error: invalid bulk length");
+            }
+
+            // String size is known upfront: bytes are copied right into its final buffer, only once
+            std::size_t length = number;
+            std::size_t available = size - pos;
+            args.emplace_back();
+            if (available >= length + 2) {
+                if (input[pos + length] != '\r' || input[pos + length + 1] != '\n') {
+                    throw std::runtime_error("Protocol error: bulk string must end with \\r\\n");
+                }
+                args.back().assign(input + pos, length);
+                pos += length + 2;
+                if (args.size() == count) {
+                    Build(requests);
+                }
+            } else {
+                args.back().resize(length + 2);
+                std::memcpy(&args.back()[0], input + pos, available);
+                remains = length + 2 - available;
+                pos = size;
+                state = sBulk;
+            }
+            break;
+        }
+
+        case sBulk: {
+            std::size_t length = std::min(remains, size - pos);
+            std::string &arg = args.back();
+            std::memcpy(&arg[arg.size() - remains], input + pos, length);
+            pos += length;
+            remains -= length;
+            if (remains == 0) {
+                Complete(requests);
+            }
+            break;
+        }
+        }
+    }
+
+    return pos;
+}
+
+// See RespParser.h
+char *RespParser::BodyBuffer(std::size_t &size) {
+    if (state != sBulk || remains == 0) {
+        size = 0;
+        return nullptr;
+    }
+
+    size = remains;
+    return &args.back()[args.back().size() - remains];
+}
+
+// See RespParser.h
+void RespParser::BodyReceived(std::size_t size, std::vector<Request> &requests) {
+    if (state != sBulk || size > remains) {
+        throw std::runtime_error("More data received than requested");
+    }
+
+    remains -= size;
+    if (remains == 0) {
+        Complete(requests);
+    }
+}
+
+// See RespParser.h
+void RespParser::Reset() {
+    state = sArray;
+    line.clear();
+    args.clear();
+    count = 0;
+    remains = 0;
+}
+
+// See RespParser.h
+bool RespParser::Header(const char *input, std::size_t size, std::size_t &pos, char prefix, int64_t &number) {
+    std::size_t end = find_first(input + pos, size - pos, '\n');
+    if (end == size - pos) {
+        line.append(input + pos, end);
+        if (line.size() > kMaxLine) {
+            throw std::runtime_error("Protocol error: too big header");
+        }
+        pos = size;
+        return false;
+    }
+
+    const char *begin = input + pos;
+    std::size_t length = end;
+    if (!line.empty()) {
+        line.append(begin, length);
+        begin = line.data();
+        length = line.size();
+    }
+    pos += end + 1;
+
+    if (length < 3 || begin[length - 1] != '\r' || length > kMaxLine) {
+        throw std::runtime_error("Protocol error: invalid header");
+    }
+    if (begin[0] != prefix) {
+        throw std::runtime_error(std::string("Protocol error: expected '") + prefix + "', got '" + begin[0] + "'");
+    }
+
+    // Only -1 could be negative, it means null array or string
+    std::size_t digit = (begin[1] == '-') ? 2 : 1;
+    if (digit == length - 1 || length - 1 - digit > 18) {
+        throw std::runtime_error("Protocol error: invalid header");
+    }
+    int64_t value = 0;
+    for (; digit < length - 1; digit++) {
+        if (begin[digit] < '0' || begin[digit] > '9') {
+            throw std::runtime_error("Protocol error: invalid header");
+        }
+        value = value * 10 + (begin[digit] - '0');
+    }
+    number = (begin[1] == '-') ? -value : value;
+
+    line.clear();
+    return true;
+}
+
+// See RespParser.h
+void RespParser::Complete(std::vector<Request> &requests) {
+    std::string &arg = args.back();
+    if (arg[arg.size() - 2] != '\r' || arg[arg.size() - 1] != '\n') {
+        throw std::runtime_error("Protocol error: bulk string must end with \\r\\n");
+    }
+    arg.resize(arg.size() - 2);
+
+    state = sBulkHeader;
+    if (args.size() == count) {
+        Build(requests);
+    }
+}
+
+// See RespParser.h
+void RespParser::Build(std::vector<Request> &requests) {
+    state = sArray;
+
+    Request request;
+    request.noreply = false;
+    request.type = CommandType::kUnknown;
+
+    const std::string name = upper(args[0]);
+    const std::size_t size = args.size();
+    bool arity = true;
+    int64_t number = 0;
+
+    if (name == "GET") {
+        arity = (size == 2);
+        if (arity) {
+            request.command.reset(new Execute::RespGet(args[1]));
+        }
+    } else if (name == "SET") {
+        arity = (size >= 3);
+        if (arity) {
+            auto condition = Execute::RespSet::Condition::Always;
+            int64_t ttl = 0;
+            std::string error;
+            for (std::size_t i = 3; i < size && error.empty(); i++) {
+                std::string option = upper(args[i]);
+                if ((option == "EX" || option == "PX") && i + 1 < size && ttl == 0) {
+                    if (!Execute::RespCommand::ParseInteger(args[++i], number)) {
+                        error = "value is not an integer or out of range";
+                    } else if (number <= 0) {
+                        error = "invalid expire time in 'set' command";
+                    } else {
+                        // Storage keeps ttl in seconds, milliseconds are rounded up
+                        ttl = (option == "EX") ? number : number / 1000 + (number % 1000 != 0 ? 1 : 0);
+                    }
+                } else if (option == "NX" && condition == Execute::RespSet::Condition::Always) {
+                    condition = Execute::RespSet::Condition::IfAbsent;
+                } else if (option == "XX" && condition == Execute::RespSet::Condition::Always) {
+                    condition = Execute::RespSet::Condition::IfPresent;
+                } else {
+                    error = "syntax error";
+                }
+            }
+
+            if (error.empty()) {
+                request.command.reset(new Execute::RespSet(args[1], condition, ttl));
+                request.argument = std::move(args[2]);
+            } else {
+                request.command.reset(new Execute::RespError(error));
+            }
+        }
+    } else if (name == "DEL") {
+        arity = (size >= 2);
+        if (arity) {
+            std::vector<std::string> keys;
+            keys.reserve(size - 1);
+            for (std::size_t i = 1; i < size; i++) {
+                keys.push_back(std::move(args[i]));
+            }
+            request.command.reset(new Execute::RespDelete(std::move(keys)));
+        }
+    } else if (name == "INCR" || name == "DECR") {
+        arity = (size == 2);
+        if (arity) {
+            request.command.reset(new Execute::RespIncrement(args[1], name == "INCR" ? 1 : -1));
+        }
+    } else if (name == "INCRBY" || name == "DECRBY" || name == "EXPIRE") {
+        arity = (size == 3);
+        if (arity) {
+            if (!Execute::RespCommand::ParseInteger(args[2], number)) {
+                request.command.reset(new Execute::RespError("value is not an integer or out of range"));
+            } else if (name == "EXPIRE") {
+                request.command.reset(new Execute::RespExpire(args[1], number));
+            } else if (name == "DECRBY" && number == std::numeric_limits<int64_t>::min()) {
+                request.command.reset(new Execute::RespError("decrement would overflow"));
+            } else {
+                request.command.reset(new Execute::RespIncrement(args[1], name == "INCRBY" ? number : -number));
+            }
+        }
+    } else if (name == "PING") {
+        arity = (size == 1);
+        if (arity) {
+            request.command.reset(new Execute::RespPing());
+        }
+    } else {
+        request.command.reset(new Execute::RespError("unknown command '" + args[0] + "'"));
+    }
+
+    if (!arity) {
+        request.command.reset(new Execute::RespError("wrong number of arguments for '" + lower(name) + "' command"));
+    }
+
+    args.clear();
+    requests.push_back(std::move(request));
+}
+
+} // namespace Protocol
+} // namespace Afina
@@ -0,0 +1,96 @@
+#ifndef AFINA_PROTOCOL_RESP_PARSER_H
+#define AFINA_PROTOCOL_RESP_PARSER_H
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include <cstddef>
+#include <cstdint>
+
+#include "Parser.h"
+
+namespace Afina {
+namespace Protocol {
+
+/**
+ * # Redis protocol (RESP2) parser
+ * Every command is an array of bulk strings: "*<count>\r\n" followed by count "$<size>\r\n<bytes>\r\n". Parser
+ * supports GET, SET, DEL, INCR, INCRBY, DECR, DECRBY, EXPIRE and PING, each one becomes Execute command that
+ * replies in RESP, so network layer runs them exactly like memcached ones. Commands parser can't execute
+ * become error replies, while broken framing throws runtime_error as the stream can't be followed anymore.
+ *
+ * Bulk strings are length prefixed, so parser allocates each one at its final size as soon as header is seen
+ * and copies bytes there straight from the input. SET value is the request argument and goes into storage
+ * without further copies. Large bulk strings could be read right into that buffer, see BodyBuffer.
+ */
+class RespParser {
+public:
+    using Request = Parser::Request;
+
+    // Limits on the announced sizes, larger ones are rejected rather than allocated
+    static const std::size_t kMaxBulkSize = Parser::kMaxBodySize;
+    static const std::size_t kMaxArguments = 1024 * 1024;
+
+    RespParser() { Reset(); }
+
+    /**
+     * Parses out every complete command from the given buffer in a single pass and appends them to requests.
+     * Incomplete command at the end of the buffer is kept inside of the parser and will be finished by
+     * following calls. Throws runtime_error if stream is not a RESP one
+     *
+     * @param input buffer to be parsed
+     * @param size number of bytes in the input buffer that could be read
+     * @param requests output parameter, complete requests are appended there
+     * @return number of bytes consumed from the input
+     */
+    std::size_t ParseBatch(const char *input, const size_t size, std::vector<Request> &requests);
+
+    /**
+     * In case if batch parsing stopped in the middle of the bulk string, returns pointer to the place in its
+     * buffer where the rest of the string goes. Returns nullptr if parser doesn't wait for a bulk string.
+     *
+     * @param size output parameter, number of bytes still missing
+     */
+    char *BodyBuffer(std::size_t &size);
+
+    /**
+     * Tells parser that size bytes were written to the buffer returned by BodyBuffer. Once command is
+     * complete request is appended to requests
+     */
+    void BodyReceived(std::size_t size, std::vector<Request> &requests);
+
+    /**
+     * Drops incomplete command if any
+     */
+    void Reset();
+
+private:
+    enum State { sArray, sBulkHeader, sBulk };
+
+    // Reads header line "<prefix><number>\r\n", returns false if line isn't complete yet
+    bool Header(const char *input, std::size_t size, std::size_t &pos, char prefix, int64_t &number);
+
+    // Bulk string is complete: checks its \r\n, builds request if that was the last argument
+    void Complete(std::vector<Request> &requests);
+
+    // Turns complete argument list into the request
+    void Build(std::vector<Request> &requests);
+
+    State state;
+
+    // Header line spanning several reads
+    std::string line;
+
+    // Arguments of the current command, the last one might be incomplete
+    std::vector<std::string> args;
+    std::size_t count;
+
+    // Bytes of the last argument, including \r\n, still missing
+    std::size_t remains;
+};
+
+} // namespace Protocol
+} // namespace Afina
+
+#endif // AFINA_PROTOCOL_RESP_PARSER_H
@@ -0,0 +1,64 @@
+#ifndef AFINA_PROTOCOL_SCANNER_H
+#define AFINA_PROTOCOL_SCANNER_H
+
+#include <cstddef>
+
+#if defined(__SSE2__)
+#include <immintrin.h>
+#endif
+
+namespace Afina {
+namespace Protocol {
+
+/**
+ * Returns position of the first byte equal to a or b in the given buffer, or size if
+ * there is no such byte. Uses AVX2/SSE2 to check 32/16 bytes at once when compiler
+ * targets those instruction sets, the rest is checked byte by byte.
+ *
+ * Used by parser to cut the whole token out of input instead of pushing it byte by byte.
+ */
+inline std::size_t find_any_of(const char *input, std::size_t size, char a, char b) {
+    std::size_t pos = 0;
+
+#if defined(__AVX2__)
+    const __m256i va32 = _mm256_set1_epi8(a);
+    const __m256i vb32 = _mm256_set1_epi8(b);
+    for (; pos + 32 <= size; pos += 32) {
+        __m256i chunk = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(input + pos));
+        unsigned mask = _mm256_movemask_epi8(
+            _mm256_or_si256(_mm256_cmpeq_epi8(chunk, va32), _mm256_cmpeq_epi8(chunk, vb32)));
+        if (mask != 0) {
+            return pos + __builtin_ctz(mask);
+        }
+    }
+#endif
+
+#if defined(__SSE2__)
+    const __m128i va16 = _mm_set1_epi8(a);
+    const __m128i vb16 = _mm_set1_epi8(b);
+    for (; pos + 16 <= size; pos += 16) {
+        __m128i chunk = _mm_loadu_si128(reinterpret_cast<const __m128i *>(input + pos));
+        unsigned mask = _mm_movemask_epi8(_mm_or_si128(_mm_cmpeq_epi8(chunk, va16), _mm_cmpeq_epi8(chunk, vb16)));
+        if (mask != 0) {
+            return pos + __builtin_ctz(mask);
+        }
+    }
+#endif
+
+    for (; pos < size; pos++) {
+        if (input[pos] == a || input[pos] == b) {
+            return pos;
+        }
+    }
+    return size;
+}
+
+/**
+ * Same as above but for the single delimiter
+ */
+inline std::size_t find_first(const char *input, std::size_t size, char a) { return find_any_of(input, size, a, a); }
+
+} // namespace Protocol
+} // namespace Afina
+
+#endif // AFINA_PROTOCOL_SCANNER_H
@@ -0,0 +1,258 @@
+#include "ARC.h"
+
+#include <algorithm>
+#include <chrono>
+
+namespace Afina {
+namespace Backend {
+
+const std::size_t ARC::kMinGhosts;
+
+// See ARC.h
+bool ARC::Put(const std::string &key, const std::string &value) {
+    if (key.size() + value.size() > _max_size) {
+        return false;
+    }
+
+    auto it = Find(key);
+    if (it == _index.end()) {
+        Insert(key, value);
+        return true;
+    }
+
+    // New value lives until it is touched
+    it->second->expire_at = std::chrono::steady_clock::time_point::max();
+    Assign(it->second, value);
+    return true;
+}
+
+// See ARC.h
+bool ARC::PutIfAbsent(const std::string &key, const std::string &value) {
+    if (key.size() + value.size() > _max_size || Find(key) != _index.end()) {
+        return false;
+    }
+
+    Insert(key, value);
+    return true;
+}
+
+// See ARC.h
+bool ARC::Set(const std::string &key, const std::string &value) {
+    if (key.size() + value.size() > _max_size) {
+        return false;
+    }
+
+    auto it = Find(key);
+    if (it == _index.end()) {
+        return false;
+    }
+    Assign(it->second, value);
+    return true;
+}
+
+// See ARC.h
+bool ARC::Delete(const std::string &key) {
+    auto it = Find(key);
+    if (it == _index.end()) {
+        return false;
+    }
+    Remove(it);
+    return true;
+}
+
+// See ARC.h
+bool ARC::Touch(const std::string &key, int64_t ttl) {
+    auto it = Find(key);
+    if (it == _index.end()) {
+        return false;
+    }
+    if (ttl < 0) {
+        Remove(it);
+        return true;
+    }
+
+    if (ttl == 0) {
+        it->second->expire_at = std::chrono::steady_clock::time_point::max();
+    } else {
+        // Deadline is capped, so that time point never overflows: 2^32 seconds is more than a century
+        it->second->expire_at =
+            std::chrono::steady_clock::now() + std::chrono::seconds(std::min<int64_t>(ttl, int64_t(1) << 32));
+    }
+
+    // Touch is a use of the key
+    Touch(it->second);
+    return true;
+}
+
+// See ARC.h
+bool ARC::TimeToLive(const std::string &key, int64_t &ttl) {
+    auto it = Find(key);
+    if (it == _index.end()) {
+        return false;
+    }
+
+    const arc_node &node = *it->second;
+    if (node.expire_at == std::chrono::steady_clock::time_point::max()) {
+        ttl = -1;
+        return true;
+    }
+
+    // Rounded up, so that key which is still alive never reports 0
+    auto left = node.expire_at - std::chrono::steady_clock::now();
+    ttl = (std::chrono::duration_cast<std::chrono::milliseconds>(left).count() + 999) / 1000;
+    return true;
+}
+
+// See ARC.h
+bool ARC::Get(const std::string &key, std::string &value) {
+    auto it = Find(key);
+    if (it == _index.end()) {
+        return false;
+    }
+
+    value = it->second->value;
+    Touch(it->second);
+    return true;
+}
+
+// See ARC.h
+void ARC::GetStats(std::vector<std::pair<std::string, std::string>> &stats) {
+    stats.emplace_back("curr_items", std::to_string(_index.size()));
+    stats.emplace_back("bytes", std::to_string(_t1_size + _t2_size));
+    stats.emplace_back("limit_maxbytes", std::to_string(_max_size));
+    stats.emplace_back("evictions", std::to_string(_evictions));
+    stats.emplace_back("arc_p", std::to_string(_p));
+    stats.emplace_back("arc_t1_items", std::to_string(_t1.size()));
+    stats.emplace_back("arc_t2_items", std::to_string(_t2.size()));
+    stats.emplace_back("arc_b1_items", std::to_string(_b1.size()));
+    stats.emplace_back("arc_b2_items", std::to_string(_b2.size()));
+}
+
+// See ARC.h
+ARC::index_type::iterator ARC::Find(const std::string &key) {
+    auto it = _index.find(key);
+    if (it != _index.end() && Expired(*it->second)) {
+        Remove(it);
+        return _index.end();
+    }
+    return it;
+}
+
+// See ARC.h
+void ARC::Remove(index_type::iterator it) {
+    node_list::iterator node = it->second;
+    ListSize(node->frequent) -= node->size();
+    _index.erase(it);
+    (node->frequent ? _t2 : _t1).erase(node);
+}
+
+// See ARC.h
+void ARC::Assign(node_list::iterator node, const std::string &value) {
+    ListSize(node->frequent) += value.size();
+    ListSize(node->frequent) -= node->value.size();
+    node->value = value;
+
+    Touch(node);
+    Replace(false, &*node);
+}
+
+// See ARC.h
+void ARC::Touch(node_list::iterator node) {
+    if (node->frequent) {
+        _t2.splice(_t2.begin(), _t2, node);
+        return;
+    }
+
+    // Second access: item is frequent from now
+    _t1_size -= node->size();
+    _t2_size += node->size();
+    node->frequent = true;
+    _t2.splice(_t2.begin(), _t1, node);
+}
+
+// See ARC.h
+void ARC::Insert(const std::string &key, const std::string &value) {
+    std::size_t size = key.size() + value.size();
+
+    bool frequent = false;
+    bool ghost_frequent = false;
+
+    auto ghost = _ghosts.find(std::hash<std::string>()(key));
+    if (ghost != _ghosts.end()) {
+        // Key was evicted recently, so the list it was evicted from is too small
+        frequent = true;
+        ghost_frequent = ghost->second.frequent;
+        if (!ghost_frequent) {
+            std::size_t delta = size * std::max<std::size_t>(1, _b2.size() / _b1.size());
+            _p = std::min(_max_size, _p + delta);
+            _b1.erase(ghost->second.position);
+        } else {
+            std::size_t delta = size * std::max<std::size_t>(1, _b1.size() / _b2.size());
+            _p = _p > delta ? _p - delta : 0;
+            _b2.erase(ghost->second.position);
+        }
+        _ghosts.erase(ghost);
+    }
+
+    node_list &list = frequent ? _t2 : _t1;
+    list.emplace_front(key, value);
+    list.front().frequent = frequent;
+    _index.emplace(std::cref(list.front().key), list.begin());
+    ListSize(frequent) += size;
+
+    Replace(ghost_frequent, &list.front());
+    TrimGhosts();
+}
+
+// See ARC.h
+void ARC::Replace(bool ghost_frequent, const arc_node *keep) {
+    while (_t1_size + _t2_size > _max_size) {
+        bool from_t1 = !_t1.empty() && (_t2.empty() || _t1_size > _p || (ghost_frequent && _t1_size == _p));
+
+        // keep is the only item in its list, so other list can't be empty
+        const node_list &list = from_t1 ? _t1 : _t2;
+        if (&list.back() == keep) {
+            from_t1 = !from_t1;
+        }
+        Evict(!from_t1);
+    }
+}
+
+// See ARC.h
+void ARC::Evict(bool frequent) {
+    node_list &list = frequent ? _t2 : _t1;
+    std::list<std::size_t> &ghosts = frequent ? _b2 : _b1;
+
+    arc_node &node = list.back();
+    std::size_t hash = std::hash<std::string>()(node.key);
+
+    // Hash collision, the older ghost is useless anyway
+    auto ghost = _ghosts.find(hash);
+    if (ghost != _ghosts.end()) {
+        (ghost->second.frequent ? _b2 : _b1).erase(ghost->second.position);
+        _ghosts.erase(ghost);
+    }
+
+    ghosts.push_front(hash);
+    _ghosts[hash] = ghost_entry{ghosts.begin(), frequent};
+
+    ListSize(frequent) -= node.size();
+    _index.erase(node.key);
+    list.pop_back();
+    _evictions++;
+}
+
+// See ARC.h
+void ARC::TrimGhosts() {
+    std::size_t limit = std::max(_t1.size() + _t2.size(), kMinGhosts);
+    while (_b1.size() + _b2.size() > limit) {
+        // Same as in original ARC: |T1| + |B1| is bounded first
+        bool from_b1 = !_b1.empty() && (_b2.empty() || _t1.size() + _b1.size() >= limit);
+        std::list<std::size_t> &ghosts = from_b1 ? _b1 : _b2;
+        _ghosts.erase(ghosts.back());
+        ghosts.pop_back();
+    }
+}
+
+} // namespace Backend
+} // namespace Afina
@@ -0,0 +1,147 @@
+#ifndef AFINA_STORAGE_ARC_H
+#define AFINA_STORAGE_ARC_H
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <list>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include <afina/Storage.h>
+
+namespace Afina {
+namespace Backend {
+
+/**
+ * # Adaptive Replacement Cache
+ * Resident items are split into two LRU lists: T1 keeps items seen only once recently
+ * and T2 keeps items seen at least twice. Items evicted from T1/T2 leave a hash of their
+ * key in the ghost lists B1/B2. A hit in a ghost list tells which of resident lists was
+ * too small, so the target size of T1 (_p) is moving towards recency or frequency
+ * depending on the workload.
+ *
+ * Sizes are measured in bytes of keys and values, ghost lists are limited by number of
+ * entries: they never hold more entries than there are resident items.
+ *
+ * Expired items are dropped lazily, once they are looked up, or evicted as any other item.
+ *
+ * That is NOT thread safe implementaiton!!
+ */
+class ARC : public Afina::Storage {
+public:
+    ARC(std::size_t max_size = 1024) : _max_size(max_size), _p(0), _t1_size(0), _t2_size(0), _evictions(0) {}
+    ~ARC() {}
+
+    // Implements Afina::Storage interface
+    bool Put(const std::string &key, const std::string &value) override;
+
+    // Implements Afina::Storage interface
+    bool PutIfAbsent(const std::string &key, const std::string &value) override;
+
+    // Implements Afina::Storage interface
+    bool Set(const std::string &key, const std::string &value) override;
+
+    // Implements Afina::Storage interface
+    bool Delete(const std::string &key) override;
+
+    // Implements Afina::Storage interface
+    bool Touch(const std::string &key, int64_t ttl) override;
+
+    // Implements Afina::Storage interface
+    bool TimeToLive(const std::string &key, int64_t &ttl) override;
+
+    // Implements Afina::Storage interface
+    bool Get(const std::string &key, std::string &value) override;
+
+    // Implements Afina::Storage interface
+    void GetStats(std::vector<std::pair<std::string, std::string>> &stats) override;
+
+private:
+    // Ghost lists never shrink below that number of entries
+    static const std::size_t kMinGhosts = 16;
+
+    struct arc_node {
+        const std::string key;
+        std::string value;
+        bool frequent;
+        std::chrono::steady_clock::time_point expire_at;
+
+        arc_node(const std::string &k, const std::string &v)
+            : key(k), value(v), frequent(false), expire_at(std::chrono::steady_clock::time_point::max()) {}
+        inline std::size_t size() const { return key.size() + value.size(); }
+    };
+
+    using node_list = std::list<arc_node>;
+
+    struct ghost_entry {
+        std::list<std::size_t>::iterator position;
+        bool frequent;
+    };
+
+    struct key_hash {
+        std::size_t operator()(const std::reference_wrapper<const std::string> &key) const {
+            return std::hash<std::string>()(key.get());
+        }
+    };
+
+    using index_type = std::unordered_map<std::reference_wrapper<const std::string>, node_list::iterator, key_hash,
+                                          std::equal_to<std::string>>;
+
+    static bool Expired(const arc_node &node) {
+        return node.expire_at != std::chrono::steady_clock::time_point::max() &&
+               node.expire_at <= std::chrono::steady_clock::now();
+    }
+
+    // Looks resident item up, expired one is removed and not found
+    index_type::iterator Find(const std::string &key);
+
+    // Drops resident item without leaving a ghost
+    void Remove(index_type::iterator it);
+
+    // Replaces value of the resident item, expiration is kept
+    void Assign(node_list::iterator node, const std::string &value);
+
+    // Moves resident item to the MRU end of T2
+    void Touch(node_list::iterator node);
+
+    // Inserts new item, adapts T1 target if key was seen recently
+    void Insert(const std::string &key, const std::string &value);
+
+    // Evicts items until cache fits its limit, keep is never evicted
+    void Replace(bool ghost_frequent, const arc_node *keep);
+
+    // Moves LRU item of the given list to the corresponding ghost list
+    void Evict(bool frequent);
+
+    // Keeps ghost lists in their bounds
+    void TrimGhosts();
+
+    // Updates size counters of the resident lists
+    inline std::size_t &ListSize(bool frequent) { return frequent ? _t2_size : _t1_size; }
+
+    std::size_t _max_size;
+
+    // Target size of T1 in bytes
+    std::size_t _p;
+
+    // Resident items, MRU at the front
+    node_list _t1, _t2;
+    std::size_t _t1_size, _t2_size;
+
+    // Hashes of recently evicted keys, MRU at the front
+    std::list<std::size_t> _b1, _b2;
+
+    index_type _index;
+    std::unordered_map<std::size_t, ghost_entry> _ghosts;
+
+    uint64_t _evictions;
+};
+
+} // namespace Backend
+} // namespace Afina
+
+#endif // AFINA_STORAGE_ARC_H
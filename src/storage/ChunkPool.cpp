@@ -0,0 +1,120 @@
+#include "ChunkPool.h"
+
+#include <algorithm>
+#include <atomic>
+#include <utility>
+
+namespace Afina {
+namespace Backend {
+
+const std::size_t ChunkPool::kChunkSize;
+
+// See ChunkPool.h
+ChunkPool::ChunkPool(std::size_t max_free) : _state(new State()) { _state->max_free = max_free; }
+
+// See ChunkPool.h
+std::shared_ptr<std::string> ChunkPool::Allocate() {
+    std::unique_ptr<std::string> chunk;
+    {
+        std::unique_lock<std::mutex> lock(_state->mutex);
+        if (!_state->free.empty()) {
+            chunk = std::move(_state->free.back());
+            _state->free.pop_back();
+        }
+    }
+
+    if (!chunk) {
+        chunk.reset(new std::string());
+        chunk->reserve(kChunkSize);
+    }
+
+    std::shared_ptr<State> state = _state;
+    return std::shared_ptr<std::string>(chunk.release(), [state](std::string *p) { state->Release(p); });
+}
+
+// See ChunkPool.h
+std::size_t ChunkPool::FreeCount() const {
+    std::unique_lock<std::mutex> lock(_state->mutex);
+    return _state->free.size();
+}
+
+void ChunkPool::State::Release(std::string *chunk) {
+    std::unique_ptr<std::string> ptr(chunk);
+    ptr->clear();
+
+    std::unique_lock<std::mutex> lock(mutex);
+    if (free.size() < max_free) {
+        free.push_back(std::move(ptr));
+    }
+}
+
+// See ChunkPool.h
+void ChunkedValue::Assign(const std::string &data, ChunkPool &pool) {
+    _chunks.clear();
+    _size = 0;
+
+    // Small values doesn't worth a whole chunk
+    if (data.size() <= ChunkPool::kChunkSize) {
+        _chunks.push_back(std::make_shared<std::string>(data));
+        _size = data.size();
+        return;
+    }
+
+    Append(data, pool);
+}
+
+// See ChunkPool.h
+void ChunkedValue::Assign(std::string &&data) {
+    _chunks.clear();
+    _size = data.size();
+    _chunks.push_back(std::make_shared<std::string>(std::move(data)));
+}
+
+// See ChunkPool.h
+void ChunkedValue::Append(const std::string &data, ChunkPool &pool) {
+    std::size_t offset = 0;
+
+    // Fill the tail of the last chunk first
+    if (!_chunks.empty() && _chunks.back()->size() < ChunkPool::kChunkSize) {
+        std::shared_ptr<std::string> &last = _chunks.back();
+        if (last.use_count() > 1) {
+            // Somebody still reads it, so chunk must not be changed
+            std::shared_ptr<std::string> copy = pool.Allocate();
+            copy->assign(*last);
+            last = copy;
+        } else {
+            // Pairs with release of the last reader's reference
+            std::atomic_thread_fence(std::memory_order_acquire);
+        }
+
+        offset = std::min(ChunkPool::kChunkSize - last->size(), data.size());
+        last->append(data, 0, offset);
+    }
+
+    while (offset < data.size()) {
+        std::size_t n = std::min(ChunkPool::kChunkSize, data.size() - offset);
+        std::shared_ptr<std::string> chunk = pool.Allocate();
+        chunk->assign(data, offset, n);
+        _chunks.push_back(std::move(chunk));
+        offset += n;
+    }
+
+    _size += data.size();
+}
+
+// See ChunkPool.h
+void ChunkedValue::CopyTo(std::string &out) const {
+    out.clear();
+    out.reserve(_size);
+    for (auto &chunk : _chunks) {
+        out.append(*chunk);
+    }
+}
+
+// See ChunkPool.h
+void ChunkedValue::ShareTo(std::vector<std::shared_ptr<const std::string>> &out) const {
+    out.insert(out.end(), _chunks.begin(), _chunks.end());
+}
+
+} // namespace Backend
+} // namespace Afina
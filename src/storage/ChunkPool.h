@@ -0,0 +1,107 @@
+#ifndef AFINA_STORAGE_CHUNK_POOL_H
+#define AFINA_STORAGE_CHUNK_POOL_H
+
+#include <cstddef>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+namespace Afina {
+namespace Backend {
+
+/**
+ * # Pool of fixed size value chunks
+ * Large values are stored as a chain of chunks of kChunkSize bytes, chunks released by
+ * storage (or by the last reader still holding it) go back to the pool and get reused
+ * for the next large value instead of being returned to the allocator.
+ *
+ * Chunks could be released from any thread.
+ */
+class ChunkPool {
+public:
+    // Capacity of each pooled chunk
+    static const std::size_t kChunkSize = 16 * 1024;
+
+    /**
+     * @param max_free maximum number of released chunks kept for reuse, chunks above
+     * the limit are returned to the allocator
+     */
+    ChunkPool(std::size_t max_free = 1024);
+    ~ChunkPool() {}
+
+    /**
+     * Returns empty chunk with capacity of kChunkSize. Once all references to the chunk
+     * are gone it returns back to the pool
+     */
+    std::shared_ptr<std::string> Allocate();
+
+    /**
+     * Number of chunks waiting for reuse
+     */
+    std::size_t FreeCount() const;
+
+private:
+    ChunkPool(const ChunkPool &) = delete;
+    ChunkPool &operator=(const ChunkPool &) = delete;
+
+    // Pool internals are shared with chunk deleters, so chunks could outlive the pool itself
+    struct State {
+        std::mutex mutex;
+        std::size_t max_free;
+        std::vector<std::unique_ptr<std::string>> free;
+
+        void Release(std::string *chunk);
+    };
+
+    std::shared_ptr<State> _state;
+};
+
+/**
+ * # Value stored as a sequence of chunks
+ * Values not larger than ChunkPool::kChunkSize are kept in a single chunk of exact size,
+ * larger ones are split into pooled chunks. Chunks are shared with readers, so value is
+ * never changed in place while there is anybody still reading it.
+ */
+class ChunkedValue {
+public:
+    ChunkedValue() : _size(0) {}
+
+    inline std::size_t size() const { return _size; }
+
+    /**
+     * Replace value content by the given data
+     */
+    void Assign(const std::string &data, ChunkPool &pool);
+
+    /**
+     * Replace value content by the given buffer, which becomes the single chunk of value
+     * whatever its size is
+     */
+    void Assign(std::string &&data);
+
+    /**
+     * Adds data to the end of value, only the last chunk could be copied in case if
+     * it is still referenced by some reader
+     */
+    void Append(const std::string &data, ChunkPool &pool);
+
+    /**
+     * Copy value into the contiguous buffer
+     */
+    void CopyTo(std::string &out) const;
+
+    /**
+     * Shares value chunks with the caller
+     */
+    void ShareTo(std::vector<std::shared_ptr<const std::string>> &out) const;
+
+private:
+    std::vector<std::shared_ptr<std::string>> _chunks;
+    std::size_t _size;
+};
+
+} // namespace Backend
+} // namespace Afina
+
+#endif // AFINA_STORAGE_CHUNK_POOL_H
@@ -0,0 +1,341 @@
+#include "ConcurrentHash.h"
+
+#include <algorithm>
+#include <chrono>
+#include <functional>
+#include <thread>
+
+namespace Afina {
+namespace Backend {
+
+namespace {
+
+// Access time is updated not more often than that, so hot items don't make readers
+// to write the same cache line all the time
+const uint64_t kAccessGranularity = 1000; // microseconds
+
+// Cheap per-thread random numbers to pick eviction samples
+uint64_t next_random() {
+    static thread_local uint64_t state =
+        std::hash<std::thread::id>()(std::this_thread::get_id()) | 1;
+    state ^= state << 13;
+    state ^= state >> 7;
+    state ^= state << 17;
+    return state;
+}
+
+} // namespace
+
+const std::size_t ConcurrentHash::kEvictionSamples;
+
+// See ConcurrentHash.h
+ConcurrentHash::ConcurrentHash(std::size_t max_size, std::size_t buckets)
+    : _max_size(max_size), _size(0), _items(0), _evictions(0) {
+    if (buckets == 0) {
+        buckets = max_size / 64;
+    }
+
+    std::size_t count = 16;
+    while (count < buckets) {
+        count <<= 1;
+    }
+
+    _mask = count - 1;
+    _buckets.reset(new std::atomic<node *>[count]);
+    for (std::size_t i = 0; i < count; i++) {
+        _buckets[i].store(nullptr, std::memory_order_relaxed);
+    }
+}
+
+// See ConcurrentHash.h
+ConcurrentHash::~ConcurrentHash() {
+    for (std::size_t i = 0; i <= _mask; i++) {
+        node *n = _buckets[i].load(std::memory_order_relaxed);
+        while (n != nullptr) {
+            node *next = n->next;
+            delete n;
+            n = next;
+        }
+    }
+}
+
+// See ConcurrentHash.h
+bool ConcurrentHash::Put(const std::string &key, const std::string &value) { return Modify(Mode::kPut, key, &value); }
+
+// See ConcurrentHash.h
+bool ConcurrentHash::PutIfAbsent(const std::string &key, const std::string &value) {
+    return Modify(Mode::kInsert, key, &value);
+}
+
+// See ConcurrentHash.h
+bool ConcurrentHash::Set(const std::string &key, const std::string &value) {
+    return Modify(Mode::kUpdate, key, &value);
+}
+
+// See ConcurrentHash.h
+bool ConcurrentHash::Delete(const std::string &key) { return Modify(Mode::kDelete, key, nullptr); }
+
+// See ConcurrentHash.h
+bool ConcurrentHash::Touch(const std::string &key, int64_t ttl) {
+    if (ttl < 0) {
+        return Delete(key);
+    }
+
+    // Deadline is capped, so that it never overflows: 2^32 seconds is more than a century
+    uint64_t expire = (ttl == 0) ? 0 : Now() + uint64_t(std::min<int64_t>(ttl, int64_t(1) << 32)) * 1000000;
+    return Modify(Mode::kTouch, key, nullptr, nullptr, expire);
+}
+
+// See ConcurrentHash.h
+bool ConcurrentHash::TimeToLive(const std::string &key, int64_t &ttl) {
+    std::size_t hash = std::hash<std::string>()(key);
+    Concurrency::EpochManager::Guard guard(_epoch);
+
+    for (node *n = Bucket(hash).load(std::memory_order_acquire); n != nullptr; n = n->next) {
+        if (n->hash == hash && n->key == key) {
+            uint64_t now = Now();
+            if (n->expired(now)) {
+                return false;
+            }
+
+            // Rounded up, so that key which is still alive never reports 0
+            ttl = (n->expire_at == 0) ? -1 : int64_t((n->expire_at - now + 999999) / 1000000);
+            return true;
+        }
+    }
+    return false;
+}
+
+// See ConcurrentHash.h
+bool ConcurrentHash::Get(const std::string &key, std::string &value) {
+    std::size_t hash = std::hash<std::string>()(key);
+    Concurrency::EpochManager::Guard guard(_epoch);
+
+    for (node *n = Bucket(hash).load(std::memory_order_acquire); n != nullptr; n = n->next) {
+        if (n->hash == hash && n->key == key) {
+            uint64_t now = Now();
+            if (n->expired(now)) {
+                return false;
+            }
+            value = n->value;
+
+            if (now - n->last_access.load(std::memory_order_relaxed) > kAccessGranularity) {
+                n->last_access.store(now, std::memory_order_relaxed);
+            }
+            return true;
+        }
+    }
+    return false;
+}
+
+// See ConcurrentHash.h
+bool ConcurrentHash::Update(const std::string &key, const Updater &update) {
+    return Modify(Mode::kCompute, key, nullptr, &update);
+}
+
+// See ConcurrentHash.h
+bool ConcurrentHash::Append(const std::string &key, const std::string &value) {
+    return Update(key, [&value](bool present, std::string &current) {
+        current += value;
+        return present;
+    });
+}
+
+// See ConcurrentHash.h
+bool ConcurrentHash::Prepend(const std::string &key, const std::string &value) {
+    return Update(key, [&value](bool present, std::string &current) {
+        current.insert(0, value);
+        return present;
+    });
+}
+
+// See ConcurrentHash.h
+void ConcurrentHash::GetStats(std::vector<std::pair<std::string, std::string>> &stats) {
+    stats.emplace_back("curr_items", std::to_string(_items.load(std::memory_order_relaxed)));
+    stats.emplace_back("bytes", std::to_string(_size.load(std::memory_order_relaxed)));
+    stats.emplace_back("limit_maxbytes", std::to_string(_max_size));
+    stats.emplace_back("evictions", std::to_string(_evictions.load(std::memory_order_relaxed)));
+    stats.emplace_back("hash_buckets", std::to_string(_mask + 1));
+}
+
+// See ConcurrentHash.h
+bool ConcurrentHash::Modify(Mode mode, const std::string &key, const std::string *value, const Updater *update,
+                            uint64_t expire) {
+    if (value != nullptr && key.size() + value->size() > _max_size) {
+        return false;
+    }
+
+    std::size_t hash = std::hash<std::string>()(key);
+    std::atomic<node *> &bucket = Bucket(hash);
+    Concurrency::EpochManager::Guard guard(_epoch);
+
+    for (;;) {
+        node *head = bucket.load(std::memory_order_acquire);
+        node *target = head;
+        while (target != nullptr && !(target->hash == hash && target->key == key)) {
+            target = target->next;
+        }
+
+        // Expired node is still there until it is replaced, but for the client key is gone
+        uint64_t now = Now();
+        bool live = (target != nullptr && !target->expired(now));
+        if ((!live && (mode == Mode::kUpdate || mode == Mode::kDelete || mode == Mode::kTouch)) ||
+            (live && mode == Mode::kInsert)) {
+            return false;
+        }
+
+        // New value is computed out of the node that is about to be replaced, every retry computes it again
+        std::string computed;
+        if (mode == Mode::kCompute) {
+            if (live) {
+                computed = target->value;
+            }
+            if (!(*update)(live, computed) || key.size() + computed.size() > _max_size) {
+                return false;
+            }
+            value = &computed;
+        } else if (mode == Mode::kTouch) {
+            value = &target->value;
+        }
+
+        // Put starts a new life of the key, set and update keep expiration it has
+        uint64_t expire_at = 0;
+        if (mode == Mode::kTouch) {
+            expire_at = expire;
+        } else if (live && mode != Mode::kPut) {
+            expire_at = target->expire_at;
+        }
+
+        node *new_head;
+        int64_t size_delta, items_delta;
+        if (target == nullptr) {
+            // New key goes to the head, nothing has to be copied
+            new_head = new node(hash, key, *value, now, expire_at, head);
+            size_delta = new_head->size();
+            items_delta = 1;
+        } else if (mode == Mode::kDelete) {
+            new_head = CopyPrefix(head, target, target->next);
+            size_delta = -int64_t(target->size());
+            items_delta = -1;
+        } else {
+            node *replacement = new node(hash, key, *value, now, expire_at, target->next);
+            new_head = CopyPrefix(head, target, replacement);
+            size_delta = int64_t(replacement->size()) - int64_t(target->size());
+            items_delta = 0;
+        }
+
+        if (Publish(bucket, head, new_head, target)) {
+            _size.fetch_add(size_delta, std::memory_order_relaxed);
+            _items.fetch_add(items_delta, std::memory_order_relaxed);
+            break;
+        }
+    }
+
+    if (mode != Mode::kDelete) {
+        Evict();
+    }
+    return true;
+}
+
+// See ConcurrentHash.h
+bool ConcurrentHash::Remove(std::atomic<node *> &bucket, node *victim) {
+    for (;;) {
+        node *head = bucket.load(std::memory_order_acquire);
+        node *target = head;
+        while (target != nullptr && target != victim) {
+            target = target->next;
+        }
+
+        // Somebody else has already changed it
+        if (target == nullptr) {
+            return false;
+        }
+
+        if (Publish(bucket, head, CopyPrefix(head, target, target->next), target)) {
+            _size.fetch_sub(target->size(), std::memory_order_relaxed);
+            _items.fetch_sub(1, std::memory_order_relaxed);
+            return true;
+        }
+    }
+}
+
+// See ConcurrentHash.h
+ConcurrentHash::node *ConcurrentHash::CopyPrefix(node *head, node *target, node *tail) {
+    node *new_head = tail;
+    node **link = &new_head;
+    for (node *n = head; n != target; n = n->next) {
+        node *copy =
+            new node(n->hash, n->key, n->value, n->last_access.load(std::memory_order_relaxed), n->expire_at, tail);
+        *link = copy;
+        link = &copy->next;
+    }
+    return new_head;
+}
+
+// See ConcurrentHash.h
+bool ConcurrentHash::Publish(std::atomic<node *> &bucket, node *old_head, node *new_head, node *target) {
+    // New version shares everything after the target (or the whole old list in case of insert)
+    node *shared = (target != nullptr) ? target->next : old_head;
+
+    if (bucket.compare_exchange_strong(old_head, new_head, std::memory_order_acq_rel, std::memory_order_acquire)) {
+        if (target != nullptr) {
+            for (node *n = old_head; n != shared;) {
+                node *next = n->next;
+                _epoch.Retire(n);
+                n = next;
+            }
+        }
+        return true;
+    }
+
+    // Nobody has seen new nodes yet
+    for (node *n = new_head; n != shared;) {
+        node *next = n->next;
+        delete n;
+        n = next;
+    }
+    return false;
+}
+
+// See ConcurrentHash.h
+void ConcurrentHash::Evict() {
+    for (int attempt = 0; attempt < 16 && _size.load(std::memory_order_relaxed) > int64_t(_max_size); attempt++) {
+        node *oldest = nullptr;
+        uint64_t oldest_access = 0;
+        std::atomic<node *> *oldest_bucket = nullptr;
+
+        // Expired items go first, as if they were never used
+        uint64_t now = Now();
+        std::size_t sampled = 0;
+        for (std::size_t probe = 0; sampled < kEvictionSamples && probe < 16 * kEvictionSamples; probe++) {
+            std::atomic<node *> &bucket = _buckets[next_random() & _mask];
+            for (node *n = bucket.load(std::memory_order_acquire); n != nullptr && sampled < kEvictionSamples;
+                 n = n->next) {
+                sampled++;
+                uint64_t access = n->expired(now) ? 0 : n->last_access.load(std::memory_order_relaxed);
+                if (oldest == nullptr || access < oldest_access) {
+                    oldest_access = access;
+                    oldest = n;
+                    oldest_bucket = &bucket;
+                }
+            }
+        }
+
+        if (oldest == nullptr) {
+            return;
+        }
+
+        if (Remove(*oldest_bucket, oldest)) {
+            _evictions.fetch_add(1, std::memory_order_relaxed);
+        }
+    }
+}
+
+// See ConcurrentHash.h
+uint64_t ConcurrentHash::Now() {
+    return std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now().time_since_epoch())
+        .count();
+}
+
+} // namespace Backend
+} // namespace Afina
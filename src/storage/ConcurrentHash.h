@@ -0,0 +1,141 @@
+#ifndef AFINA_STORAGE_CONCURRENT_HASH_H
+#define AFINA_STORAGE_CONCURRENT_HASH_H
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include <afina/Storage.h>
+#include <afina/concurrency/Epoch.h>
+
+namespace Afina {
+namespace Backend {
+
+/**
+ * # Lock-free hash table
+ * Storage for pure key-value usage where approximate eviction is fine. There is no global
+ * usage order: each item remembers time of last access and once storage gets over its limit
+ * the oldest of kEvictionSamples randomly picked items is evicted (like Redis does).
+ *
+ * Each bucket is a singly linked list of immutable nodes. Writers build a new version of
+ * the list prefix up to the changed node (the rest of the list is shared) and publish it by
+ * CAS on the bucket head, replaced nodes are reclaimed by epoch based reclamation. Readers
+ * never lock or write anything except relaxed update of access time.
+ *
+ * Number of buckets is fixed at construction time.
+ *
+ * Expiration time is a part of the immutable node, so touch replaces the node as any other write. Expired
+ * nodes are never found, they are taken first by eviction or replaced by the next write of the key.
+ */
+class ConcurrentHash final : public Afina::Storage {
+public:
+    // Number of items examined to choose eviction victim
+    static const std::size_t kEvictionSamples = 5;
+
+    /**
+     * @param max_size maximum number of bytes in all keys and values
+     * @param buckets number of buckets, rounded up to the power of two. By default
+     * chosen as if average item takes 64 bytes
+     */
+    ConcurrentHash(std::size_t max_size = 1024, std::size_t buckets = 0);
+    ~ConcurrentHash();
+
+    // Implements Afina::Storage interface
+    bool Put(const std::string &key, const std::string &value) override;
+
+    // Implements Afina::Storage interface
+    bool PutIfAbsent(const std::string &key, const std::string &value) override;
+
+    // Implements Afina::Storage interface
+    bool Set(const std::string &key, const std::string &value) override;
+
+    // Implements Afina::Storage interface
+    bool Delete(const std::string &key) override;
+
+    // Implements Afina::Storage interface
+    bool Touch(const std::string &key, int64_t ttl) override;
+
+    // Implements Afina::Storage interface
+    bool TimeToLive(const std::string &key, int64_t &ttl) override;
+
+    // Implements Afina::Storage interface
+    bool Get(const std::string &key, std::string &value) override;
+
+    // Value is computed out of the node CAS replaces, so it is retried along with CAS
+    bool Update(const std::string &key, const Updater &update) override;
+
+    // Appended value is computed by Update, so concurrent appends never lose each other
+    bool Append(const std::string &key, const std::string &value) override;
+
+    // Same as Append
+    bool Prepend(const std::string &key, const std::string &value) override;
+
+    // Implements Afina::Storage interface
+    void GetStats(std::vector<std::pair<std::string, std::string>> &stats) override;
+
+private:
+    ConcurrentHash(const ConcurrentHash &) = delete;
+    ConcurrentHash &operator=(const ConcurrentHash &) = delete;
+
+    struct node {
+        const std::size_t hash;
+        const std::string key;
+        const std::string value;
+        std::atomic<uint64_t> last_access;
+
+        // Time node expires at in microseconds of Now, 0 if it never does
+        const uint64_t expire_at;
+
+        // Immutable once node is published
+        node *next;
+
+        node(std::size_t h, const std::string &k, const std::string &v, uint64_t access, uint64_t expire, node *n)
+            : hash(h), key(k), value(v), last_access(access), expire_at(expire), next(n) {}
+
+        inline std::size_t size() const { return key.size() + value.size(); }
+        inline bool expired(uint64_t now) const { return expire_at != 0 && expire_at <= now; }
+    };
+
+    enum class Mode { kPut, kInsert, kUpdate, kDelete, kCompute, kTouch };
+
+    // Applies modification to the bucket, returns false if precondition of the mode wasn't met. Compute takes
+    // value from the updater instead, touch keeps value and sets expiration time to expire
+    bool Modify(Mode mode, const std::string &key, const std::string *value, const Updater *update = nullptr,
+                uint64_t expire = 0);
+
+    // Removes exactly the given node if it is still in the bucket
+    bool Remove(std::atomic<node *> &bucket, node *victim);
+
+    // Builds copy of the list prefix before target linked to the tail, returns new head
+    node *CopyPrefix(node *head, node *target, node *tail);
+
+    // Publishes new head in place of old one, on success retires replaced nodes and on failure
+    // frees unpublished copies
+    bool Publish(std::atomic<node *> &bucket, node *old_head, node *new_head, node *target);
+
+    // Evicts items until storage fits its limit
+    void Evict();
+
+    std::atomic<node *> &Bucket(std::size_t hash) { return _buckets[hash & _mask]; }
+
+    static uint64_t Now();
+
+    const std::size_t _max_size;
+    std::size_t _mask;
+    std::unique_ptr<std::atomic<node *>[]> _buckets;
+
+    std::atomic<int64_t> _size;
+    std::atomic<int64_t> _items;
+    std::atomic<uint64_t> _evictions;
+
+    Concurrency::EpochManager _epoch;
+};
+
+} // namespace Backend
+} // namespace Afina
+
+#endif // AFINA_STORAGE_CONCURRENT_HASH_H
@@ -0,0 +1,279 @@
+#include "FileTier.h"
+
+#include <algorithm>
+#include <cerrno>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <functional>
+#include <stdexcept>
+
+#include <fcntl.h>
+#include <limits.h>
+#include <sys/stat.h>
+#include <sys/types.h>
+#include <sys/uio.h>
+#include <unistd.h>
+
+namespace Afina {
+namespace Backend {
+
+namespace {
+
+// Reads exactly size bytes, returns false on error or short read
+bool pread_full(int fd, char *buf, std::size_t size, uint64_t offset) {
+    while (size > 0) {
+        ssize_t n = pread(fd, buf, size, offset);
+        if (n < 0 && errno == EINTR) {
+            continue;
+        } else if (n <= 0) {
+            return false;
+        }
+        buf += n;
+        size -= n;
+        offset += n;
+    }
+    return true;
+}
+
+// Writes all the given vector, returns false on error
+bool pwritev_full(int fd, std::vector<struct iovec> &iov, uint64_t offset) {
+    std::size_t first = 0;
+    while (first < iov.size()) {
+        ssize_t n = pwritev(fd, &iov[first], std::min<std::size_t>(iov.size() - first, IOV_MAX), offset);
+        if (n < 0 && errno == EINTR) {
+            continue;
+        } else if (n <= 0) {
+            return false;
+        }
+
+        offset += n;
+        while (first < iov.size() && std::size_t(n) >= iov[first].iov_len) {
+            n -= iov[first].iov_len;
+            first++;
+        }
+        if (first < iov.size()) {
+            iov[first].iov_base = static_cast<char *>(iov[first].iov_base) + n;
+            iov[first].iov_len -= n;
+        }
+    }
+    return true;
+}
+
+} // namespace
+
+// See FileTier.h
+FileTier::FileTier(const std::string &path, std::size_t max_size)
+    : _path(path), _max_size(max_size), _end(0), _garbage(0), _hits(0), _misses(0), _writes(0), _evictions(0),
+      _compactions(0), _read_ns(0) {
+    _fd = open(_path.c_str(), O_RDWR | O_CREAT | O_TRUNC | O_CLOEXEC, 0600);
+    if (_fd == -1) {
+        throw std::runtime_error("Failed to open tier file " + _path + ": " + std::string(strerror(errno)));
+    }
+}
+
+// See FileTier.h
+FileTier::~FileTier() {
+    close(_fd);
+    unlink(_path.c_str());
+}
+
+// See FileTier.h
+bool FileTier::Put(const std::string &key, const std::vector<std::shared_ptr<const std::string>> &value) {
+    Header header;
+    header.key_size = key.size();
+    header.value_size = 0;
+    for (auto &chunk : value) {
+        header.value_size += chunk->size();
+    }
+
+    Entry entry;
+    entry.key_size = header.key_size;
+    entry.value_size = header.value_size;
+    if (entry.size() > _max_size) {
+        return false;
+    }
+
+    // Previous version of the item is dead anyway
+    auto it = _index.find(std::hash<std::string>()(key));
+    if (it != _index.end()) {
+        Forget(it);
+    }
+
+    if (_end + entry.size() > _max_size && !Compact(entry.size())) {
+        return false;
+    }
+
+    std::vector<struct iovec> iov;
+    iov.reserve(value.size() + 2);
+    iov.push_back({&header, sizeof(header)});
+    iov.push_back({const_cast<char *>(key.data()), key.size()});
+    for (auto &chunk : value) {
+        iov.push_back({const_cast<char *>(chunk->data()), chunk->size()});
+    }
+
+    entry.offset = _end;
+    if (!pwritev_full(_fd, iov, _end)) {
+        return false;
+    }
+
+    _end += entry.size();
+    _index[std::hash<std::string>()(key)] = entry;
+    _writes++;
+    return true;
+}
+
+// See FileTier.h
+bool FileTier::Take(const std::string &key, std::string &value) {
+    auto start = std::chrono::steady_clock::now();
+
+    auto it = Find(key);
+    if (it == _index.end()) {
+        _misses++;
+        return false;
+    }
+
+    const Entry &entry = it->second;
+    std::string result(entry.value_size, '\0');
+    if (!pread_full(_fd, &result[0], entry.value_size, entry.offset + sizeof(Header) + entry.key_size)) {
+        Forget(it);
+        _misses++;
+        return false;
+    }
+
+    value.swap(result);
+    Forget(it);
+
+    _hits++;
+    _read_ns += std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start).count();
+    return true;
+}
+
+// See FileTier.h
+bool FileTier::Contains(const std::string &key) { return Find(key) != _index.end(); }
+
+// See FileTier.h
+bool FileTier::Delete(const std::string &key) {
+    auto it = Find(key);
+    if (it == _index.end()) {
+        return false;
+    }
+    Forget(it);
+    return true;
+}
+
+// See FileTier.h
+void FileTier::Clear() {
+    _index.clear();
+    _end = 0;
+    _garbage = 0;
+    if (ftruncate(_fd, 0) != 0) {
+        throw std::runtime_error("Failed to truncate tier file " + _path + ": " + std::string(strerror(errno)));
+    }
+}
+
+// See FileTier.h
+void FileTier::GetStats(std::vector<std::pair<std::string, std::string>> &stats) const {
+    stats.emplace_back("tier2_items", std::to_string(_index.size()));
+    stats.emplace_back("tier2_bytes", std::to_string(_end - _garbage));
+    stats.emplace_back("tier2_file_bytes", std::to_string(_end));
+    stats.emplace_back("tier2_limit_bytes", std::to_string(_max_size));
+    stats.emplace_back("tier2_hits", std::to_string(_hits));
+    stats.emplace_back("tier2_misses", std::to_string(_misses));
+    stats.emplace_back("tier2_writes", std::to_string(_writes));
+    stats.emplace_back("tier2_evictions", std::to_string(_evictions));
+    stats.emplace_back("tier2_compactions", std::to_string(_compactions));
+    stats.emplace_back("tier2_read_avg_ns", std::to_string(_hits > 0 ? _read_ns / _hits : 0));
+}
+
+// See FileTier.h
+FileTier::index_type::iterator FileTier::Find(const std::string &key) {
+    auto it = _index.find(std::hash<std::string>()(key));
+    if (it == _index.end() || it->second.key_size != key.size()) {
+        return _index.end();
+    }
+
+    std::string stored(key.size(), '\0');
+    if (!pread_full(_fd, &stored[0], stored.size(), it->second.offset + sizeof(Header)) || stored != key) {
+        return _index.end();
+    }
+    return it;
+}
+
+// See FileTier.h
+void FileTier::Forget(index_type::iterator it) {
+    _garbage += it->second.size();
+    _index.erase(it);
+}
+
+// See FileTier.h
+bool FileTier::Compact(std::size_t incoming) {
+    // Live records in log order, the oldest first
+    std::vector<std::pair<uint64_t, std::size_t>> live;
+    live.reserve(_index.size());
+    uint64_t live_bytes = 0;
+    for (auto &it : _index) {
+        live.emplace_back(it.second.offset, it.first);
+        live_bytes += it.second.size();
+    }
+    std::sort(live.begin(), live.end());
+
+    // Besides the incoming record leave some free space, so that compaction doesn't
+    // happen on each write
+    std::size_t target = _max_size - incoming;
+    target -= std::min<std::size_t>(target, _max_size / 4);
+
+    std::size_t first = 0;
+    for (; first < live.size() && live_bytes > target; first++) {
+        live_bytes -= _index.find(live[first].second)->second.size();
+    }
+
+    // Index is left untouched until the new log replaces the old one, so failed compaction loses nothing
+    std::string tmp_path = _path + ".compact";
+    int fd = open(tmp_path.c_str(), O_RDWR | O_CREAT | O_TRUNC | O_CLOEXEC, 0600);
+    if (fd == -1) {
+        return false;
+    }
+
+    // New offset of each live record, records that failed to copy are dropped
+    const uint64_t lost = UINT64_MAX;
+    std::vector<uint64_t> offsets(live.size(), lost);
+    uint64_t end = 0;
+    std::string buffer;
+    for (std::size_t i = first; i < live.size(); i++) {
+        const Entry &entry = _index.find(live[i].second)->second;
+
+        buffer.resize(entry.size());
+        std::vector<struct iovec> iov(1, {&buffer[0], buffer.size()});
+        if (pread_full(_fd, &buffer[0], buffer.size(), entry.offset) && pwritev_full(fd, iov, end)) {
+            offsets[i] = end;
+            end += entry.size();
+        }
+    }
+
+    if (rename(tmp_path.c_str(), _path.c_str()) == -1) {
+        close(fd);
+        unlink(tmp_path.c_str());
+        return false;
+    }
+
+    for (std::size_t i = 0; i < live.size(); i++) {
+        auto it = _index.find(live[i].second);
+        if (offsets[i] == lost) {
+            _index.erase(it);
+            _evictions++;
+        } else {
+            it->second.offset = offsets[i];
+        }
+    }
+
+    close(_fd);
+    _fd = fd;
+    _end = end;
+    _garbage = 0;
+    _compactions++;
+    return true;
+}
+
+} // namespace Backend
+} // namespace Afina
@@ -0,0 +1,125 @@
+#ifndef AFINA_STORAGE_FILE_TIER_H
+#define AFINA_STORAGE_FILE_TIER_H
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+namespace Afina {
+namespace Backend {
+
+/**
+ * # Second storage tier on the local file
+ * Receives items evicted from memory and serves them back on memory misses. Items are
+ * written into append only log file, memory keeps only a compact index: hash of the key
+ * to the record position. Key is verified on read, so hash collision just turns into a miss.
+ *
+ * Once log reaches its size limit, tier compacts: live records are copied into a new log
+ * and the oldest of them are dropped to free space for new ones. Content of the file
+ * doesn't survive restart.
+ *
+ * That is NOT thread safe implementaiton!!
+ */
+class FileTier {
+public:
+    /**
+     * Opens (and truncates) log file
+     *
+     * @param path to the log file
+     * @param max_size maximum size of the log file in bytes
+     */
+    FileTier(const std::string &path, std::size_t max_size);
+    ~FileTier();
+
+    /**
+     * Stores item in the tier, previous record for the key (if any) becomes garbage. Returns false
+     * if item is too large or write (or compaction that makes room for it) has failed
+     */
+    bool Put(const std::string &key, const std::vector<std::shared_ptr<const std::string>> &value);
+
+    /**
+     * Moves item out of the tier: if key found then value read into output parameter, record
+     * removed and method returns true
+     */
+    bool Take(const std::string &key, std::string &value);
+
+    /**
+     * Checks if there is a record for the given key
+     */
+    bool Contains(const std::string &key);
+
+    /**
+     * Removes record for the given key, returns false if there was no such key
+     */
+    bool Delete(const std::string &key);
+
+    /**
+     * Drops all records, log file is truncated
+     */
+    void Clear();
+
+    /**
+     * Appends tier statistics in form of name/value pairs
+     */
+    void GetStats(std::vector<std::pair<std::string, std::string>> &stats) const;
+
+private:
+    FileTier(const FileTier &) = delete;
+    FileTier &operator=(const FileTier &) = delete;
+
+    // Record on disk is a header followed by key and value bytes
+    struct Header {
+        uint32_t key_size;
+        uint32_t value_size;
+    };
+
+    // Position of the record in the log
+    struct Entry {
+        uint64_t offset;
+        uint32_t key_size;
+        uint32_t value_size;
+
+        inline std::size_t size() const { return sizeof(Header) + key_size + value_size; }
+    };
+
+    using index_type = std::unordered_map<std::size_t, Entry>;
+
+    // Looks for the entry of the given key, verifies key stored in the record
+    index_type::iterator Find(const std::string &key);
+
+    // Drops index entry, record becomes garbage
+    void Forget(index_type::iterator it);
+
+    // Rewrites log leaving enough space for a record of given size. Returns false if new log can't be written,
+    // tier is left as it was then
+    bool Compact(std::size_t incoming);
+
+    std::string _path;
+    std::size_t _max_size;
+    int _fd;
+
+    // Offset of log end, where the next record goes
+    uint64_t _end;
+
+    // Number of bytes occupied by dead records
+    uint64_t _garbage;
+
+    index_type _index;
+
+    // Statistics
+    uint64_t _hits;
+    uint64_t _misses;
+    uint64_t _writes;
+    uint64_t _evictions;
+    uint64_t _compactions;
+    uint64_t _read_ns;
+};
+
+} // namespace Backend
+} // namespace Afina
+
+#endif // AFINA_STORAGE_FILE_TIER_H
@@ -1,5 +1,9 @@
 #include "SimpleLRU.h"
 
+#include <algorithm>
+#include <chrono>
+#include <utility>
+
 namespace Afina {
 namespace Backend {
 
@@ -8,6 +12,16 @@ void SimpleLRU::ClearFromEnd(const std::size_t size_of_new)
 {
     while (size_of_new > _max_size - _current_size)
     {
+        // вытесняемый элемент переезжает на второй уровень, если он есть; на втором уровне
+        // сроков жизни нет, поэтому элементы со сроком туда не попадают
+        if (_second_tier && _last_node->expire_at == std::chrono::steady_clock::time_point::max())
+        {
+            std::vector<ValueChunk> chunks;
+            _last_node->value.ShareTo(chunks);
+            _second_tier->Put(_last_node->key, chunks);
+        }
+        _evictions++;
+
         if (_last_node->next)
         {
             _lru_index.erase(_last_node->key);
@@ -92,22 +106,60 @@ bool SimpleLRU::Put(const std::string &key, const std::string &value)
 
     bool result = false;
 
-    auto key_iterator = _lru_index.find(key);
+    auto key_iterator = Find(key);
 
     // вызываем PutIfAbsent или Set в зависимости от того,
     // есть ли нужный ключ в двусвязном списке
     if (key_iterator == _lru_index.end())
     {
+        // старое значение могло быть вытеснено на второй уровень
+        if (_second_tier)
+        {
+            _second_tier->Delete(key);
+        }
         result = PutIfAbsent(key, value, key_iterator);
     }
     else
     {
+        // новое значение начинает жить бессрочно
+        key_iterator->second.get().expire_at = std::chrono::steady_clock::time_point::max();
         result = Set(key, value, key_iterator);
     }
 
     return result;
 }
 
+// See MapBasedGlobalLockImpl.h
+bool SimpleLRU::Adopt(const std::string &key, std::string &&value)
+{
+    std::size_t size_of_value = value.size();
+
+    // влезет вообще или нет
+    if (key.size() + size_of_value > _max_size)
+    {
+        return false;
+    }
+
+    // обычный Put кладет пустое значение и ставит элемент в начало списка (вызов без виртуальной
+    // диспетчеризации, т.к. потокобезопасная обертка уже держит лок)
+    if (!SimpleLRU::Put(key, std::string()))
+    {
+        return false;
+    }
+
+    // освобождаем место под само значение, голова списка при этом не вытесняется
+    if (size_of_value > _max_size - _current_size)
+    {
+        this->ClearFromEnd(size_of_value);
+    }
+
+    // буфер переезжает в хранилище без копирования
+    _lru_head->value.Assign(std::move(value));
+    _current_size += size_of_value;
+
+    return true;
+}
+
 // See MapBasedGlobalLockImpl.h
 bool SimpleLRU::PutIfAbsent(const std::string &key, const std::string &value)
 {
@@ -120,6 +172,12 @@ bool SimpleLRU::PutIfAbsent(const std::string &key, const std::string &value)
         return false;
     }
 
+    // ключ есть на втором уровне - значит он уже есть
+    if (_second_tier && _second_tier->Contains(key))
+    {
+        return false;
+    }
+
     // влезет или нет с учетом уже имеющихся
     if (size_of_new > _max_size - _current_size)
     {
@@ -128,7 +186,7 @@ bool SimpleLRU::PutIfAbsent(const std::string &key, const std::string &value)
 
     iterator_type key_iterator;
 
-    key_iterator = _lru_index.find(key);
+    key_iterator = Find(key);
 
     // если ключ уже есть, возвращаем false
     if (key_iterator != _lru_index.end())
@@ -137,7 +195,7 @@ bool SimpleLRU::PutIfAbsent(const std::string &key, const std::string &value)
     }
 
     // создаем новую структуру-вершину и инициализируем ее
-    std::unique_ptr<lru_node> new_node_ptr(new lru_node(key, value));
+    std::unique_ptr<lru_node> new_node_ptr(new lru_node(key, value, _pool));
 
     // если уже есть другие элементы:
     if (_lru_head)
@@ -186,7 +244,7 @@ bool SimpleLRU::PutIfAbsent(const std::string &key, const std::string &value, it
     }
 
     // создаем новую структуру-вершину и инициализируем ее
-    std::unique_ptr<lru_node> new_node_ptr(new lru_node(key, value));
+    std::unique_ptr<lru_node> new_node_ptr(new lru_node(key, value, _pool));
 
     // если уже есть другие элементы:
     if (_lru_head)
@@ -224,11 +282,16 @@ bool SimpleLRU::Set(const std::string &key, const std::string &value)
 
     iterator_type key_iterator;
 
-    key_iterator = _lru_index.find(key);
+    key_iterator = Find(key);
 
     // если ключа нет, возвращаем false
     if (key_iterator == _lru_index.end())
     {
+        // ключ на втором уровне: убираем оттуда и кладем новое значение в память
+        if (_second_tier && _second_tier->Delete(key))
+        {
+            return PutIfAbsent(key, value, key_iterator);
+        }
         return false;
     }
 
@@ -250,7 +313,7 @@ bool SimpleLRU::Set(const std::string &key, const std::string &value)
         this->ClearFromEnd(size_of_new);
     }
 
-    current_node->value = value;
+    current_node->value.Assign(value, _pool);
     _current_size += value.size();
 
     return true;
@@ -292,7 +355,7 @@ bool SimpleLRU::Set(const std::string &key, const std::string &value, iterator_t
         this->ClearFromEnd(size_of_new);
     }
 
-    current_node->value = value;
+    current_node->value.Assign(value, _pool);
     _current_size += value.size();
 
     return true;
@@ -301,13 +364,14 @@ bool SimpleLRU::Set(const std::string &key, const std::string &value, iterator_t
 // See MapBasedGlobalLockImpl.h
 bool SimpleLRU::Delete(const std::string &key)
 {
+    // здесь без Find: он сам удаляет просроченные элементы через Delete
     auto key_iterator = _lru_index.find(key);
     std::unique_ptr<lru_node> current_node_ptr;
 
-    // если ключа нет, возвращаем false
+    // если ключа нет, возвращаем false (или удаляем со второго уровня)
     if (key_iterator == _lru_index.end())
     {
-        return false;
+        return _second_tier && _second_tier->Delete(key);
     }
 
     lru_node *current_node = &(key_iterator->second).get();
@@ -353,16 +417,161 @@ bool SimpleLRU::Delete(const std::string &key)
 
     _current_size -= key.size() + current_node->value.size();
 
+    // просроченный ключ удаляем, но для клиента его уже не было
+    bool expired = Expired(*current_node);
+
     // удаляем из дерева
     _lru_index.erase(key);
 
+    return !expired;
+}
+
+// See MapBasedGlobalLockImpl.h
+bool SimpleLRU::Touch(const std::string &key, int64_t ttl)
+{
+    auto key_iterator = Find(key);
+
+    // элемент со второго уровня поднимаем в память, только там хранятся сроки
+    std::string promoted;
+    if (key_iterator == _lru_index.end() && _second_tier && Promote(key, promoted))
+    {
+        key_iterator = _lru_index.find(key);
+    }
+
+    if (key_iterator == _lru_index.end())
+    {
+        return ttl < 0 && SimpleLRU::Delete(key);
+    }
+
+    if (ttl < 0)
+    {
+        return SimpleLRU::Delete(key);
+    }
+
+    lru_node *current_node = &(key_iterator->second).get();
+    if (ttl == 0)
+    {
+        current_node->expire_at = std::chrono::steady_clock::time_point::max();
+    }
+    else
+    {
+        // ограничиваем срок, чтобы не переполнить time_point (2^32 секунд - больше ста лет)
+        current_node->expire_at = std::chrono::steady_clock::now() + std::chrono::seconds(std::min<int64_t>(ttl, int64_t(1) << 32));
+    }
+
+    // touch считается использованием ключа
+    if (_lru_head.get() != current_node)
+    {
+        this->MakeFirst(current_node);
+    }
+
+    return true;
+}
+
+// See SimpleLRU.h
+bool SimpleLRU::TimeToLive(const std::string &key, int64_t &ttl)
+{
+    auto key_iterator = Find(key);
+    if (key_iterator == _lru_index.end())
+    {
+        // на втором уровне сроки не хранятся, такие ключи живут вечно
+        if (!_second_tier || !_second_tier->Contains(key))
+        {
+            return false;
+        }
+        ttl = -1;
+        return true;
+    }
+
+    const lru_node &current_node = key_iterator->second.get();
+    if (current_node.expire_at == std::chrono::steady_clock::time_point::max())
+    {
+        ttl = -1;
+        return true;
+    }
+
+    // остаток округляем вверх, чтобы живой ключ не показывал 0
+    auto left = std::chrono::duration_cast<std::chrono::milliseconds>(current_node.expire_at - std::chrono::steady_clock::now());
+    ttl = (left.count() + 999) / 1000;
     return true;
 }
 
+// поиск с ленивым удалением просроченных элементов
+SimpleLRU::iterator_type SimpleLRU::Find(const std::string &key)
+{
+    auto key_iterator = _lru_index.find(key);
+    if (key_iterator != _lru_index.end() && Expired(key_iterator->second.get()))
+    {
+        SimpleLRU::Delete(key);
+        return _lru_index.end();
+    }
+    return key_iterator;
+}
+
 // See MapBasedGlobalLockImpl.h
 bool SimpleLRU::Get(const std::string &key, std::string &value)
 {
-    auto key_iterator = _lru_index.find(key);
+    // время доступа к памяти меряем только для сравнения со вторым уровнем
+    std::chrono::steady_clock::time_point start;
+    if (_second_tier)
+    {
+        start = std::chrono::steady_clock::now();
+    }
+
+    auto key_iterator = Find(key);
+
+    // если ключа нет, пробуем второй уровень
+    if (key_iterator == _lru_index.end())
+    {
+        _misses++;
+        return _second_tier && Promote(key, value);
+    }
+
+    lru_node *current_node = &(key_iterator->second).get();
+    current_node->value.CopyTo(value);
+
+    // переносим элемент в начало двусвязного списка:
+    if (_lru_head.get() != current_node)
+    {
+        this->MakeFirst(current_node);
+    }
+
+    _hits++;
+    if (_second_tier)
+    {
+        _get_ns += std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start).count();
+    }
+    return true;
+}
+
+// перенос элемента со второго уровня обратно в память
+bool SimpleLRU::Promote(const std::string &key, std::string &value)
+{
+    if (!_second_tier->Take(key, value))
+    {
+        return false;
+    }
+
+    // если в память не влезло, то значение все равно отдаем
+    iterator_type key_iterator = _lru_index.end();
+    if (!PutIfAbsent(key, value, key_iterator))
+    {
+        _second_tier->Put(key, {std::make_shared<std::string>(value)});
+    }
+    return true;
+}
+
+// See MapBasedGlobalLockImpl.h
+bool SimpleLRU::Append(const std::string &key, const std::string &value)
+{
+    auto key_iterator = Find(key);
+
+    // сначала поднимаем элемент со второго уровня
+    std::string promoted;
+    if (key_iterator == _lru_index.end() && _second_tier && Promote(key, promoted))
+    {
+        key_iterator = _lru_index.find(key);
+    }
 
     // если ключа нет, возвращаем false
     if (key_iterator == _lru_index.end())
@@ -371,7 +580,94 @@ bool SimpleLRU::Get(const std::string &key, std::string &value)
     }
 
     lru_node *current_node = &(key_iterator->second).get();
-    value = current_node->value;
+
+    // влезет ли значение после дописывания вообще
+    if (key.size() + current_node->value.size() + value.size() > _max_size)
+    {
+        return false;
+    }
+
+    // переносим элемент в начало двусвязного списка, чтобы при освобождении
+    // места он сам не был удален
+    if (_lru_head.get() != current_node)
+    {
+        this->MakeFirst(current_node);
+    }
+
+    if (value.size() > _max_size - _current_size)
+    {
+        this->ClearFromEnd(value.size());
+    }
+
+    // дописываем новые куски, уже имеющиеся данные не копируются
+    current_node->value.Append(value, _pool);
+    _current_size += value.size();
+
+    return true;
+}
+
+// See MapBasedGlobalLockImpl.h
+bool SimpleLRU::Prepend(const std::string &key, const std::string &value)
+{
+    // куски нельзя дописать в начало, поэтому значение собирается заново
+    std::string current;
+    if (!SimpleLRU::Get(key, current))
+    {
+        return false;
+    }
+    return SimpleLRU::Set(key, value + current);
+}
+
+// See MapBasedGlobalLockImpl.h
+bool SimpleLRU::Clear()
+{
+    _lru_index.clear();
+
+    // список освобождаем в цикле: рекурсивное удаление по prev переполнило бы стек
+    std::unique_ptr<lru_node> node_ptr;
+    std::unique_ptr<lru_node> prev_node_ptr;
+
+    node_ptr = std::move(_lru_head);
+
+    for (; node_ptr.get() != nullptr;)
+    {
+        prev_node_ptr = std::move(node_ptr.get()->prev);
+        node_ptr.reset();
+        node_ptr = std::move(prev_node_ptr);
+    }
+
+    _last_node = nullptr;
+    _current_size = 0;
+
+    if (_second_tier)
+    {
+        _second_tier->Clear();
+    }
+    return true;
+}
+
+// See MapBasedGlobalLockImpl.h
+bool SimpleLRU::GetChunks(const std::string &key, std::vector<ValueChunk> &chunks)
+{
+    auto key_iterator = Find(key);
+
+    // если ключа нет, пробуем второй уровень
+    if (key_iterator == _lru_index.end())
+    {
+        _misses++;
+        std::string value;
+        if (!_second_tier || !Promote(key, value))
+        {
+            return false;
+        }
+        chunks.push_back(std::make_shared<std::string>(std::move(value)));
+        return true;
+    }
+    _hits++;
+
+    // куски неизменяемы, поэтому отдаем ссылки на них без копирования
+    lru_node *current_node = &(key_iterator->second).get();
+    current_node->value.ShareTo(chunks);
 
     // переносим элемент в начало двусвязного списка:
     if (_lru_head.get() != current_node)
@@ -382,5 +678,66 @@ bool SimpleLRU::Get(const std::string &key, std::string &value)
     return true;
 }
 
+// See MapBasedGlobalLockImpl.h
+SimpleLRU::ScanResult SimpleLRU::Scan(const std::string &prefix, const std::string &start, std::size_t limit,
+                                      std::vector<std::string> &keys)
+{
+    // дерево упорядочено, поэтому все ключи с данным префиксом идут подряд:
+    // начинаем либо с первого ключа с префиксом, либо сразу после курсора
+    iterator_type key_iterator;
+    if (start.empty() || start < prefix)
+    {
+        key_iterator = _lru_index.lower_bound(prefix);
+    }
+    else
+    {
+        key_iterator = _lru_index.upper_bound(start);
+    }
+
+    // порядок в списке не трогаем - просмотр не является использованием ключа
+    std::size_t collected = 0;
+    for (; key_iterator != _lru_index.end(); ++key_iterator)
+    {
+        const std::string &key = key_iterator->first.get();
+        if (key.compare(0, prefix.size(), prefix) != 0)
+        {
+            return ScanResult::kEnd;
+        }
+
+        // просроченные ключи не показываем, удалятся при следующем обращении
+        if (Expired(key_iterator->second.get()))
+        {
+            continue;
+        }
+
+        if (collected == limit)
+        {
+            return ScanResult::kMore;
+        }
+
+        keys.push_back(key);
+        collected++;
+    }
+
+    return ScanResult::kEnd;
+}
+
+// See MapBasedGlobalLockImpl.h
+void SimpleLRU::GetStats(std::vector<std::pair<std::string, std::string>> &stats)
+{
+    stats.emplace_back("curr_items", std::to_string(_lru_index.size()));
+    stats.emplace_back("bytes", std::to_string(_current_size));
+    stats.emplace_back("limit_maxbytes", std::to_string(_max_size));
+    stats.emplace_back("evictions", std::to_string(_evictions));
+
+    if (_second_tier)
+    {
+        stats.emplace_back("tier1_hits", std::to_string(_hits));
+        stats.emplace_back("tier1_misses", std::to_string(_misses));
+        stats.emplace_back("tier1_get_avg_ns", std::to_string(_hits > 0 ? _get_ns / _hits : 0));
+        _second_tier->GetStats(stats);
+    }
+}
+
 } // namespace Backend
 } // namespace Afina
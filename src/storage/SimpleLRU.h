@@ -1,6 +1,8 @@
 #ifndef AFINA_STORAGE_SIMPLE_LRU_H
 #define AFINA_STORAGE_SIMPLE_LRU_H
 
+#include <chrono>
+#include <cstdint>
 #include <iostream>
 #include <map>
 #include <memory>
@@ -11,6 +13,9 @@
 
 #include <afina/Storage.h>
 
+#include "ChunkPool.h"
+#include "FileTier.h"
+
 namespace Afina {
 namespace Backend {
 
@@ -27,11 +32,14 @@ private:
     // LRU cache node
     using lru_node = struct lru_node {
         const std::string key;
-        std::string value;
+        ChunkedValue value;
         std::unique_ptr<lru_node> prev;
         lru_node *next = nullptr;
 
-        lru_node(const std::string &k, const std::string &v) : key(k), value(v) {}
+        // момент, после которого элемент считается удаленным (max - бессрочно)
+        std::chrono::steady_clock::time_point expire_at = std::chrono::steady_clock::time_point::max();
+
+        lru_node(const std::string &k, const std::string &v, ChunkPool &pool) : key(k) { value.Assign(v, pool); }
     };
 
     void MakeFirst(lru_node *current_node);
@@ -55,9 +63,30 @@ private:
     // Index of nodes from list above, allows fast random access to elements by lru_node#key
     std::map<std::reference_wrapper<const std::string>, std::reference_wrapper<lru_node>, std::less<std::string>> _lru_index;
 
+    // пул кусков, из которых собираются большие значения
+    ChunkPool _pool;
+
+    // второй уровень хранения: туда уходят вытесненные элементы (может отсутствовать)
+    std::unique_ptr<FileTier> _second_tier;
+
+    // статистика первого уровня
+    uint64_t _hits = 0;
+    uint64_t _misses = 0;
+    uint64_t _evictions = 0;
+    uint64_t _get_ns = 0;
+
+    // забирает элемент со второго уровня и кладет обратно в память
+    bool Promote(const std::string &key, std::string &value);
+
 public:
     SimpleLRU(size_t max_size = 1024) : _max_size(max_size) {}
 
+    /**
+     * Enables second tier: items evicted from memory go there and misses are served from it.
+     * Must be called before storage is used
+     */
+    void SetSecondTier(std::unique_ptr<FileTier> tier) { _second_tier = std::move(tier); }
+
     ~SimpleLRU()
     {
         _lru_index.clear();
@@ -78,6 +107,9 @@ public:
     // Implements Afina::Storage interface
     bool Put(const std::string &key, const std::string &value) override;
 
+    // Implements Afina::Storage interface
+    bool Adopt(const std::string &key, std::string &&value) override;
+
     // Implements Afina::Storage interface
     bool PutIfAbsent(const std::string &key, const std::string &value) override;
 
@@ -91,10 +123,46 @@ public:
     // Implements Afina::Storage interface
     bool Delete(const std::string &key) override;
 
+    // Implements Afina::Storage interface
+    bool Touch(const std::string &key, int64_t ttl) override;
+
+    // Implements Afina::Storage interface
+    bool TimeToLive(const std::string &key, int64_t &ttl) override;
+
     // Implements Afina::Storage interface
     bool Get(const std::string &key, std::string &value) override;
 
+    // Implements Afina::Storage interface
+    bool Append(const std::string &key, const std::string &value) override;
+
+    // Implements Afina::Storage interface
+    bool Prepend(const std::string &key, const std::string &value) override;
+
+    // Implements Afina::Storage interface
+    bool Clear() override;
+
+    // Implements Afina::Storage interface
+    bool GetChunks(const std::string &key, std::vector<ValueChunk> &chunks) override;
+
+    // Implements Afina::Storage interface
+    ScanResult Scan(const std::string &prefix, const std::string &start, std::size_t limit,
+                    std::vector<std::string> &keys) override;
+
+    // Implements Afina::Storage interface
+    void GetStats(std::vector<std::pair<std::string, std::string>> &stats) override;
+
     using iterator_type = std::map<std::reference_wrapper<const std::string>, std::reference_wrapper<lru_node>, std::less<std::string>>::iterator;
+
+private:
+    // истек ли срок жизни элемента
+    static bool Expired(const lru_node &node)
+    {
+        return node.expire_at != std::chrono::steady_clock::time_point::max() &&
+               node.expire_at <= std::chrono::steady_clock::now();
+    }
+
+    // поиск ключа в памяти: просроченный элемент удаляется и не находится
+    iterator_type Find(const std::string &key);
 };
 
 } // namespace Backend
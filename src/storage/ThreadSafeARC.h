@@ -0,0 +1,107 @@
+#ifndef AFINA_STORAGE_THREAD_SAFE_ARC_H
+#define AFINA_STORAGE_THREAD_SAFE_ARC_H
+
+#include <mutex>
+#include <string>
+
+#include "ARC.h"
+
+namespace Afina {
+namespace Backend {
+
+/**
+ * # ARC thread safe version
+ * Each operation runs under the global lock
+ */
+class ThreadSafeARC final : public ARC {
+public:
+    ThreadSafeARC(size_t max_size = 1024) : ARC(max_size) {}
+    ~ThreadSafeARC() {}
+
+    // see ARC.h
+    bool Put(const std::string &key, const std::string &value) override {
+        std::unique_lock<std::mutex> _ul(_mutex);
+        return ARC::Put(key, value);
+    }
+
+    // see ARC.h
+    bool PutIfAbsent(const std::string &key, const std::string &value) override {
+        std::unique_lock<std::mutex> _ul(_mutex);
+        return ARC::PutIfAbsent(key, value);
+    }
+
+    // see ARC.h
+    bool Set(const std::string &key, const std::string &value) override {
+        std::unique_lock<std::mutex> _ul(_mutex);
+        return ARC::Set(key, value);
+    }
+
+    // see ARC.h
+    bool Delete(const std::string &key) override {
+        std::unique_lock<std::mutex> _ul(_mutex);
+        return ARC::Delete(key);
+    }
+
+    // see ARC.h
+    bool Touch(const std::string &key, int64_t ttl) override {
+        std::unique_lock<std::mutex> _ul(_mutex);
+        return ARC::Touch(key, ttl);
+    }
+
+    // see ARC.h
+    bool TimeToLive(const std::string &key, int64_t &ttl) override {
+        std::unique_lock<std::mutex> _ul(_mutex);
+        return ARC::TimeToLive(key, ttl);
+    }
+
+    // see ARC.h
+    bool Get(const std::string &key, std::string &value) override {
+        std::unique_lock<std::mutex> _ul(_mutex);
+        return ARC::Get(key, value);
+    }
+
+    // see Storage.h, default implementation is not atomic
+    bool Append(const std::string &key, const std::string &value) override {
+        std::unique_lock<std::mutex> _ul(_mutex);
+        std::string current;
+        if (!ARC::Get(key, current)) {
+            return false;
+        }
+        return ARC::Set(key, current + value);
+    }
+
+    // see Storage.h, default implementation is not atomic
+    bool Prepend(const std::string &key, const std::string &value) override {
+        std::unique_lock<std::mutex> _ul(_mutex);
+        std::string current;
+        if (!ARC::Get(key, current)) {
+            return false;
+        }
+        return ARC::Set(key, value + current);
+    }
+
+    // see Storage.h, default implementation is not atomic
+    bool Update(const std::string &key, const Updater &update) override {
+        std::unique_lock<std::mutex> _ul(_mutex);
+        std::string value;
+        bool present = ARC::Get(key, value);
+        if (!update(present, value)) {
+            return false;
+        }
+        return present ? ARC::Set(key, value) : ARC::PutIfAbsent(key, value);
+    }
+
+    // see ARC.h
+    void GetStats(std::vector<std::pair<std::string, std::string>> &stats) override {
+        std::unique_lock<std::mutex> _ul(_mutex);
+        ARC::GetStats(stats);
+    }
+
+private:
+    std::mutex _mutex;
+};
+
+} // namespace Backend
+} // namespace Afina
+
+#endif // AFINA_STORAGE_THREAD_SAFE_ARC_H
@@ -4,6 +4,7 @@
 #include <map>
 #include <mutex>
 #include <string>
+#include <utility>
 
 #include "SimpleLRU.h"
 
@@ -15,7 +16,7 @@ namespace Backend {
  *
  *
  */
-class ThreadSafeSimplLRU : public SimpleLRU {
+class ThreadSafeSimplLRU final : public SimpleLRU {
 public:
     ThreadSafeSimplLRU(size_t max_size = 1024) : SimpleLRU(max_size) {}
     ~ThreadSafeSimplLRU() {}
@@ -26,6 +27,12 @@ public:
         return SimpleLRU::Put(key, value);;
     }
 
+    // see SimpleLRU.h
+    bool Adopt(const std::string &key, std::string &&value) override {
+        std::unique_lock<std::mutex> _ul(_mutex);
+        return SimpleLRU::Adopt(key, std::move(value));
+    }
+
     // see SimpleLRU.h
     bool PutIfAbsent(const std::string &key, const std::string &value) override {
         std::unique_lock<std::mutex> _ul(_mutex);
@@ -44,12 +51,81 @@ public:
         return SimpleLRU::Delete(key);
 }
 
+    // see SimpleLRU.h
+    bool Touch(const std::string &key, int64_t ttl) override {
+        std::unique_lock<std::mutex> _ul(_mutex);
+        return SimpleLRU::Touch(key, ttl);
+    }
+
+    // see SimpleLRU.h
+    bool TimeToLive(const std::string &key, int64_t &ttl) override {
+        std::unique_lock<std::mutex> _ul(_mutex);
+        return SimpleLRU::TimeToLive(key, ttl);
+    }
+
     // see SimpleLRU.h
     bool Get(const std::string &key, std::string &value) override {
         std::unique_lock<std::mutex> _ul(_mutex);
         return SimpleLRU::Get(key, value);
     }
 
+    // see SimpleLRU.h
+    bool Append(const std::string &key, const std::string &value) override {
+        std::unique_lock<std::mutex> _ul(_mutex);
+        return SimpleLRU::Append(key, value);
+    }
+
+    // see SimpleLRU.h
+    bool Prepend(const std::string &key, const std::string &value) override {
+        std::unique_lock<std::mutex> _ul(_mutex);
+        return SimpleLRU::Prepend(key, value);
+    }
+
+    // see Storage.h, default implementation is not atomic
+    bool Update(const std::string &key, const Updater &update) override {
+        std::unique_lock<std::mutex> _ul(_mutex);
+        std::string value;
+        bool present = SimpleLRU::Get(key, value);
+        if (!update(present, value)) {
+            return false;
+        }
+        return present ? SimpleLRU::Set(key, value) : SimpleLRU::PutIfAbsent(key, value);
+    }
+
+    // see SimpleLRU.h
+    bool Clear() override {
+        std::unique_lock<std::mutex> _ul(_mutex);
+        return SimpleLRU::Clear();
+    }
+
+    // see SimpleLRU.h
+    bool GetChunks(const std::string &key, std::vector<ValueChunk> &chunks) override {
+        std::unique_lock<std::mutex> _ul(_mutex);
+        return SimpleLRU::GetChunks(key, chunks);
+    }
+
+    // Whole batch is looked up under the single lock
+    void GetChunksBatch(const std::vector<const std::string *> &keys, std::vector<ValueChunk> &chunks,
+                        std::vector<std::size_t> &ends) override {
+        std::unique_lock<std::mutex> _ul(_mutex);
+        for (auto key : keys) {
+            ends.push_back(SimpleLRU::GetChunks(*key, chunks) ? chunks.size() : kMissing);
+        }
+    }
+
+    // see SimpleLRU.h
+    ScanResult Scan(const std::string &prefix, const std::string &start, std::size_t limit,
+                    std::vector<std::string> &keys) override {
+        std::unique_lock<std::mutex> _ul(_mutex);
+        return SimpleLRU::Scan(prefix, start, limit, keys);
+    }
+
+    // see SimpleLRU.h
+    void GetStats(std::vector<std::pair<std::string, std::string>> &stats) override {
+        std::unique_lock<std::mutex> _ul(_mutex);
+        SimpleLRU::GetStats(stats);
+    }
+
 private:
     std::mutex _mutex;
 };
@@ -0,0 +1,27 @@
+#include "Versioned.h"
+
+namespace Afina {
+namespace Backend {
+
+const std::size_t Versioned::kSlots;
+
+// See Versioned.h
+Versioned::Versioned(std::shared_ptr<Afina::Storage> storage) : _storage(std::move(storage)) {
+    for (auto &version : _versions) {
+        version.store(0, std::memory_order_relaxed);
+    }
+}
+
+// See Versioned.h
+bool Versioned::Clear() {
+    bool cleared = _storage->Clear();
+    if (cleared) {
+        for (auto &version : _versions) {
+            version.fetch_add(1, std::memory_order_release);
+        }
+    }
+    return cleared;
+}
+
+} // namespace Backend
+} // namespace Afina
@@ -0,0 +1,118 @@
+#ifndef AFINA_STORAGE_VERSIONED_H
+#define AFINA_STORAGE_VERSIONED_H
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include <afina/Storage.h>
+
+namespace Afina {
+namespace Backend {
+
+/**
+ * # Storage that counts changes of the keys
+ * Forwards every call to the wrapped storage and bumps version of the key once call that might change it
+ * returns. Versions are kept in a fixed table of counters indexed by key hash, so keys that share a slot share
+ * version as well: change of one looks like change of all of them, but a change is never missed. Clear bumps
+ * every slot.
+ *
+ * Readers that remember versions of the keys before reading values know values are still the same as long as
+ * versions are, see Execute::ResponseCache. Values that expire or get evicted are not counted as changes
+ */
+class Versioned final : public Afina::Storage {
+public:
+    static const std::size_t kSlots = 1 << 14;
+
+    Versioned(std::shared_ptr<Afina::Storage> storage);
+    ~Versioned() {}
+
+    /**
+     * Slot of the key in the versions table
+     */
+    static std::size_t Slot(const std::string &key) { return std::hash<std::string>()(key) & (kSlots - 1); }
+
+    /**
+     * Current version of the keys of the given slot
+     */
+    uint64_t Version(std::size_t slot) const { return _versions[slot].load(std::memory_order_acquire); }
+
+    void Start() override { _storage->Start(); }
+    void Stop() override { _storage->Stop(); }
+
+    bool Put(const std::string &key, const std::string &value) override {
+        return Changed(key, _storage->Put(key, value));
+    }
+
+    bool Adopt(const std::string &key, std::string &&value) override {
+        return Changed(key, _storage->Adopt(key, std::move(value)));
+    }
+
+    bool PutIfAbsent(const std::string &key, const std::string &value) override {
+        return Changed(key, _storage->PutIfAbsent(key, value));
+    }
+
+    bool Set(const std::string &key, const std::string &value) override {
+        return Changed(key, _storage->Set(key, value));
+    }
+
+    bool Delete(const std::string &key) override { return Changed(key, _storage->Delete(key)); }
+
+    bool Touch(const std::string &key, int64_t ttl) override { return Changed(key, _storage->Touch(key, ttl)); }
+
+    bool TimeToLive(const std::string &key, int64_t &ttl) override { return _storage->TimeToLive(key, ttl); }
+
+    bool Get(const std::string &key, std::string &value) override { return _storage->Get(key, value); }
+
+    bool Append(const std::string &key, const std::string &value) override {
+        return Changed(key, _storage->Append(key, value));
+    }
+
+    bool Prepend(const std::string &key, const std::string &value) override {
+        return Changed(key, _storage->Prepend(key, value));
+    }
+
+    bool Update(const std::string &key, const Updater &update) override {
+        return Changed(key, _storage->Update(key, update));
+    }
+
+    bool Clear() override;
+
+    bool GetChunks(const std::string &key, std::vector<ValueChunk> &chunks) override {
+        return _storage->GetChunks(key, chunks);
+    }
+
+    void GetChunksBatch(const std::vector<const std::string *> &keys, std::vector<ValueChunk> &chunks,
+                        std::vector<std::size_t> &ends) override {
+        _storage->GetChunksBatch(keys, chunks, ends);
+    }
+
+    ScanResult Scan(const std::string &prefix, const std::string &start, std::size_t limit,
+                    std::vector<std::string> &keys) override {
+        return _storage->Scan(prefix, start, limit, keys);
+    }
+
+    void GetStats(std::vector<std::pair<std::string, std::string>> &stats) override { _storage->GetStats(stats); }
+
+private:
+    // Bumps version of the key if it is changed, returns changed
+    bool Changed(const std::string &key, bool changed) {
+        if (changed) {
+            _versions[Slot(key)].fetch_add(1, std::memory_order_release);
+        }
+        return changed;
+    }
+
+    std::shared_ptr<Afina::Storage> _storage;
+    std::atomic<uint64_t> _versions[kSlots];
+};
+
+} // namespace Backend
+} // namespace Afina
+
+#endif // AFINA_STORAGE_VERSIONED_H
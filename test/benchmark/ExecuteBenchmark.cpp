@@ -0,0 +1,306 @@
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <fstream>
+#include <iostream>
+#include <map>
+#include <memory>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <spdlog/logger.h>
+#include <spdlog/sinks/null_sink.h>
+
+#include <afina/execute/Counters.h>
+#include <afina/execute/Dispatcher.h>
+#include <afina/execute/Get.h>
+#include <afina/execute/Latency.h>
+#include <afina/execute/OutputSink.h>
+#include <afina/execute/ResponseCache.h>
+#include <afina/execute/Set.h>
+
+#include "storage/SimpleLRU.h"
+#include "storage/ThreadSafeSimpleLRU.h"
+#include "storage/Versioned.h"
+
+using namespace Afina::Backend;
+using namespace Afina::Execute;
+
+namespace {
+
+std::string joined(OutputSink &sink) {
+    std::string result;
+    for (auto &part : sink.Iov()) {
+        result.append(static_cast<const char *>(part.iov_base), part.iov_len);
+    }
+    return result;
+}
+
+std::map<std::string, std::string> report() {
+    std::vector<std::pair<std::string, std::string>> stats;
+    Latency::Report(stats);
+    return std::map<std::string, std::string>(stats.begin(), stats.end());
+}
+
+} // namespace
+
+// Compares multi-get response built as a string with the one written into the sink
+TEST(CommandBenchmark, GetToSinkThroughput) {
+    SimpleLRU storage(16 * 1024 * 1024);
+    std::vector<std::string> keys;
+    for (int i = 0; i < 100; i++) {
+        keys.push_back("key" + std::to_string(i));
+        EXPECT_TRUE(storage.Put(keys.back(), std::string(1000, 'v')));
+    }
+    Get get(keys);
+    const int count = 2000;
+
+    std::string out;
+    auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < count; i++) {
+        get.Execute(storage, "", out);
+    }
+    double string_us = std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - start).count();
+
+    OutputSink sink;
+    start = std::chrono::steady_clock::now();
+    for (int i = 0; i < count; i++) {
+        sink.Clear();
+        get.ExecuteTo(storage, std::string(), sink);
+    }
+    double sink_us = std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - start).count();
+
+    EXPECT_TRUE(out == joined(sink));
+    std::cout << "100-key get: string " << string_us / count << " us, sink " << sink_us / count << " us"
+              << std::endl;
+}
+
+// Per command cost of tracing: off, filtered out by level and formatted into a null
+// sink, compared to a flushed stream write per command commands used to do
+TEST(CommandBenchmark, TraceOverhead) {
+    SimpleLRU storage(1024 * 1024);
+    const int count = 100000;
+    std::string value(100, 'v'), out;
+    Set set("key", 0, 0);
+    Get get({"key"});
+
+    auto run = [&]() {
+        auto start = std::chrono::steady_clock::now();
+        for (int i = 0; i < count; i++) {
+            set.Execute(storage, value, out);
+            get.Execute(storage, "", out);
+        }
+        return std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count() / count / 2;
+    };
+
+    std::ofstream devnull("/dev/null");
+    auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < count; i++) {
+        set.Execute(storage, value, out);
+        devnull << "Set(key): " << value << std::endl;
+        get.Execute(storage, "", out);
+        devnull << "Get(key )" << std::endl;
+    }
+    double stream_ns =
+        std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count() / count / 2;
+
+    set_logger(nullptr);
+    double off_ns = run();
+
+    std::shared_ptr<spdlog::logger> logger(
+        new spdlog::logger("execute", std::make_shared<spdlog::sinks::null_sink_st>()));
+    logger->set_level(spdlog::level::warn);
+    set_logger(logger);
+    double filtered_ns = run();
+
+    logger->set_level(spdlog::level::trace);
+    double traced_ns = run();
+    set_logger(nullptr);
+
+    std::cout << "command tracing: off " << off_ns << " ns, filtered " << filtered_ns << " ns, traced " << traced_ns
+              << " ns, flushed stream " << stream_ns << " ns" << std::endl;
+}
+
+// Compares per thread counters with a single atomic all threads increment
+TEST(CommandBenchmark, CountersContention) {
+    const int count = 10000000;
+    const unsigned threads = std::max(2u, std::thread::hardware_concurrency());
+    std::atomic<uint64_t> shared(0);
+
+    auto run = [&](bool per_thread) {
+        std::vector<std::thread> workers;
+        auto start = std::chrono::steady_clock::now();
+        for (unsigned t = 0; t < threads; t++) {
+            workers.emplace_back([&]() {
+                for (int i = 0; i < count; i++) {
+                    if (per_thread) {
+                        Counters::Add(Counters::kCmdGet);
+                    } else {
+                        shared.fetch_add(1, std::memory_order_relaxed);
+                    }
+                }
+            });
+        }
+        for (auto &worker : workers) {
+            worker.join();
+        }
+        return std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count() / count;
+    };
+
+    uint64_t before = Counters::Get(Counters::kCmdGet);
+    double local_ns = run(true);
+    double shared_ns = run(false);
+    ASSERT_EQ(before + uint64_t(threads) * count, Counters::Get(Counters::kCmdGet));
+    ASSERT_EQ(uint64_t(threads) * count, shared.load());
+
+    std::cout << "stats counters, " << threads << " threads: per thread " << local_ns << " ns, shared atomic "
+              << shared_ns << " ns per increment" << std::endl;
+}
+
+// Per command cost of single key get and set executed through the virtual calls and
+// through the dispatcher of the concrete storage type
+TEST(CommandBenchmark, StaticDispatchOverhead) {
+    ThreadSafeSimplLRU storage(16 * 1024 * 1024);
+    const int count = 300000;
+    Set set("key", 0, 0);
+    Get get({"key"});
+    OutputSink sink;
+
+    auto run = [&](Dispatcher &dispatcher) {
+        auto start = std::chrono::steady_clock::now();
+        for (int i = 0; i < count; i++) {
+            sink.Clear();
+            dispatcher.ExecuteTo(storage, set, std::string(16, 'v'), sink);
+            dispatcher.ExecuteTo(storage, get, std::string(), sink);
+        }
+        return std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count() / count / 2;
+    };
+
+    Dispatcher virtual_dispatcher;
+    StaticDispatcher<ThreadSafeSimplLRU> static_dispatcher;
+    run(virtual_dispatcher);
+    double virtual_ns = run(virtual_dispatcher);
+    double static_ns = run(static_dispatcher);
+    EXPECT_EQ("STOREDVALUE key 0 16\r\n" + std::string(16, 'v') + "\r\nEND", joined(sink));
+
+    std::cout << "set/get on mt_lru: virtual " << virtual_ns << " ns, static dispatch " << static_ns
+              << " ns per command" << std::endl;
+}
+
+// Pipeline of single key gets executed one by one and at once
+TEST(CommandBenchmark, GetBatchThroughput) {
+    ThreadSafeSimplLRU storage(16 * 1024 * 1024);
+    std::vector<std::unique_ptr<Get>> commands;
+    std::vector<Get *> gets;
+    for (int i = 0; i < 32; i++) {
+        std::string key = "key" + std::to_string(i);
+        EXPECT_TRUE(storage.Put(key, std::string(100, 'v')));
+        commands.emplace_back(new Get({key}));
+        gets.push_back(commands.back().get());
+    }
+    const int count = 5000;
+    OutputSink sink;
+
+    auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < count; i++) {
+        sink.Clear();
+        for (auto get : gets) {
+            get->ExecuteTo(storage, std::string(), sink);
+            sink.Append("\r\n", 2);
+        }
+    }
+    double single_ns = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count();
+    std::string expected = joined(sink);
+
+    start = std::chrono::steady_clock::now();
+    for (int i = 0; i < count; i++) {
+        sink.Clear();
+        Get::ExecuteBatch(storage, gets.data(), gets.size(), sink);
+    }
+    double batch_ns = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count();
+
+    EXPECT_TRUE(expected == joined(sink));
+    std::cout << "pipeline of 32 gets on mt_lru: one by one " << single_ns / count / gets.size() << " ns, batched "
+              << batch_ns / count / gets.size() << " ns per get" << std::endl;
+}
+
+// The same multi-get of 50 keys executed on the storage and answered from the cache
+TEST(CommandBenchmark, ResponseCacheThroughput) {
+    auto storage = std::make_shared<ThreadSafeSimplLRU>(16 * 1024 * 1024);
+    auto versioned = std::make_shared<Versioned>(storage);
+    std::vector<std::string> keys;
+    for (int i = 0; i < 50; i++) {
+        keys.push_back("key" + std::to_string(i));
+        EXPECT_TRUE(versioned->Put(keys.back(), std::string(100, 'v')));
+    }
+    Get get(keys);
+    const int count = 20000;
+    OutputSink sink;
+
+    auto run = [&](Dispatcher &dispatcher) {
+        auto start = std::chrono::steady_clock::now();
+        for (int i = 0; i < count; i++) {
+            sink.Clear();
+            dispatcher.ExecuteTo(*versioned, get, std::string(), sink);
+        }
+        return std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count() / count;
+    };
+
+    StaticDispatcher<Versioned> direct;
+    ResponseCache cache(std::make_shared<StaticDispatcher<Versioned>>(), 60000);
+    double direct_ns = run(direct);
+    std::string expected = joined(sink);
+    double cached_ns = run(cache);
+    EXPECT_TRUE(expected == joined(sink));
+
+    std::cout << "get of 50 keys on mt_lru: executed " << direct_ns << " ns, cached " << cached_ns << " ns per get"
+              << std::endl;
+}
+
+// Prints cost of a single record with and without reading the clock
+TEST(LatencyBenchmark, RecordOverhead) {
+    const int count = 10000000;
+    std::size_t backend = Latency::Backend("overhead_test");
+    std::size_t series = Latency::Series("op");
+
+    // Values spread over a few hundred buckets the way real latencies do
+    std::vector<uint64_t> values(4096);
+    std::mt19937_64 random(42);
+    std::lognormal_distribution<double> distribution(8, 1.5);
+    for (auto &value : values) {
+        value = static_cast<uint64_t>(distribution(random));
+    }
+
+    auto start = std::chrono::steady_clock::now();
+    uint64_t sum = 0;
+    for (int i = 0; i < count; i++) {
+        sum += values[i % values.size()];
+    }
+    double loop_ns = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count();
+
+    start = std::chrono::steady_clock::now();
+    for (int i = 0; i < count; i++) {
+        Latency::Record(backend, series, values[i % values.size()]);
+    }
+    double record_ns = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count();
+
+    start = std::chrono::steady_clock::now();
+    uint64_t last = 0;
+    for (int i = 0; i < count; i++) {
+        uint64_t now = std::chrono::duration_cast<std::chrono::nanoseconds>(
+                           std::chrono::steady_clock::now().time_since_epoch())
+                           .count();
+        Latency::Record(backend, series, now - last);
+        last = now;
+    }
+    double timed_ns = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count();
+
+    ASSERT_EQ(std::to_string(2 * count), report().at("overhead_test:op:count"));
+    std::cout << "latency record: " << (record_ns - loop_ns) / count << " ns, with clock read " << timed_ns / count
+              << " ns (checksum " << sum % 10 << ")" << std::endl;
+}
@@ -0,0 +1,166 @@
+#include <gtest/gtest.h>
+
+#include <chrono>
+#include <cstring>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <thread>
+
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include <afina/logging/Config.h>
+
+#include "logging/ServiceImpl.h"
+#include "network/mt_blocking/ServerImpl.h"
+#include "storage/ThreadSafeSimpleLRU.h"
+
+using namespace Afina;
+
+namespace {
+
+// Runs mt_blocking server on its own port for the lifetime of the benchmark
+class ServerBenchmark : public ::testing::Test {
+protected:
+    // Loggers are registered globally in spdlog, so service is shared by all benchmarks
+    static void SetUpTestCase() {
+        std::shared_ptr<Logging::Config> config(new Logging::Config);
+        config->appenders["console"].type = Logging::Appender::Type::STDOUT;
+        Logging::Logger &root = config->loggers["root"];
+        root.level = Logging::Logger::Level::ERROR;
+        root.appenders.push_back("console");
+        logging.reset(new Logging::ServiceImpl(config));
+        logging->Start();
+    }
+
+    static void TearDownTestCase() {
+        logging->Stop();
+        logging.reset();
+    }
+
+    void SetUp() override {
+        storage.reset(new Backend::ThreadSafeSimplLRU(64 * 1024 * 1024));
+
+        port = 30000 + getpid() % 10000;
+        server.reset(new Network::MTblocking::ServerImpl(storage, logging));
+        server->Start(port, 1, 4);
+    }
+
+    void TearDown() override {
+        server->Stop();
+        server->Join();
+    }
+
+    // Sends whole request from the separate thread while reading responses until they end with the given
+    // marker. Returns everything server sent
+    std::string Pipeline(const std::string &request, const std::string &marker) {
+        int sock = socket(AF_INET, SOCK_STREAM, 0);
+        EXPECT_GE(sock, 0);
+
+        struct sockaddr_in addr;
+        std::memset(&addr, 0, sizeof(addr));
+        addr.sin_family = AF_INET;
+        addr.sin_port = htons(port);
+        addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+        EXPECT_EQ(0, connect(sock, reinterpret_cast<struct sockaddr *>(&addr), sizeof(addr)));
+
+        std::thread sender([sock, &request]() {
+            std::size_t sent = 0;
+            while (sent < request.size()) {
+                ssize_t n = write(sock, request.data() + sent, request.size() - sent);
+                if (n <= 0) {
+                    break;
+                }
+                sent += n;
+            }
+        });
+
+        std::string response;
+        char buffer[64 * 1024];
+        while (response.size() < marker.size() ||
+               response.compare(response.size() - marker.size(), marker.size(), marker) != 0) {
+            ssize_t n = read(sock, buffer, sizeof(buffer));
+            if (n <= 0) {
+                break;
+            }
+            response.append(buffer, n);
+        }
+
+        sender.join();
+        close(sock);
+        return response;
+    }
+
+    static std::shared_ptr<Logging::Service> logging;
+
+    uint16_t port;
+    std::shared_ptr<Afina::Storage> storage;
+    std::shared_ptr<Network::Server> server;
+};
+
+std::shared_ptr<Logging::Service> ServerBenchmark::logging;
+
+} // namespace
+
+// Prints throughput of pipelined single key gets, those are looked up in batches
+TEST_F(ServerBenchmark, PipelinedGets) {
+    const int keys = 100, count = 50000;
+    std::string request, expected;
+    for (int i = 0; i < keys; i++) {
+        std::string key = "key" + std::to_string(i);
+        storage->Put(key, "value" + std::to_string(i));
+    }
+    for (int i = 0; i < count; i++) {
+        // Every tenth key is missing and every eleventh request is not a get
+        int k = i % (keys + keys / 10);
+        std::string key = "key" + std::to_string(k);
+        if (i % 11 == 10) {
+            request += "touch " + key + " 0\r\n";
+            expected += (k < keys) ? "TOUCHED\r\n" : "NOT_FOUND\r\n";
+            continue;
+        }
+        request += "get " + key + "\r\n";
+        if (k < keys) {
+            std::string value = "value" + std::to_string(k);
+            expected += "VALUE " + key + " 0 " + std::to_string(value.size()) + "\r\n" + value + "\r\n";
+        }
+        expected += "END\r\n";
+    }
+
+    auto start = std::chrono::steady_clock::now();
+    std::string response = Pipeline(request + "mn\r\n", "MN\r\n");
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    EXPECT_TRUE(expected + "MN\r\n" == response);
+    std::cout << "pipeline of " << count << " gets: " << count / seconds / 1e3 << " Kops/s" << std::endl;
+}
+
+// Prints bulk load time with and without responses
+TEST_F(ServerBenchmark, BulkLoad) {
+    const std::string value(100, 'v');
+    const int count = 50000;
+
+    for (bool noreply : {false, true}) {
+        std::string request;
+        for (int i = 0; i < count; i++) {
+            request += "set key" + std::to_string(i) + " 0 0 100" + (noreply ? " noreply" : "") + "\r\n";
+            request += value + "\r\n";
+        }
+        request += "mn\r\n";
+
+        auto start = std::chrono::steady_clock::now();
+        std::string response = Pipeline(request, "MN\r\n");
+        double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+        EXPECT_EQ(noreply ? 4 : count * 8 + 4, response.size());
+        std::cout << "bulk load of " << count << " sets" << (noreply ? " with noreply" : "") << ": "
+                  << count / seconds / 1e3 << " Kops/s, " << response.size() << " response bytes" << std::endl;
+    }
+
+    std::string check;
+    EXPECT_TRUE(storage->Get("key" + std::to_string(count - 1), check));
+    EXPECT_EQ(value, check);
+}
@@ -0,0 +1,174 @@
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include <afina/execute/Command.h>
+
+#include <protocol/Parser.h>
+#include <protocol/RespParser.h>
+#include <storage/SimpleLRU.h>
+
+using namespace Afina;
+using Protocol::RespParser;
+
+namespace {
+
+std::string command(const std::vector<std::string> &args) {
+    std::string out = "*" + std::to_string(args.size()) + "\r\n";
+    for (auto &arg : args) {
+        out += "$" + std::to_string(arg.size()) + "\r\n" + arg + "\r\n";
+    }
+    return out;
+}
+
+} // namespace
+
+// Compares switch over packed name with the chain of string compares
+TEST(MemcachedParserBenchmark, CommandTypeThroughput) {
+    const std::vector<std::string> names = {"get", "set", "mg", "append", "stats", "ms", "gets", "add", "prepend", "mn"};
+    const int rounds = 1000000;
+
+    size_t found = 0;
+    auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < rounds; i++) {
+        const std::string &name = names[i % names.size()];
+        found += Protocol::command_type(name.data(), name.size()) != Protocol::CommandType::kUnknown;
+    }
+    double packed = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    ASSERT_EQ(rounds, found);
+
+    found = 0;
+    start = std::chrono::steady_clock::now();
+    for (int i = 0; i < rounds; i++) {
+        const std::string &name = names[i % names.size()];
+        found += (name == "set" || name == "add" || name == "append" || name == "prepend" || name == "get" ||
+                  name == "gets" || name == "scan" || name == "mg" || name == "md" || name == "ma" || name == "ms" ||
+                  name == "stats" || name == "mn");
+    }
+    double chain = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    ASSERT_EQ(rounds, found);
+
+    std::cout << "command dispatch: switch " << packed / rounds * 1e9 << " ns, compare chain " << chain / rounds * 1e9
+              << " ns" << std::endl;
+}
+
+// Prints command line parse throughput to watch for regressions
+TEST(MemcachedParserBenchmark, Throughput) {
+    const std::string key(40, 'k');
+    std::string input;
+    for (int i = 0; i < 100; i++) {
+        input += "set " + key + std::to_string(i) + " 0 0 10\r\n";
+        input += "get " + key + std::to_string(i) + " " + key + " " + key + "\r\n";
+    }
+
+    Protocol::Parser parser;
+    size_t total = 0, commands = 0;
+    auto start = std::chrono::steady_clock::now();
+    for (int round = 0; round < 2000; round++) {
+        size_t offset = 0;
+        while (offset < input.size()) {
+            size_t consumed = 0;
+            ASSERT_TRUE(parser.Parse(input.data() + offset, input.size() - offset, consumed));
+            offset += consumed;
+            parser.Reset();
+            commands++;
+        }
+        total += offset;
+    }
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    std::cout << "parse: " << commands / seconds / 1e6 << " Mcmd/s, " << total / seconds / (1 << 20) << " MB/s"
+              << std::endl;
+}
+
+// Compares batch parsing of a deep pipeline with the old one-command-then-memmove loop
+TEST(MemcachedParserBenchmark, PipelineThroughput) {
+    const std::string value(100, 'v');
+    std::string input;
+    for (int i = 0; i < 5000; i++) {
+        input += "set key" + std::to_string(i) + " 0 0 100\r\n" + value + "\r\n";
+        input += "get key" + std::to_string(i) + "\r\n";
+    }
+
+    size_t commands = 0;
+    auto start = std::chrono::steady_clock::now();
+    {
+        Protocol::Parser parser;
+        std::vector<Protocol::Parser::Request> requests;
+        std::string buffer = input;
+        parser.ParseBatch(&buffer[0], buffer.size(), requests);
+        commands = requests.size();
+    }
+    double batch = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    ASSERT_EQ(10000, commands);
+
+    commands = 0;
+    start = std::chrono::steady_clock::now();
+    {
+        Protocol::Parser parser;
+        std::string buffer = input;
+        size_t readed_bytes = buffer.size();
+        while (readed_bytes > 0) {
+            size_t parsed = 0;
+            ASSERT_TRUE(parser.Parse(&buffer[0], readed_bytes, parsed));
+            size_t body_size = 0;
+            std::unique_ptr<Execute::Command> cmd = parser.Build(body_size);
+            parser.Reset();
+            if (body_size > 0) {
+                parsed += body_size + 2;
+            }
+            std::memmove(&buffer[0], &buffer[0] + parsed, readed_bytes - parsed);
+            readed_bytes -= parsed;
+            commands++;
+        }
+    }
+    double single = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    ASSERT_EQ(10000, commands);
+
+    std::cout << "pipeline of " << commands << " commands (" << input.size() / 1024 << " KB): batch " << batch * 1e3
+              << " ms, memmove loop " << single * 1e3 << " ms" << std::endl;
+}
+
+// Parses and executes deep pipeline of SET/GET fed by 4K reads the way network layer does
+TEST(RespParserBenchmark, PipelineThroughput) {
+    const std::string value(100, 'v');
+    const int count = 50000;
+
+    std::string input;
+    for (int i = 0; i < count; i++) {
+        std::string key = "key" + std::to_string(i % 1000);
+        input += command({"SET", key, value}) + command({"GET", key});
+    }
+
+    Backend::SimpleLRU storage(64 * 1024 * 1024);
+    RespParser parser;
+    std::vector<RespParser::Request> requests;
+    std::vector<ValueChunk> chunks;
+    size_t executed = 0, replied = 0;
+
+    auto start = std::chrono::steady_clock::now();
+    for (size_t offset = 0; offset < input.size(); offset += 4096) {
+        parser.ParseBatch(input.data() + offset, std::min<size_t>(4096, input.size() - offset), requests);
+        for (auto &request : requests) {
+            request.command->ExecuteOwned(storage, std::move(request.argument), chunks);
+        }
+        executed += requests.size();
+        requests.clear();
+
+        for (auto &chunk : chunks) {
+            replied += chunk->size();
+        }
+        chunks.clear();
+    }
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    ASSERT_EQ(2 * count, executed);
+    std::cout << "resp pipeline: " << executed / seconds / 1e6 << " Mcmd/s, " << input.size() / seconds / (1 << 20)
+              << " MB/s in, " << replied / seconds / (1 << 20) << " MB/s out" << std::endl;
+}
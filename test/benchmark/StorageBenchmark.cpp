@@ -0,0 +1,43 @@
+#include <gtest/gtest.h>
+
+#include <chrono>
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "storage/ConcurrentHash.h"
+
+using namespace Afina::Backend;
+
+// Read throughput for different number of threads, Get never takes a lock so it is expected
+// to scale with the number of cores
+TEST(ConcurrentHashBenchmark, ReadScaling) {
+    ConcurrentHash storage(1024 * 1024);
+    for (int i = 0; i < 1000; ++i) {
+        storage.Put("key" + std::to_string(i), "value");
+    }
+
+    for (int threads_count : {1, 2, 4, 8, 16, 32}) {
+        const int ops = 20000;
+        std::vector<std::thread> threads;
+
+        auto start = std::chrono::steady_clock::now();
+        for (int t = 0; t < threads_count; ++t) {
+            threads.emplace_back([&storage, t]() {
+                std::string value;
+                for (int i = 0; i < ops; ++i) {
+                    storage.Get("key" + std::to_string((i + t) % 1000), value);
+                }
+            });
+        }
+        for (auto &t : threads) {
+            t.join();
+        }
+        double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+        std::cout << std::setw(3) << threads_count << " threads: " << std::fixed << std::setprecision(0)
+                  << (threads_count * ops) / seconds << " gets/sec" << std::endl;
+    }
+}
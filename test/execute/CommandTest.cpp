@@ -0,0 +1,676 @@
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <ctime>
+#include <map>
+#include <memory>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <unistd.h>
+
+#include <afina/execute/Counters.h>
+#include <afina/execute/Delete.h>
+#include <afina/execute/Dispatcher.h>
+#include <afina/execute/FlushAll.h>
+#include <afina/execute/Gat.h>
+#include <afina/execute/Get.h>
+#include <afina/execute/Meta.h>
+#include <afina/execute/OutputSink.h>
+#include <afina/execute/Prepend.h>
+#include <afina/execute/Replace.h>
+#include <afina/execute/Resp.h>
+#include <afina/execute/ResponseCache.h>
+#include <afina/execute/Scan.h>
+#include <afina/execute/Set.h>
+#include <afina/execute/Stats.h>
+#include <afina/execute/Touch.h>
+
+#include "storage/ARC.h"
+#include "storage/SimpleLRU.h"
+#include "storage/ThreadSafeSimpleLRU.h"
+#include "storage/Versioned.h"
+
+using namespace Afina::Backend;
+using namespace Afina::Execute;
+
+TEST(CommandTest, ScanWalksChunks) {
+    SimpleLRU storage(100000);
+
+    std::string expected;
+    for (int i = 0; i < 3 * Scan::kChunkSize; ++i) {
+        std::string key = "key:" + std::to_string(100000 + i);
+        EXPECT_TRUE(storage.Put(key, "v"));
+        if (i < 2 * Scan::kChunkSize + 1) {
+            expected += "KEY " + key + "\r\n";
+        }
+    }
+    EXPECT_TRUE(storage.Put("other", "v"));
+    expected += "END";
+
+    std::string out;
+    Scan scan("key:", "", 2 * Scan::kChunkSize + 1);
+    scan.Execute(storage, "", out);
+    EXPECT_EQ(expected, out);
+}
+
+TEST(CommandTest, ScanEmpty) {
+    SimpleLRU storage;
+    EXPECT_TRUE(storage.Put("key", "v"));
+
+    std::string out;
+    Scan scan("nope", "", Scan::kDefaultLimit);
+    scan.Execute(storage, "", out);
+    EXPECT_EQ("END", out);
+}
+
+// Storage without ordered walk is never taken for an empty one
+TEST(CommandTest, ScanUnsupported) {
+    ARC storage(1024);
+    EXPECT_TRUE(storage.Put("key:1", "v"));
+
+    std::string out;
+    Scan scan("key:", "", Scan::kDefaultLimit);
+    scan.Execute(storage, "", out);
+    EXPECT_EQ("SERVER_ERROR scan is not supported by the storage", out);
+}
+
+TEST(CommandTest, GetChunked) {
+    SimpleLRU storage(1024 * 1024);
+
+    std::string big(2 * ChunkPool::kChunkSize + 1, 'b');
+    EXPECT_TRUE(storage.Put("big", big));
+    EXPECT_TRUE(storage.Put("small", "val"));
+
+    std::vector<Afina::ValueChunk> out;
+    Get get({"small", "none", "big"});
+    get.ExecuteChunked(storage, "", out);
+
+    std::string joined;
+    for (auto &chunk : out) {
+        joined += *chunk;
+    }
+
+    std::string expected;
+    get.Execute(storage, "", expected);
+    EXPECT_TRUE(expected == joined);
+    EXPECT_EQ("VALUE small 0 3\r\nval\r\nVALUE big 0 " + std::to_string(big.size()) + "\r\n" + big + "\r\nEND",
+              joined);
+}
+
+namespace {
+
+std::string joined(OutputSink &sink) {
+    std::string result;
+    for (auto &part : sink.Iov()) {
+        result.append(static_cast<const char *>(part.iov_base), part.iov_len);
+    }
+    return result;
+}
+
+} // namespace
+
+TEST(CommandTest, OutputSink) {
+    OutputSink sink;
+    sink.Append("VALUE ");
+    sink.AppendNumber(0);
+    sink.Append(std::string(" "));
+    sink.AppendNumber(18446744073709551615ull);
+    sink.Reference(std::make_shared<std::string>("value"));
+    sink.Append("\r\n", 2);
+
+    // Text written in a row is a single part
+    ASSERT_EQ(3, sink.Iov().size());
+    ASSERT_EQ("VALUE 0 18446744073709551615value\r\n", joined(sink));
+    ASSERT_EQ(35, sink.Size());
+
+    OutputSink::Mark mark = sink.Position();
+    sink.Append("dropped");
+    sink.Reference(std::make_shared<std::string>("dropped too"));
+    ASSERT_EQ(18, sink.Written(mark));
+    sink.Truncate(mark);
+    ASSERT_EQ("VALUE 0 18446744073709551615value\r\n", joined(sink));
+
+    sink.Clear();
+    ASSERT_TRUE(sink.Empty());
+    ASSERT_EQ(0, sink.Iov().size());
+}
+
+TEST(CommandTest, GetToSink) {
+    SimpleLRU storage(1024 * 1024);
+
+    std::string big(2 * ChunkPool::kChunkSize + 1, 'b');
+    EXPECT_TRUE(storage.Put("big", big));
+    EXPECT_TRUE(storage.Put("small", "val"));
+
+    std::vector<Afina::ValueChunk> chunks;
+    EXPECT_TRUE(storage.GetChunks("big", chunks));
+
+    OutputSink sink;
+    Get get({"small", "none", "big"});
+    get.ExecuteTo(storage, std::string(), sink);
+
+    std::string expected;
+    get.Execute(storage, "", expected);
+    EXPECT_TRUE(expected == joined(sink));
+
+    // Value bytes are sent right from the storage chunks
+    std::size_t referenced = 0;
+    for (auto &part : sink.Iov()) {
+        for (auto &chunk : chunks) {
+            referenced += (part.iov_base == chunk->data()) ? 1 : 0;
+        }
+    }
+    EXPECT_EQ(chunks.size(), referenced);
+}
+
+TEST(CommandTest, MetaGet) {
+    SimpleLRU storage;
+    EXPECT_TRUE(storage.Put("key", "value"));
+
+    std::string out;
+    MetaGet("key", {"s", "v", "Oxyz", "k"}).Execute(storage, "", out);
+    EXPECT_EQ("VA 5 s5 Oxyz kkey\r\nvalue", out);
+
+    MetaGet("key", {"s", "t", "f"}).Execute(storage, "", out);
+    EXPECT_EQ("HD s5 t-1 f0", out);
+
+    // Remaining TTL is rounded up
+    EXPECT_TRUE(storage.Touch("key", 100));
+    MetaGet("key", {"t"}).Execute(storage, "", out);
+    EXPECT_EQ("HD t100", out);
+
+    MetaGet("none", {"v"}).Execute(storage, "", out);
+    EXPECT_EQ("EN", out);
+
+    // Quiet miss produces no response at all
+    std::vector<Afina::ValueChunk> chunks;
+    MetaGet("none", {"v", "q"}).ExecuteChunked(storage, "", chunks);
+    EXPECT_TRUE(chunks.empty());
+}
+
+TEST(CommandTest, MetaSet) {
+    SimpleLRU storage;
+    std::string out, value;
+
+    MetaSet("key", {"O1"}).Execute(storage, "abc", out);
+    EXPECT_EQ("HD O1", out);
+
+    MetaSet("key", {"ME"}).Execute(storage, "new", out);
+    EXPECT_EQ("NS", out);
+
+    MetaSet("key", {"MA", "q"}).Execute(storage, "def", out);
+    EXPECT_EQ("", out);
+
+    MetaSet("key", {"MP"}).Execute(storage, "0", out);
+    EXPECT_EQ("HD", out);
+    EXPECT_TRUE(storage.Get("key", value));
+    EXPECT_EQ("0abcdef", value);
+
+    MetaSet("none", {"MR", "q"}).Execute(storage, "x", out);
+    EXPECT_EQ("NS", out);
+
+    // T sets expiration, append keeps it and replace without T drops it
+    int64_t ttl = 0;
+    MetaSet("key", {"T100"}).Execute(storage, "abc", out);
+    EXPECT_TRUE(storage.TimeToLive("key", ttl));
+    EXPECT_EQ(100, ttl);
+    MetaSet("key", {"MA"}).Execute(storage, "d", out);
+    EXPECT_TRUE(storage.TimeToLive("key", ttl));
+    EXPECT_EQ(100, ttl);
+    MetaSet("key", {"MR"}).Execute(storage, "xyz", out);
+    EXPECT_TRUE(storage.TimeToLive("key", ttl));
+    EXPECT_EQ(-1, ttl);
+    MetaSet("key", {"T-1"}).Execute(storage, "abc", out);
+    EXPECT_EQ("HD", out);
+    EXPECT_FALSE(storage.Get("key", value));
+
+    EXPECT_THROW(MetaSet("key", {"MX"}), std::runtime_error);
+    EXPECT_THROW(MetaSet("key", {"Tabc"}), std::runtime_error);
+}
+
+TEST(CommandTest, MetaDelete) {
+    SimpleLRU storage;
+    EXPECT_TRUE(storage.Put("key", "value"));
+
+    std::string out;
+    MetaDelete("key", {"k"}).Execute(storage, "", out);
+    EXPECT_EQ("HD kkey", out);
+
+    MetaDelete("key", {}).Execute(storage, "", out);
+    EXPECT_EQ("NF", out);
+
+    MetaDelete("key", {"q"}).Execute(storage, "", out);
+    EXPECT_EQ("", out);
+}
+
+TEST(CommandTest, MetaArithmetic) {
+    SimpleLRU storage;
+    std::string out, value;
+
+    MetaArithmetic("cnt", {}).Execute(storage, "", out);
+    EXPECT_EQ("NF", out);
+
+    MetaArithmetic("cnt", {"N0", "J10", "v"}).Execute(storage, "", out);
+    EXPECT_EQ("VA 2\r\n10", out);
+
+    MetaArithmetic("cnt", {"D5", "q"}).Execute(storage, "", out);
+    EXPECT_EQ("", out);
+    EXPECT_TRUE(storage.Get("cnt", value));
+    EXPECT_EQ("15", value);
+
+    MetaArithmetic("cnt", {"MD", "D100", "v"}).Execute(storage, "", out);
+    EXPECT_EQ("VA 1\r\n0", out);
+
+    // Item created by N expires the way N asks
+    int64_t ttl = 0;
+    MetaArithmetic("new", {"N100"}).Execute(storage, "", out);
+    EXPECT_EQ("HD", out);
+    EXPECT_TRUE(storage.TimeToLive("new", ttl));
+    EXPECT_EQ(100, ttl);
+
+    EXPECT_TRUE(storage.Put("str", "abc"));
+    MetaArithmetic("str", {}).Execute(storage, "", out);
+    EXPECT_EQ("NS", out);
+}
+
+TEST(CommandTest, MetaNoop) {
+    SimpleLRU storage;
+    std::string out;
+    MetaNoop().Execute(storage, "", out);
+    EXPECT_EQ("MN", out);
+}
+
+TEST(CommandTest, MemcachedTtl) {
+    EXPECT_EQ(0, memcached_ttl(0));
+    EXPECT_EQ(100, memcached_ttl(100));
+    EXPECT_EQ(-1, memcached_ttl(-1));
+    EXPECT_EQ(2592000, memcached_ttl(2592000));
+
+    // Larger values are unix time
+    int64_t now = std::time(nullptr);
+    EXPECT_EQ(-1, memcached_ttl(now - 10));
+    EXPECT_NEAR(100, memcached_ttl(now + 100), 1);
+}
+
+TEST(CommandTest, DeleteTouch) {
+    SimpleLRU storage;
+    std::string out, value;
+
+    Delete("key").Execute(storage, "", out);
+    EXPECT_EQ("NOT_FOUND", out);
+    Touch("key", 100).Execute(storage, "", out);
+    EXPECT_EQ("NOT_FOUND", out);
+
+    EXPECT_TRUE(storage.Put("key", "value"));
+    Touch("key", 100).Execute(storage, "", out);
+    EXPECT_EQ("TOUCHED", out);
+    EXPECT_TRUE(storage.Get("key", value));
+    EXPECT_EQ("value", value);
+
+    // Negative expiration time expires item right away
+    Touch("key", -1).Execute(storage, "", out);
+    EXPECT_EQ("TOUCHED", out);
+    EXPECT_FALSE(storage.Get("key", value));
+
+    EXPECT_TRUE(storage.Put("key", "value"));
+    Delete("key").Execute(storage, "", out);
+    EXPECT_EQ("DELETED", out);
+    EXPECT_FALSE(storage.Get("key", value));
+}
+
+TEST(CommandTest, Gat) {
+    SimpleLRU storage;
+    EXPECT_TRUE(storage.Put("a", "1"));
+    EXPECT_TRUE(storage.Put("b", "22"));
+
+    // Value stays the very same buffer, only expiration time changes
+    std::vector<Afina::ValueChunk> before;
+    EXPECT_TRUE(storage.GetChunks("b", before));
+
+    std::string out;
+    Gat(100, {"a", "b", "c"}).Execute(storage, "", out);
+    EXPECT_EQ("VALUE a 0 1\r\n1\r\nVALUE b 0 2\r\n22\r\nEND", out);
+
+    std::vector<Afina::ValueChunk> after;
+    EXPECT_TRUE(storage.GetChunks("b", after));
+    EXPECT_EQ(before, after);
+
+    std::vector<Afina::ValueChunk> chunks;
+    Gat(-1, {"a"}).ExecuteChunked(storage, "", chunks);
+    std::string response;
+    for (auto &chunk : chunks) {
+        response += *chunk;
+    }
+    // Item expired by gat is a miss
+    EXPECT_EQ("END", response);
+
+    std::string value;
+    EXPECT_FALSE(storage.Get("a", value));
+}
+
+TEST(CommandTest, StorageCommandsExpire) {
+    SimpleLRU storage;
+    std::string out, value;
+
+    Set("key", 0, -1).Execute(storage, "value", out);
+    EXPECT_EQ("STORED", out);
+    EXPECT_FALSE(storage.Get("key", value));
+
+    Replace("key", 0, 0).Execute(storage, "value", out);
+    EXPECT_EQ("NOT_STORED", out);
+
+    EXPECT_TRUE(storage.Put("key", "value"));
+    Replace("key", 0, -1).Execute(storage, "other", out);
+    EXPECT_EQ("STORED", out);
+    EXPECT_FALSE(storage.Get("key", value));
+
+    Replace("key", 0, 0).Execute(storage, "value", out);
+    EXPECT_EQ("NOT_STORED", out);
+}
+
+TEST(CommandTest, PrependFlushAll) {
+    SimpleLRU storage;
+    std::string out, value;
+
+    Prepend("key", 0, 0).Execute(storage, "abc", out);
+    EXPECT_EQ("NOT_STORED", out);
+
+    EXPECT_TRUE(storage.Put("key", "def"));
+    Prepend("key", 0, 0).Execute(storage, "abc", out);
+    EXPECT_EQ("STORED", out);
+    EXPECT_TRUE(storage.Get("key", value));
+    EXPECT_EQ("abcdef", value);
+
+    FlushAll(10).Execute(storage, "", out);
+    EXPECT_EQ("CLIENT_ERROR delayed flush_all is not supported", out);
+    EXPECT_TRUE(storage.Get("key", value));
+
+    FlushAll(0).Execute(storage, "", out);
+    EXPECT_EQ("OK", out);
+    EXPECT_FALSE(storage.Get("key", value));
+
+    EXPECT_TRUE(storage.Put("key", "value"));
+    EXPECT_TRUE(storage.Get("key", value));
+}
+
+TEST(CommandTest, RespGet) {
+    SimpleLRU storage(1024 * 1024);
+    std::string big(2 * ChunkPool::kChunkSize + 1, 'b');
+    EXPECT_TRUE(storage.Put("big", big));
+
+    // Value is sent right out of storage chunks
+    std::vector<Afina::ValueChunk> chunks;
+    RespGet("big").ExecuteChunked(storage, "", chunks);
+    ASSERT_LT(2, chunks.size());
+    EXPECT_EQ("$" + std::to_string(big.size()) + "\r\n", *chunks[0]);
+
+    std::string out;
+    RespGet("big").Execute(storage, "", out);
+    EXPECT_TRUE("$" + std::to_string(big.size()) + "\r\n" + big == out);
+
+    RespGet("none").Execute(storage, "", out);
+    EXPECT_EQ("$-1", out);
+}
+
+TEST(CommandTest, RespSet) {
+    SimpleLRU storage;
+    std::string out, value;
+
+    RespSet("key", RespSet::Condition::IfPresent, 0).Execute(storage, "abc", out);
+    EXPECT_EQ("$-1", out);
+
+    RespSet("key", RespSet::Condition::IfAbsent, 0).Execute(storage, "abc", out);
+    EXPECT_EQ("+OK", out);
+    RespSet("key", RespSet::Condition::IfAbsent, 0).Execute(storage, "def", out);
+    EXPECT_EQ("$-1", out);
+
+    std::vector<Afina::ValueChunk> chunks;
+    RespSet("key", RespSet::Condition::Always, 0).ExecuteOwned(storage, std::string("xyz"), chunks);
+    ASSERT_EQ(1, chunks.size());
+    EXPECT_EQ("+OK", *chunks[0]);
+    EXPECT_TRUE(storage.Get("key", value));
+    EXPECT_EQ("xyz", value);
+
+    RespSet("key", RespSet::Condition::Always, 0).Execute(storage, std::string(2048, 'x'), out);
+    EXPECT_EQ("-ERR value is too large to be stored", out);
+}
+
+TEST(CommandTest, RespDeleteExpire) {
+    SimpleLRU storage;
+    EXPECT_TRUE(storage.Put("k1", "v1"));
+    EXPECT_TRUE(storage.Put("k2", "v2"));
+
+    std::string out;
+    RespExpire("k1", 100).Execute(storage, "", out);
+    EXPECT_EQ(":1", out);
+    RespExpire("none", 100).Execute(storage, "", out);
+    EXPECT_EQ(":0", out);
+    RespExpire("k1", -1).Execute(storage, "", out);
+    EXPECT_EQ(":1", out);
+
+    RespDelete({"k1", "k2", "none"}).Execute(storage, "", out);
+    EXPECT_EQ(":1", out);
+}
+
+TEST(CommandTest, RespIncrement) {
+    SimpleLRU storage;
+    std::string out, value;
+
+    RespIncrement("cnt", 10).Execute(storage, "", out);
+    EXPECT_EQ(":10", out);
+    RespIncrement("cnt", -15).Execute(storage, "", out);
+    EXPECT_EQ(":-5", out);
+    EXPECT_TRUE(storage.Get("cnt", value));
+    EXPECT_EQ("-5", value);
+
+    EXPECT_TRUE(storage.Put("max", "9223372036854775807"));
+    RespIncrement("max", 1).Execute(storage, "", out);
+    EXPECT_EQ("-ERR increment or decrement would overflow", out);
+
+    EXPECT_TRUE(storage.Put("str", " 1"));
+    RespIncrement("str", 1).Execute(storage, "", out);
+    EXPECT_EQ("-ERR value is not an integer or out of range", out);
+}
+
+namespace {
+
+// Parses "STAT <name> <value>" lines of the stats response
+std::map<std::string, std::string> parse_stats(const std::string &out) {
+    std::map<std::string, std::string> stats;
+    std::istringstream stream(out);
+    std::string line;
+    while (std::getline(stream, line) && line.compare(0, 5, "STAT ") == 0) {
+        std::istringstream fields(line.substr(5));
+        std::string name, value;
+        fields >> name >> value;
+        stats[name] = value;
+    }
+    return stats;
+}
+
+} // namespace
+
+TEST(CommandTest, Stats) {
+    SimpleLRU storage(1024);
+    std::string out;
+
+    // Counters are process wide, other tests have counted something already
+    uint64_t before[Counters::kCount];
+    Counters::Collect(before);
+
+    Set("key", 0, 0).Execute(storage, "value", out);
+    Get({"key", "missing", "key"}).Execute(storage, "", out);
+    MetaGet("missing", {"v"}).Execute(storage, "", out);
+    RespGet("key").Execute(storage, "", out);
+    Touch("key", 0).Execute(storage, "", out);
+    Delete("missing").Execute(storage, "", out);
+
+    Stats().Execute(storage, "", out);
+    ASSERT_EQ("END", out.substr(out.size() - 3));
+    auto stats = parse_stats(out);
+
+    auto delta = [&](const char *name, Counters::Counter counter) {
+        return std::stoull(stats.at(name)) - before[counter];
+    };
+    EXPECT_EQ(5, delta("cmd_get", Counters::kCmdGet));
+    EXPECT_EQ(3, delta("get_hits", Counters::kGetHits));
+    EXPECT_EQ(2, delta("get_misses", Counters::kGetMisses));
+    EXPECT_EQ(1, delta("cmd_set", Counters::kCmdSet));
+    EXPECT_EQ(1, delta("cmd_touch", Counters::kCmdTouch));
+    EXPECT_EQ(1, delta("touch_hits", Counters::kTouchHits));
+    EXPECT_EQ(1, delta("delete_misses", Counters::kDeleteMisses));
+    EXPECT_EQ(0, delta("delete_hits", Counters::kDeleteHits));
+
+    EXPECT_EQ("1", stats.at("curr_items"));
+    EXPECT_EQ("0", stats.at("evictions"));
+    EXPECT_EQ(1, stats.count("bytes"));
+    EXPECT_EQ(1, stats.count("rusage_user"));
+    EXPECT_EQ(1, stats.count("rusage_system"));
+    EXPECT_EQ(1, stats.count("curr_connections"));
+    EXPECT_EQ(1, stats.count("total_connections"));
+    EXPECT_EQ(std::to_string(getpid()), stats.at("pid"));
+}
+
+TEST(CommandTest, CountersOfFinishedThreads) {
+    const int threads = 4, count = 1000;
+    uint64_t opened = Counters::Get(Counters::kConnectionsOpened);
+    uint64_t closed = Counters::Get(Counters::kConnectionsClosed);
+
+    std::vector<std::thread> workers;
+    for (int t = 0; t < threads; t++) {
+        workers.emplace_back([]() {
+            for (int i = 0; i < count; i++) {
+                Counters::Add(Counters::kConnectionsOpened);
+            }
+            Counters::Add(Counters::kConnectionsClosed, count);
+        });
+    }
+    for (auto &worker : workers) {
+        worker.join();
+    }
+
+    // Slots of the threads are gone, their counts are not
+    EXPECT_EQ(opened + threads * count, Counters::Get(Counters::kConnectionsOpened));
+    EXPECT_EQ(closed + threads * count, Counters::Get(Counters::kConnectionsClosed));
+}
+
+TEST(CommandTest, StaticDispatch) {
+    ThreadSafeSimplLRU storage(1024 * 1024);
+    StaticDispatcher<ThreadSafeSimplLRU> dispatcher;
+    OutputSink sink;
+
+    Set set("a", 0, 0);
+    EXPECT_TRUE(set.kind() == Command::Kind::kSet);
+    dispatcher.ExecuteTo(storage, set, "xy", sink);
+    EXPECT_EQ("STORED", joined(sink));
+
+    sink.Clear();
+    Get get({"a", "b"});
+    EXPECT_TRUE(get.kind() == Command::Kind::kGet);
+    dispatcher.ExecuteTo(storage, get, std::string(), sink);
+    EXPECT_EQ("VALUE a 0 2\r\nxy\r\nEND", joined(sink));
+
+    // Commands derived from get are not taken for it, they go through the virtual call
+    sink.Clear();
+    Gat gat(-1, {"a"});
+    EXPECT_TRUE(gat.kind() == Command::Kind::kOther);
+    dispatcher.ExecuteTo(storage, gat, std::string(), sink);
+    EXPECT_EQ("END", joined(sink));
+
+    sink.Clear();
+    Delete del("a");
+    dispatcher.ExecuteTo(storage, del, std::string(), sink);
+    EXPECT_EQ("NOT_FOUND", joined(sink));
+}
+
+TEST(CommandTest, GetBatch) {
+    ThreadSafeSimplLRU locked(1024 * 1024);
+    SimpleLRU plain(1024 * 1024);
+    std::string big(2 * ChunkPool::kChunkSize + 1, 'b');
+
+    for (Afina::Storage *storage : {static_cast<Afina::Storage *>(&locked), static_cast<Afina::Storage *>(&plain)}) {
+        EXPECT_TRUE(storage->Put("a", "1"));
+        EXPECT_TRUE(storage->Put("empty", ""));
+        EXPECT_TRUE(storage->Put("big", big));
+
+        Get first({"a"}), second({"none", "big", "empty"}), third({"none"}), fourth({"big", "a"});
+        Get *gets[] = {&first, &second, &third, &fourth};
+
+        std::string expected;
+        for (auto get : gets) {
+            OutputSink single;
+            get->ExecuteTo(*storage, std::string(), single);
+            expected += joined(single) + "\r\n";
+        }
+
+        OutputSink sink;
+        sink.Append("before", 6);
+        Get::ExecuteBatch(*storage, gets, 4, sink);
+        EXPECT_TRUE("before" + expected == joined(sink));
+    }
+}
+
+TEST(CommandTest, ResponseCache) {
+    auto storage = std::make_shared<ThreadSafeSimplLRU>(1024 * 1024);
+    Versioned versioned(storage);
+    ResponseCache cache(std::make_shared<StaticDispatcher<Versioned>>(), 60000);
+    EXPECT_TRUE(versioned.Put("a", "1"));
+    EXPECT_TRUE(versioned.Put("b", "22"));
+
+    auto get = [&](Command &command) {
+        OutputSink sink;
+        sink.Append("x", 1); // response is copied out of the sink that has something already
+        cache.ExecuteTo(versioned, command, std::string(), sink);
+        return joined(sink).substr(1);
+    };
+
+    uint64_t hits = Counters::Get(Counters::kResponseCacheHits);
+    uint64_t misses = Counters::Get(Counters::kResponseCacheMisses);
+    Get multi({"a", "b", "c"});
+    EXPECT_EQ("VALUE a 0 1\r\n1\r\nVALUE b 0 2\r\n22\r\nEND", get(multi));
+    EXPECT_EQ("VALUE a 0 1\r\n1\r\nVALUE b 0 2\r\n22\r\nEND", get(multi));
+    EXPECT_EQ(hits + 1, Counters::Get(Counters::kResponseCacheHits));
+    EXPECT_EQ(misses + 1, Counters::Get(Counters::kResponseCacheMisses));
+
+    // Changes of the keys, the missing ones included, are seen at once
+    EXPECT_TRUE(storage->Put("b", "3"));
+    EXPECT_EQ("VALUE a 0 1\r\n1\r\nVALUE b 0 2\r\n22\r\nEND", get(multi)) << "storage changed behind the back";
+    EXPECT_TRUE(versioned.Put("c", "4"));
+    EXPECT_EQ("VALUE a 0 1\r\n1\r\nVALUE b 0 1\r\n3\r\nVALUE c 0 1\r\n4\r\nEND", get(multi));
+    EXPECT_TRUE(versioned.Delete("a"));
+    EXPECT_EQ("VALUE b 0 1\r\n3\r\nVALUE c 0 1\r\n4\r\nEND", get(multi));
+    EXPECT_TRUE(versioned.Clear());
+    EXPECT_EQ("END", get(multi));
+    EXPECT_EQ(hits + 2, Counters::Get(Counters::kResponseCacheHits));
+
+    // Single key gets and gats are executed every time
+    EXPECT_TRUE(versioned.Put("a", "1"));
+    Get single({"a"});
+    Gat gat(0, {"a", "b"});
+    EXPECT_EQ("VALUE a 0 1\r\n1\r\nEND", get(single));
+    EXPECT_EQ("VALUE a 0 1\r\n1\r\nEND", get(gat));
+    EXPECT_EQ("VALUE a 0 1\r\n1\r\nEND", get(gat));
+    EXPECT_EQ(misses + 4, Counters::Get(Counters::kResponseCacheMisses));
+
+    // Pipelined multi-gets are cached as well, single key ones are still batched
+    Get second({"a", "b"});
+    Get *gets[] = {&single, &multi, &second, &single};
+    OutputSink sink;
+    cache.ExecuteGets(versioned, gets, 4, sink);
+    cache.ExecuteGets(versioned, gets, 4, sink);
+    std::string pipeline = "VALUE a 0 1\r\n1\r\nEND\r\n"
+                           "VALUE a 0 1\r\n1\r\nEND\r\n"
+                           "VALUE a 0 1\r\n1\r\nEND\r\n"
+                           "VALUE a 0 1\r\n1\r\nEND\r\n";
+    EXPECT_EQ(pipeline + pipeline, joined(sink));
+    EXPECT_EQ(hits + 4, Counters::Get(Counters::kResponseCacheHits));
+
+    // Stale responses are dropped once shard is full
+    for (std::size_t i = 0; i < ResponseCache::kShards * ResponseCache::kShardCapacity * 2; i++) {
+        Get other({"a", std::to_string(i)});
+        EXPECT_EQ("VALUE a 0 1\r\n1\r\nEND", get(other));
+    }
+}
@@ -0,0 +1,95 @@
+#include <gtest/gtest.h>
+
+#include <cstdint>
+#include <map>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <afina/execute/Latency.h>
+#include <afina/execute/Stats.h>
+
+#include "storage/SimpleLRU.h"
+
+using namespace Afina::Execute;
+
+namespace {
+
+std::map<std::string, std::string> report() {
+    std::vector<std::pair<std::string, std::string>> stats;
+    Latency::Report(stats);
+    return std::map<std::string, std::string>(stats.begin(), stats.end());
+}
+
+} // namespace
+
+TEST(LatencyTest, Buckets) {
+    // Small values are exact
+    for (uint64_t value = 0; value < 2 * Histogram::kSubBuckets; value++) {
+        EXPECT_EQ(value, Histogram::Bucket(value));
+        EXPECT_EQ(value, Histogram::Highest(value));
+    }
+
+    // Bucket is never wider than 1/16 of its values and buckets follow each other without gaps
+    for (std::size_t bucket = 1; bucket < Histogram::kBuckets; bucket++) {
+        uint64_t lowest = Histogram::Highest(bucket - 1) + 1;
+        uint64_t highest = Histogram::Highest(bucket);
+        ASSERT_EQ(bucket, Histogram::Bucket(lowest));
+        ASSERT_EQ(bucket, Histogram::Bucket(highest));
+        ASSERT_LE(highest - lowest, lowest / Histogram::kSubBuckets);
+    }
+
+    EXPECT_EQ(Histogram::kBuckets - 1, Histogram::Bucket(UINT64_MAX));
+}
+
+TEST(LatencyTest, Percentiles) {
+    Histogram histogram;
+    Histogram::Counts counts = {};
+    EXPECT_EQ(0, Histogram::Percentile(counts, 0.5));
+
+    for (uint64_t value = 1; value <= 10000; value++) {
+        histogram.Record(value);
+    }
+    histogram.Collect(counts);
+
+    // Percentile is the highest value of its bucket, so it is off by one bucket width at most
+    auto near = [](uint64_t expected, uint64_t actual) {
+        return actual >= expected && actual <= expected + expected / Histogram::kSubBuckets;
+    };
+    EXPECT_PRED2(near, 5000, Histogram::Percentile(counts, 0.5));
+    EXPECT_PRED2(near, 9900, Histogram::Percentile(counts, 0.99));
+    EXPECT_PRED2(near, 9990, Histogram::Percentile(counts, 0.999));
+    EXPECT_PRED2(near, 10000, Histogram::Percentile(counts, 1.0));
+}
+
+TEST(LatencyTest, Report) {
+    std::size_t backend = Latency::Backend("report_test");
+    std::size_t series = Latency::Series("op");
+    EXPECT_EQ(backend, Latency::Backend("report_test"));
+    EXPECT_EQ(series, Latency::Series("op"));
+
+    // Histograms of the finished thread are kept
+    std::thread worker([&]() {
+        for (int i = 0; i < 99; i++) {
+            Latency::Record(backend, series, 20);
+        }
+    });
+    worker.join();
+    Latency::Record(backend, series, 100000);
+
+    auto stats = report();
+    EXPECT_EQ("100", stats.at("report_test:op:count"));
+    EXPECT_EQ("20", stats.at("report_test:op:p50"));
+    EXPECT_EQ("20", stats.at("report_test:op:p99"));
+    EXPECT_LE(100000, std::stoull(stats.at("report_test:op:p999")));
+    EXPECT_EQ(stats.at("report_test:op:p999"), stats.at("report_test:op:max"));
+
+    Afina::Backend::SimpleLRU storage;
+    std::string out;
+    Stats("latency").Execute(storage, "", out);
+    EXPECT_NE(std::string::npos, out.find("STAT report_test:op:count 100\r\n"));
+    EXPECT_EQ("END", out.substr(out.size() - 3));
+
+    Stats("unknown").Execute(storage, "", out);
+    EXPECT_EQ("CLIENT_ERROR unknown stats section unknown", out);
+}
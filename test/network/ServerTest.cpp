@@ -0,0 +1,433 @@
+#include <gtest/gtest.h>
+
+#include <cstring>
+#include <memory>
+#include <string>
+#include <thread>
+
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include <afina/execute/Counters.h>
+#include <afina/execute/Dispatcher.h>
+#include <afina/logging/Config.h>
+
+#include "logging/ServiceImpl.h"
+#include "network/RequestTimer.h"
+#include "network/Utils.h"
+#include "network/mt_blocking/ServerImpl.h"
+#include "network/st_nonblocking/ServerImpl.h"
+#include "protocol/Parser.h"
+#include "storage/ThreadSafeSimpleLRU.h"
+
+using namespace Afina;
+
+namespace {
+
+// Runs mt_blocking server on its own port for the lifetime of the test
+class ServerTest : public ::testing::Test {
+protected:
+    // Loggers are registered globally in spdlog, so service is shared by all tests
+    static void SetUpTestCase() {
+        std::shared_ptr<Logging::Config> config(new Logging::Config);
+        config->appenders["console"].type = Logging::Appender::Type::STDOUT;
+        Logging::Logger &root = config->loggers["root"];
+        root.level = Logging::Logger::Level::ERROR;
+        root.appenders.push_back("console");
+        logging.reset(new Logging::ServiceImpl(config));
+        logging->Start();
+    }
+
+    static void TearDownTestCase() {
+        logging->Stop();
+        logging.reset();
+    }
+
+    void SetUp() override {
+        storage.reset(new Backend::ThreadSafeSimplLRU(64 * 1024 * 1024));
+
+        port = 20000 + getpid() % 10000;
+        server.reset(new Network::MTblocking::ServerImpl(storage, logging));
+        server->Start(port, 1, 4);
+    }
+
+    void TearDown() override {
+        server->Stop();
+        server->Join();
+    }
+
+    int Connect() {
+        int sock = socket(AF_INET, SOCK_STREAM, 0);
+        EXPECT_GE(sock, 0);
+
+        struct sockaddr_in addr;
+        std::memset(&addr, 0, sizeof(addr));
+        addr.sin_family = AF_INET;
+        addr.sin_port = htons(port);
+        addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+        EXPECT_EQ(0, connect(sock, reinterpret_cast<struct sockaddr *>(&addr), sizeof(addr)));
+        return sock;
+    }
+
+    // Sends whole request from the separate thread while reading responses until they end with the given
+    // marker. Returns everything server sent
+    std::string Pipeline(const std::string &request, const std::string &marker) {
+        int sock = Connect();
+        std::thread sender([sock, &request]() {
+            std::size_t sent = 0;
+            while (sent < request.size()) {
+                ssize_t n = write(sock, request.data() + sent, request.size() - sent);
+                if (n <= 0) {
+                    break;
+                }
+                sent += n;
+            }
+        });
+
+        std::string response;
+        char buffer[64 * 1024];
+        while (response.size() < marker.size() ||
+               response.compare(response.size() - marker.size(), marker.size(), marker) != 0) {
+            ssize_t n = read(sock, buffer, sizeof(buffer));
+            if (n <= 0) {
+                break;
+            }
+            response.append(buffer, n);
+        }
+
+        sender.join();
+        close(sock);
+        return response;
+    }
+
+    static std::shared_ptr<Logging::Service> logging;
+
+    uint16_t port;
+    std::shared_ptr<Afina::Storage> storage;
+    std::shared_ptr<Network::Server> server;
+};
+
+std::shared_ptr<Logging::Service> ServerTest::logging;
+
+// Packet of the memcached binary protocol, response if magic is 0x81
+std::string binary_packet(uint8_t magic, uint8_t opcode, uint16_t status, const std::string &extras,
+                          const std::string &key, const std::string &value, uint32_t opaque) {
+    uint32_t body = uint32_t(extras.size() + key.size() + value.size());
+    const unsigned char header[] = {magic,
+                                    opcode,
+                                    uint8_t(key.size() >> 8),
+                                    uint8_t(key.size()),
+                                    uint8_t(extras.size()),
+                                    0,
+                                    uint8_t(status >> 8),
+                                    uint8_t(status),
+                                    uint8_t(body >> 24),
+                                    uint8_t(body >> 16),
+                                    uint8_t(body >> 8),
+                                    uint8_t(body),
+                                    uint8_t(opaque >> 24),
+                                    uint8_t(opaque >> 16),
+                                    uint8_t(opaque >> 8),
+                                    uint8_t(opaque),
+                                    0,
+                                    0,
+                                    0,
+                                    0,
+                                    0,
+                                    0,
+                                    0,
+                                    0};
+    return std::string(reinterpret_cast<const char *>(header), sizeof(header)) + extras + key + value;
+}
+
+} // namespace
+
+TEST_F(ServerTest, Noreply) {
+    std::string response = Pipeline("set a 0 0 1 noreply\r\nx\r\nappend a 0 0 1 noreply\r\ny\r\nget a\r\n", "END\r\n");
+    EXPECT_EQ("VALUE a 0 2\r\nxy\r\nEND\r\n", response);
+}
+
+TEST_F(ServerTest, LargeValue) {
+    std::string value(3 * 1024 * 1024 + 7, 'v');
+    for (size_t i = 0; i < value.size(); i += 4093) {
+        value[i] = 'a' + i % 26;
+    }
+
+    std::string response = Pipeline("get big\r\nset big 0 0 " + std::to_string(value.size()) + "\r\n" + value +
+                                         "\r\nget big\r\nmn\r\n",
+                                     "MN\r\n");
+    EXPECT_TRUE("END\r\nSTORED\r\nVALUE big 0 " + std::to_string(value.size()) + "\r\n" + value + "\r\nEND\r\nMN\r\n" ==
+                response);
+
+    std::string check;
+    EXPECT_TRUE(storage->Get("big", check));
+    EXPECT_TRUE(value == check);
+}
+
+TEST_F(ServerTest, Resp) {
+    std::shared_ptr<Network::Server> resp(new Network::MTblocking::ServerImpl(storage, logging));
+    resp->SetFrontend(Network::Server::Frontend::Resp);
+    resp->Start(port + 1, 1, 4);
+
+    // Value is large enough to be read right into the storage buffer
+    const std::string value(100000, 'v');
+    port++;
+    std::string response = Pipeline("*3\r\n$3\r\nSET\r\n$1\r\na\r\n$100000\r\n" + value +
+                                         "\r\n*2\r\n$3\r\nGET\r\n$1\r\na\r\n*1\r\n$4\r\nPING\r\n",
+                                     "+PONG\r\n");
+    port--;
+    resp->Stop();
+    resp->Join();
+    EXPECT_TRUE("+OK\r\n$100000\r\n" + value + "\r\n+PONG\r\n" == response);
+
+    // Both front ends share the storage
+    response = Pipeline("get a\r\n", "END\r\n");
+    EXPECT_TRUE("VALUE a 0 100000\r\n" + value + "\r\nEND\r\n" == response);
+}
+
+TEST_F(ServerTest, Stats) {
+    // Commands are recorded as soon as they are executed, so stats see the command before them
+    std::string response = Pipeline("mg a v\r\nstats latency\r\n", "END\r\n");
+    EXPECT_EQ(0, response.find("EN\r\n"));
+    EXPECT_NE(std::string::npos, response.find("STAT mt_blocking:mg:execute:count "));
+    EXPECT_NE(std::string::npos, response.find("STAT mt_blocking:mg:execute:p99 "));
+
+    response = Pipeline("stats\r\n", "END\r\n");
+    EXPECT_NE(std::string::npos, response.find("STAT cmd_get "));
+    EXPECT_NE(std::string::npos, response.find("STAT total_connections "));
+    EXPECT_EQ(std::string::npos, response.find("STAT curr_connections 0\r\n"));
+}
+
+TEST_F(ServerTest, Nonblocking) {
+    const std::string value(200000, 'v');
+    const std::string request = "set a 0 0 1 noreply\r\nx\r\nappend a 0 0 1\r\ny\r\nget a\r\nset big 0 0 200000\r\n" +
+                                value + "\r\nget big a\r\ndelete a noreply\r\nget a\r\nmn\r\n";
+    const std::string expected = "STORED\r\nVALUE a 0 2\r\nxy\r\nEND\r\nSTORED\r\nVALUE big 0 200000\r\n" + value +
+                                 "\r\nVALUE a 0 2\r\nxy\r\nEND\r\nEND\r\nMN\r\n";
+
+    // Commands run on the network thread or on the executor, responses come in order anyway
+    for (uint32_t threads : {0, 4}) {
+        std::shared_ptr<Network::Server> nonblocking(new Network::STnonblock::ServerImpl(storage, logging));
+        nonblocking->SetExecutorThreads(threads);
+        nonblocking->Start(port + 2, 1, 1);
+        port += 2;
+
+        std::string response = Pipeline(request, "MN\r\n");
+        EXPECT_TRUE(expected == response) << "executor threads: " << threads;
+
+        std::thread clients[4];
+        for (int i = 0; i < 4; i++) {
+            clients[i] = std::thread([this, i]() {
+                std::string key = "key" + std::to_string(i);
+                std::string request, expected;
+                for (int j = 0; j < 1000; j++) {
+                    request += "set " + key + " 0 0 " + std::to_string(std::to_string(j).size()) + "\r\n" +
+                               std::to_string(j) + "\r\nget " + key + "\r\n";
+                    expected += "STORED\r\nVALUE " + key + " 0 " + std::to_string(std::to_string(j).size()) + "\r\n" +
+                                std::to_string(j) + "\r\nEND\r\n";
+                }
+                EXPECT_EQ(expected + "MN\r\n", Pipeline(request + "mn\r\n", "MN\r\n"));
+            });
+        }
+        for (auto &client : clients) {
+            client.join();
+        }
+
+        port -= 2;
+        nonblocking->Stop();
+        nonblocking->Join();
+    }
+}
+
+TEST_F(ServerTest, NonblockingResp) {
+    std::shared_ptr<Network::Server> resp(new Network::STnonblock::ServerImpl(storage, logging));
+    resp->SetFrontend(Network::Server::Frontend::Resp);
+    resp->SetExecutorThreads(2);
+    resp->Start(port + 3, 1, 1);
+
+    port += 3;
+    std::string response =
+        Pipeline("*3\r\n$3\r\nSET\r\n$1\r\na\r\n$2\r\nxy\r\n*2\r\n$3\r\nGET\r\n$1\r\na\r\n*1\r\n$4\r\nPING\r\n",
+                 "+PONG\r\n");
+    port -= 3;
+    resp->Stop();
+    resp->Join();
+    EXPECT_EQ("+OK\r\n$2\r\nxy\r\n+PONG\r\n", response);
+}
+
+// Requests before the malformed one are answered, then connection is closed after the error
+TEST_F(ServerTest, ParseError) {
+    std::string response = Pipeline("set a 0 0 1\r\nx\r\nget a\r\nbogus\r\nget a\r\n", "never");
+    EXPECT_EQ("STORED\r\nVALUE a 0 1\r\nx\r\nEND\r\nCLIENT_ERROR Unknown command name: bogus\r\n", response);
+
+    std::shared_ptr<Network::Server> resp(new Network::STnonblock::ServerImpl(storage, logging));
+    resp->SetFrontend(Network::Server::Frontend::Resp);
+    resp->Start(port + 4, 1, 1);
+
+    port += 4;
+    response = Pipeline("*1\r\n$4\r\nPING\r\n*x\r\n*1\r\n$4\r\nPING\r\n", "never");
+    port -= 4;
+    resp->Stop();
+    resp->Join();
+    EXPECT_EQ("+PONG\r\n-ERR Protocol error: invalid header\r\n", response);
+}
+
+TEST(ExecuteRequestsTest, Timeout) {
+    Backend::ThreadSafeSimplLRU storage(1024 * 1024);
+    Execute::Dispatcher dispatcher;
+    Network::RequestTimer timer("test");
+    Protocol::Parser parser;
+    Execute::OutputSink output;
+
+    const std::string input = "set a 0 0 1\r\nx\r\nget b\r\nset c 0 0 1 noreply\r\nz\r\nmg a v\r\n"
+                              "mg b v L10\r\nmg b v L0\r\nmg b v L5000\r\nmn\r\n";
+    std::vector<Protocol::Parser::Request> requests;
+    parser.ParseBatch(input.data(), input.size(), requests);
+    ASSERT_EQ(8, requests.size());
+    EXPECT_TRUE(storage.Put("b", "y"));
+
+    // Requests were read a second ago and expire, but the fresh one and two that waited for 50ms. Of those
+    // only one with shorter client deadline expires, L0 doesn't lift server deadline
+    Network::stamp_requests(requests, 0);
+    for (auto &request : requests) {
+        request.received -= 1000000000;
+    }
+    requests[3].received += 1000000000;
+    requests[4].received += 950000000;
+    requests[6].received += 950000000;
+
+    uint64_t before = Execute::Counters::Get(Execute::Counters::kTimedOut);
+    timer.Parsed();
+    Network::execute_requests(dispatcher, storage, requests, output, timer, false, 100 * 1000000);
+
+    std::string response;
+    for (auto &part : output.Iov()) {
+        response.append(static_cast<const char *>(part.iov_base), part.iov_len);
+    }
+    EXPECT_EQ("SERVER_ERROR timeout\r\nSERVER_ERROR timeout\r\nEN\r\nSERVER_ERROR timeout\r\n"
+              "SERVER_ERROR timeout\r\nVA 1\r\ny\r\nMN\r\n",
+              response);
+    EXPECT_EQ(before + 5, Execute::Counters::Get(Execute::Counters::kTimedOut));
+
+    // Expired requests never touch storage
+    std::string value;
+    EXPECT_FALSE(storage.Get("a", value));
+    EXPECT_FALSE(storage.Get("c", value));
+}
+
+// Connection that starts with 0x80 speaks binary protocol, its commands change the same storage
+TEST_F(ServerTest, Binary) {
+    const std::string value(100000, 'v');
+    const std::string request =
+        binary_packet(0x80, 0x01, 0, std::string(8, '\0'), "a", value, 1) +
+        binary_packet(0x80, 0x0c, 0, "", "a", "", 2) + binary_packet(0x80, 0x00, 0, "", "b", "", 3) +
+        binary_packet(0x80, 0x0a, 0, "", "", "", 4);
+    const std::string noop = binary_packet(0x81, 0x0a, 0, "", "", "", 4);
+
+    std::string response = Pipeline(request, noop);
+    EXPECT_TRUE(binary_packet(0x81, 0x01, 0, "", "", "", 1) +
+                    binary_packet(0x81, 0x0c, 0, std::string(4, '\0'), "a", value, 2) +
+                    binary_packet(0x81, 0x00, 1, "", "", "Not found", 3) + noop ==
+                response);
+
+    response = Pipeline("get a\r\n", "END\r\n");
+    EXPECT_TRUE("VALUE a 0 100000\r\n" + value + "\r\nEND\r\n" == response);
+}
+
+// Epoll server detects binary protocol the same way, executor or not. Broken stream is closed without an answer,
+// server closes first, so each run gets a port of its own
+TEST_F(ServerTest, NonblockingBinary) {
+    const std::string request = binary_packet(0x80, 0x01, 0, std::string(8, '\0'), "a", "xy", 1) +
+                                binary_packet(0x80, 0x09, 0, "", "b", "", 2) +
+                                binary_packet(0x80, 0x00, 0, "", "a", "", 3);
+    const std::string expected = binary_packet(0x81, 0x01, 0, "", "", "", 1) +
+                                 binary_packet(0x81, 0x00, 0, std::string(4, '\0'), "", "xy", 3);
+
+    for (uint32_t threads : {0, 2}) {
+        std::shared_ptr<Network::Server> nonblocking(new Network::STnonblock::ServerImpl(storage, logging));
+        nonblocking->SetExecutorThreads(threads);
+        uint16_t offset = (threads == 0) ? 5 : 6;
+        nonblocking->Start(port + offset, 1, 1);
+
+        port += offset;
+        std::string response = Pipeline(request + binary_packet(0x80, 0x0a, 0, "", "", "", 4),
+                                         binary_packet(0x81, 0x0a, 0, "", "", "", 4));
+        EXPECT_TRUE(expected + binary_packet(0x81, 0x0a, 0, "", "", "", 4) == response)
+            << "executor threads: " << threads;
+
+        response = Pipeline(request + "get a\r\n", "never");
+        EXPECT_TRUE(expected == response) << "executor threads: " << threads;
+        port -= offset;
+
+        nonblocking->Stop();
+        nonblocking->Join();
+    }
+}
+
+// Expired packets are answered with temporary failure, noop never expires
+TEST(ExecuteRequestsTest, BinaryTimeout) {
+    Backend::ThreadSafeSimplLRU storage(1024 * 1024);
+    Execute::Dispatcher dispatcher;
+    Network::RequestTimer timer("test");
+    Protocol::BinaryParser parser;
+    Execute::OutputSink output;
+
+    const std::string input = binary_packet(0x80, 0x01, 0, std::string(8, '\0'), "a", "x", 1) +
+                              binary_packet(0x80, 0x0a, 0, "", "", "", 2) +
+                              binary_packet(0x80, 0x01, 0, std::string(8, '\0'), "c", "z", 3);
+    std::vector<Protocol::BinaryParser::Request> requests;
+    parser.ParseBatch(input.data(), input.size(), requests);
+    ASSERT_EQ(3, requests.size());
+
+    Network::stamp_requests(requests, 0);
+    requests[0].received -= 1000000000;
+    requests[1].received -= 1000000000;
+
+    uint64_t before = Execute::Counters::Get(Execute::Counters::kTimedOut);
+    timer.Parsed();
+    Network::execute_binary_requests(dispatcher, storage, requests, output, timer, 100 * 1000000);
+
+    std::string response;
+    for (auto &part : output.Iov()) {
+        response.append(static_cast<const char *>(part.iov_base), part.iov_len);
+    }
+    EXPECT_TRUE(binary_packet(0x81, 0x01, 0x86, "", "", "Temporary failure", 1) +
+                    binary_packet(0x81, 0x0a, 0, "", "", "", 2) + binary_packet(0x81, 0x01, 0, "", "", "", 3) ==
+                response);
+    EXPECT_EQ(before + 1, Execute::Counters::Get(Execute::Counters::kTimedOut));
+
+    std::string value;
+    EXPECT_FALSE(storage.Get("a", value));
+    EXPECT_TRUE(storage.Get("c", value));
+}
+
+// Pipelined single key gets are looked up in batches, other commands in between are answered in order
+TEST_F(ServerTest, PipelinedGets) {
+    const int keys = 100, count = 50000;
+    std::string request, expected;
+    for (int i = 0; i < keys; i++) {
+        std::string key = "key" + std::to_string(i);
+        storage->Put(key, "value" + std::to_string(i));
+    }
+    for (int i = 0; i < count; i++) {
+        // Every tenth key is missing and every eleventh request is not a get
+        int k = i % (keys + keys / 10);
+        std::string key = "key" + std::to_string(k);
+        if (i % 11 == 10) {
+            request += "touch " + key + " 0\r\n";
+            expected += (k < keys) ? "TOUCHED\r\n" : "NOT_FOUND\r\n";
+            continue;
+        }
+        request += "get " + key + "\r\n";
+        if (k < keys) {
+            std::string value = "value" + std::to_string(k);
+            expected += "VALUE " + key + " 0 " + std::to_string(value.size()) + "\r\n" + value + "\r\n";
+        }
+        expected += "END\r\n";
+    }
+
+    std::string response = Pipeline(request + "mn\r\n", "MN\r\n");
+    EXPECT_TRUE(expected + "MN\r\n" == response);
+}
@@ -0,0 +1,253 @@
+#include <gtest/gtest.h>
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include <afina/execute/Add.h>
+#include <afina/execute/Dispatcher.h>
+#include <afina/execute/Get.h>
+#include <afina/execute/OutputSink.h>
+#include <afina/execute/Set.h>
+
+#include <protocol/BinaryParser.h>
+#include <storage/SimpleLRU.h>
+
+using namespace Afina;
+using Protocol::BinaryParser;
+
+namespace {
+
+void put16(std::string &out, uint16_t v) {
+    out.push_back(char(v >> 8));
+    out.push_back(char(v));
+}
+
+void put32(std::string &out, uint32_t v) {
+    put16(out, uint16_t(v >> 16));
+    put16(out, uint16_t(v));
+}
+
+std::string packet(uint8_t opcode, const std::string &extras, const std::string &key, const std::string &value,
+                   uint32_t opaque) {
+    std::string out;
+    out.push_back(char(0x80));
+    out.push_back(char(opcode));
+    put16(out, uint16_t(key.size()));
+    out.push_back(char(extras.size()));
+    out.push_back(0);
+    put16(out, 0);
+    put32(out, uint32_t(extras.size() + key.size() + value.size()));
+    put32(out, opaque);
+    put32(out, 0);
+    put32(out, 0);
+    return out + extras + key + value;
+}
+
+std::string set_extras(uint32_t flags, uint32_t expire) {
+    std::string out;
+    put32(out, flags);
+    put32(out, expire);
+    return out;
+}
+
+std::string text(const Execute::OutputSink &out) {
+    std::string result;
+    out.CopyTo(Execute::OutputSink::Mark{0, 0, 0}, result);
+    return result;
+}
+
+uint16_t status(const std::string &response) {
+    return uint16_t((uint8_t(response[6]) << 8) | uint8_t(response[7]));
+}
+
+} // namespace
+
+TEST(BinaryParserTest, SetAndGet) {
+    BinaryParser parser;
+
+    std::string input = packet(BinaryParser::opSet, set_extras(5, 60), "foo", "value", 1) +
+                        packet(BinaryParser::opGetK, "", "foo", "", 2);
+    std::vector<BinaryParser::Request> requests;
+    ASSERT_EQ(input.size(), parser.ParseBatch(input.data(), input.size(), requests));
+    ASSERT_EQ(2, requests.size());
+
+    Execute::Set *set = reinterpret_cast<Execute::Set *>(requests[0].command.get());
+    ASSERT_EQ("foo", set->key());
+    ASSERT_EQ(5, set->flags());
+    ASSERT_EQ(60, set->expire());
+    ASSERT_EQ("value", requests[0].argument);
+    ASSERT_EQ(1, requests[0].opaque);
+
+    Execute::Get *get = reinterpret_cast<Execute::Get *>(requests[1].command.get());
+    ASSERT_EQ(1, get->keys().size());
+    ASSERT_EQ("foo", get->keys()[0]);
+    ASSERT_EQ(2, requests[1].opaque);
+}
+
+// Packets split at every possible position are glued back
+TEST(BinaryParserTest, SplitInput) {
+    std::string input = packet(BinaryParser::opAdd, set_extras(0, 0), "key", std::string(100, 'v'), 7) +
+                        packet(BinaryParser::opNoop, "", "", "", 8);
+
+    for (size_t step = 1; step <= input.size(); step++) {
+        BinaryParser parser;
+        std::vector<BinaryParser::Request> requests;
+        for (size_t offset = 0; offset < input.size(); offset += step) {
+            size_t len = std::min(step, input.size() - offset);
+            ASSERT_EQ(len, parser.ParseBatch(input.data() + offset, len, requests));
+        }
+
+        ASSERT_EQ(2, requests.size());
+        ASSERT_EQ("key", reinterpret_cast<Execute::Add *>(requests[0].command.get())->key());
+        ASSERT_EQ(std::string(100, 'v'), requests[0].argument);
+        ASSERT_EQ(BinaryParser::opNoop, requests[1].opcode);
+        ASSERT_EQ(8, requests[1].opaque);
+    }
+}
+
+TEST(BinaryParserTest, InvalidMagic) {
+    BinaryParser parser;
+    std::vector<BinaryParser::Request> requests;
+    std::string input = "get foo\r\n";
+    ASSERT_THROW(parser.ParseBatch(input.data(), input.size(), requests), std::runtime_error);
+}
+
+TEST(BinaryParserTest, UnknownCommand) {
+    BinaryParser parser;
+    std::vector<BinaryParser::Request> requests;
+    std::string input = packet(0x7f, "", "k", "", 3);
+    parser.ParseBatch(input.data(), input.size(), requests);
+    ASSERT_EQ(1, requests.size());
+    ASSERT_TRUE(requests[0].command == nullptr);
+
+    Execute::OutputSink out;
+    BinaryParser::Encode(requests[0], "", out);
+    std::string response = text(out);
+    ASSERT_EQ(char(0x81), response[0]);
+    ASSERT_EQ(BinaryParser::stUnknownCommand, status(response));
+}
+
+TEST(BinaryParserTest, EncodeGet) {
+    BinaryParser::Request request;
+    request.opcode = BinaryParser::opGetK;
+    request.opaque = 0x01020304;
+    request.key = "foo";
+    request.status = BinaryParser::stSuccess;
+
+    Execute::OutputSink out;
+    out.Values().push_back(std::make_shared<std::string>("ba"));
+    out.Values().push_back(std::make_shared<std::string>("r"));
+    BinaryParser::EncodeValue(request, true, 0, out);
+    std::string response = text(out);
+    ASSERT_EQ(BinaryParser::kHeaderSize + 4 + 3 + 3, response.size());
+    ASSERT_EQ(BinaryParser::stSuccess, status(response));
+    ASSERT_EQ(std::string("\x01\x02\x03\x04", 4), response.substr(12, 4));
+    ASSERT_EQ(std::string("\x00\x00\x00\x00", 4), response.substr(24, 4));
+    ASSERT_EQ("foobar", response.substr(28));
+
+    // Value is sent right from the chunks
+    std::vector<struct iovec> &iov = out.Iov();
+    ASSERT_EQ(3, iov.size());
+    ASSERT_EQ(out.Values()[0]->data(), iov[1].iov_base);
+    ASSERT_EQ(out.Values()[1]->data(), iov[2].iov_base);
+
+    // Miss of the quiet get produces nothing
+    out.Clear();
+    request.opcode = BinaryParser::opGetKQ;
+    BinaryParser::EncodeValue(request, false, 0, out);
+    ASSERT_TRUE(out.Empty());
+
+    request.opcode = BinaryParser::opGet;
+    BinaryParser::EncodeValue(request, false, 0, out);
+    ASSERT_EQ(BinaryParser::stKeyNotFound, status(text(out)));
+}
+
+// Keys of the binary protocol could hold any bytes, text response is never parsed back
+TEST(BinaryParserTest, ExecuteGetOfAnyKey) {
+    Backend::SimpleLRU storage(1024);
+    std::string key = "a 0 100000\r\n";
+    ASSERT_TRUE(storage.Put(key, "v"));
+
+    BinaryParser parser;
+    std::vector<BinaryParser::Request> requests;
+    std::string input = packet(BinaryParser::opGetK, "", key, "", 1);
+    parser.ParseBatch(input.data(), input.size(), requests);
+    ASSERT_EQ(1, requests.size());
+
+    Execute::Dispatcher dispatcher;
+    Execute::OutputSink out;
+    BinaryParser::Execute(dispatcher, storage, requests[0], out);
+    std::string response = text(out);
+    ASSERT_EQ(BinaryParser::kHeaderSize + 4 + key.size() + 1, response.size());
+    ASSERT_EQ(BinaryParser::stSuccess, status(response));
+    ASSERT_EQ(key + "v", response.substr(28));
+}
+
+// Text result of the command is replaced with the status, rejected request never reaches the storage
+TEST(BinaryParserTest, ExecuteStore) {
+    Backend::SimpleLRU storage(1024);
+    Execute::StaticDispatcher<Backend::SimpleLRU> dispatcher;
+
+    BinaryParser parser;
+    std::vector<BinaryParser::Request> requests;
+    std::string input = packet(BinaryParser::opSet, set_extras(0, 0), "foo", "bar", 1) +
+                        packet(BinaryParser::opSet, set_extras(0, 0), "baz", "bar", 2);
+    parser.ParseBatch(input.data(), input.size(), requests);
+    ASSERT_EQ(2, requests.size());
+    requests[1].status = BinaryParser::stTemporaryFailure;
+
+    Execute::OutputSink out;
+    BinaryParser::Execute(dispatcher, storage, requests[0], out);
+    std::string response = text(out);
+    ASSERT_EQ(BinaryParser::kHeaderSize, response.size());
+    ASSERT_EQ(BinaryParser::stSuccess, status(response));
+
+    out.Clear();
+    BinaryParser::Execute(dispatcher, storage, requests[1], out);
+    ASSERT_EQ(BinaryParser::stTemporaryFailure, status(text(out)));
+
+    std::string value;
+    ASSERT_TRUE(storage.Get("foo", value));
+    ASSERT_EQ("bar", value);
+    ASSERT_FALSE(storage.Get("baz", value));
+}
+
+// Size of the body is checked once header is there, nothing of the body is collected before
+TEST(BinaryParserTest, TooLargePacket) {
+    std::string header = packet(BinaryParser::opSet, "", "", "", 1);
+    header[8] = char(0xff);
+
+    BinaryParser parser;
+    std::vector<BinaryParser::Request> requests;
+    ASSERT_THROW(parser.ParseBatch(header.data(), header.size(), requests), std::runtime_error);
+
+    for (std::size_t split = 1; split < header.size(); split++) {
+        BinaryParser split_parser;
+        ASSERT_EQ(split, split_parser.ParseBatch(header.data(), split, requests));
+        ASSERT_THROW(split_parser.ParseBatch(header.data() + split, header.size() - split, requests),
+                     std::runtime_error);
+    }
+    ASSERT_TRUE(requests.empty());
+}
+
+TEST(BinaryParserTest, EncodeStore) {
+    BinaryParser::Request request;
+    request.opaque = 0;
+    request.status = BinaryParser::stSuccess;
+
+    Execute::OutputSink out;
+    request.opcode = BinaryParser::opSetQ;
+    BinaryParser::Encode(request, "STORED", out);
+    ASSERT_TRUE(out.Empty());
+
+    request.opcode = BinaryParser::opSet;
+    BinaryParser::Encode(request, "STORED", out);
+    ASSERT_EQ(BinaryParser::kHeaderSize, out.Size());
+    ASSERT_EQ(BinaryParser::stSuccess, status(text(out)));
+
+    out.Clear();
+    request.opcode = BinaryParser::opAdd;
+    BinaryParser::Encode(request, "NOT_STORED", out);
+    ASSERT_EQ(BinaryParser::stKeyExists, status(text(out)));
+}
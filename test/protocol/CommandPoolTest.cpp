@@ -0,0 +1,133 @@
+#include <gtest/gtest.h>
+
+#include <atomic>
+#include <cstdlib>
+#include <new>
+#include <string>
+#include <vector>
+
+#include <afina/execute/Dispatcher.h>
+#include <afina/execute/Get.h>
+#include <afina/execute/OutputSink.h>
+
+#include <protocol/CommandPool.h>
+#include <protocol/Parser.h>
+#include <storage/SimpleLRU.h>
+
+using namespace Afina;
+
+// Every allocation of the test binary is counted
+namespace {
+std::atomic<std::size_t> allocations(0);
+} // namespace
+
+void *operator new(std::size_t size) {
+    allocations++;
+    void *p = std::malloc(size ? size : 1);
+    if (p == nullptr) {
+        throw std::bad_alloc();
+    }
+    return p;
+}
+
+void operator delete(void *p) noexcept { std::free(p); }
+void operator delete(void *p, std::size_t) noexcept { std::free(p); }
+
+TEST(CommandPoolTest, Recycle) {
+    Protocol::CommandPool pool;
+    Execute::Get *get;
+    Protocol::CommandPool::Pointer command = pool.Acquire(Protocol::CommandType::kGet, get);
+    get->Reset(1)[0] = "key";
+    ASSERT_EQ(0, pool.FreeCount(Protocol::CommandType::kGet));
+
+    command.reset();
+    ASSERT_EQ(1, pool.FreeCount(Protocol::CommandType::kGet));
+
+    // The same object comes back, keys keep their buffers
+    Execute::Get *again;
+    command = pool.Acquire(Protocol::CommandType::kGet, again);
+    ASSERT_EQ(get, again);
+    ASSERT_EQ(0, pool.FreeCount(Protocol::CommandType::kGet));
+
+    // Command could outlive the pool
+    Protocol::CommandPool *temporary = new Protocol::CommandPool();
+    Protocol::CommandPool::Pointer orphan = temporary->Acquire(Protocol::CommandType::kGet, get);
+    delete temporary;
+    orphan.reset();
+}
+
+TEST(CommandPoolTest, NoAllocationsInSteadyState) {
+    const std::string key1 = "user:profile:0000000001", key2 = "user:profile:0000000002";
+    const std::string input = "set " + key1 + " 0 0 5\r\nvalue\r\nget " + key1 + " " + key2 + "\r\ngat 100 " + key1 +
+                              "\r\ntouch " + key1 + " 10\r\ndelete " + key2 + "\r\nappend " + key1 +
+                              " 0 0 1 noreply\r\nx\r\nget " + key1 + "\r\n";
+
+    Backend::SimpleLRU storage(1024 * 1024);
+    storage.Put(key1, "value");
+
+    Protocol::Parser parser;
+    std::vector<Protocol::Parser::Request> requests;
+    Execute::OutputSink output;
+    auto round = [&]() {
+        ASSERT_EQ(input.size(), parser.ParseBatch(input.data(), input.size(), requests));
+        ASSERT_EQ(7, requests.size());
+
+        // Only reading commands are executed, storing ones allocate in the storage
+        for (auto &request : requests) {
+            if (request.type == Protocol::CommandType::kGet) {
+                request.command->ExecuteTo(storage, std::move(request.argument), output);
+            }
+        }
+        requests.clear();
+        output.Clear();
+    };
+
+    // Pool, requests and output buffers grow during the first rounds
+    for (int i = 0; i < 3; i++) {
+        round();
+    }
+
+    std::size_t before = allocations.load();
+    for (int i = 0; i < 100; i++) {
+        round();
+    }
+    ASSERT_EQ(0, allocations.load() - before);
+}
+
+// Pipelined gets are looked up at once the way network layer does it, see Execute::Dispatcher::ExecuteGets
+TEST(CommandPoolTest, NoAllocationsInCoalescedGets) {
+    const std::string key1 = "user:profile:0000000001", key2 = "user:profile:0000000002";
+    const std::string input = "get " + key1 + "\r\nget " + key1 + " " + key2 + "\r\nget " + key2 + "\r\nget " + key1 +
+                              " " + key1 + " " + key2 + "\r\n";
+
+    Backend::SimpleLRU storage(1024 * 1024);
+    storage.Put(key1, "value");
+
+    Protocol::Parser parser;
+    std::vector<Protocol::Parser::Request> requests;
+    Execute::OutputSink output;
+    Execute::Dispatcher dispatcher;
+    Execute::Get *gets[4];
+    auto round = [&]() {
+        ASSERT_EQ(input.size(), parser.ParseBatch(input.data(), input.size(), requests));
+        ASSERT_EQ(4, requests.size());
+
+        for (std::size_t i = 0; i < requests.size(); i++) {
+            gets[i] = static_cast<Execute::Get *>(requests[i].command.get());
+        }
+        dispatcher.ExecuteGets(storage, gets, requests.size(), output);
+        requests.clear();
+        output.Clear();
+    };
+
+    // Pool, requests, output buffers and batch lists grow during the first rounds
+    for (int i = 0; i < 3; i++) {
+        round();
+    }
+
+    std::size_t before = allocations.load();
+    for (int i = 0; i < 100; i++) {
+        round();
+    }
+    ASSERT_EQ(0, allocations.load() - before);
+}
@@ -1,14 +1,27 @@
 #include <gtest/gtest.h>
 
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
 #include <memory>
 #include <string>
 
 #include <afina/execute/Add.h>
+#include <afina/execute/Append.h>
+#include <afina/execute/Delete.h>
+#include <afina/execute/FlushAll.h>
+#include <afina/execute/Gat.h>
 #include <afina/execute/Get.h>
+#include <afina/execute/Meta.h>
+#include <afina/execute/Scan.h>
 #include <afina/execute/Set.h>
+#include <afina/execute/Prepend.h>
+#include <afina/execute/Replace.h>
 #include <afina/execute/Stats.h>
+#include <afina/execute/Touch.h>
 
 #include <protocol/Parser.h>
+#include <protocol/Scanner.h>
 
 using namespace Afina;
 
@@ -98,3 +111,361 @@ TEST(MemcachedParserTest, Stats) {
     Execute::Stats *tmp = reinterpret_cast<Execute::Stats *>(cmd.get());
     ASSERT_FALSE(tmp == nullptr);
 }
+
+TEST(MemcachedParserTest, StatsSection) {
+    Protocol::Parser parser;
+
+    size_t consumed = 0;
+    ASSERT_TRUE(parser.Parse("stats latency\r\n", consumed));
+    ASSERT_EQ(15, consumed);
+
+    size_t value_size;
+    std::unique_ptr<Execute::Command> cmd = parser.Build(value_size);
+    ASSERT_NE(nullptr, dynamic_cast<Execute::Stats *>(cmd.get()));
+    ASSERT_EQ(0, value_size);
+
+    parser.Reset();
+    ASSERT_TRUE(parser.Parse("stats latency items\r\n", consumed));
+    ASSERT_THROW(parser.Build(value_size), std::runtime_error);
+}
+
+TEST(MemcachedParserTest, Scan) {
+    Protocol::Parser parser;
+
+    size_t consumed = 0;
+    bool cmd_avail = parser.Parse("scan user: 10 user:5\r\n", consumed);
+    ASSERT_TRUE(cmd_avail);
+    ASSERT_EQ(22, consumed);
+    ASSERT_EQ("scan", parser.Name());
+
+    size_t value_size;
+    std::unique_ptr<Execute::Command> cmd = parser.Build(value_size);
+    ASSERT_FALSE(cmd == nullptr);
+    ASSERT_EQ(0, value_size);
+
+    Execute::Scan *tmp = reinterpret_cast<Execute::Scan *>(cmd.get());
+    ASSERT_EQ("user:", tmp->prefix());
+    ASSERT_EQ(10, tmp->limit());
+    ASSERT_EQ("user:5", tmp->start());
+}
+
+TEST(MemcachedParserTest, ScanDefaults) {
+    Protocol::Parser parser;
+
+    size_t consumed = 0;
+    ASSERT_TRUE(parser.Parse("scan user:\r\n", consumed));
+
+    size_t value_size;
+    std::unique_ptr<Execute::Command> cmd = parser.Build(value_size);
+    ASSERT_FALSE(cmd == nullptr);
+
+    Execute::Scan *tmp = reinterpret_cast<Execute::Scan *>(cmd.get());
+    ASSERT_EQ("user:", tmp->prefix());
+    ASSERT_EQ(Execute::Scan::kDefaultLimit, tmp->limit());
+    ASSERT_EQ("", tmp->start());
+}
+
+// Vectorized delimiter search must agree with the plain loop on every offset and tail length
+TEST(MemcachedParserTest, ScannerMatchesScalar) {
+    std::srand(42);
+    for (int round = 0; round < 1000; round++) {
+        std::string buf(std::rand() % 100, 'x');
+        for (auto &c : buf) {
+            int r = std::rand() % 40;
+            c = (r == 0) ? ' ' : (r == 1) ? '\r' : char('a' + r % 26);
+        }
+
+        size_t expect_any = buf.size(), expect_sp = buf.size();
+        for (size_t i = 0; i < buf.size(); i++) {
+            if (expect_any == buf.size() && (buf[i] == ' ' || buf[i] == '\r')) {
+                expect_any = i;
+            }
+            if (expect_sp == buf.size() && buf[i] == ' ') {
+                expect_sp = i;
+            }
+        }
+
+        ASSERT_EQ(expect_any, Protocol::find_any_of(buf.data(), buf.size(), ' ', '\r'));
+        ASSERT_EQ(expect_sp, Protocol::find_first(buf.data(), buf.size(), ' '));
+    }
+}
+
+// Tokens split across several reads must be glued back exactly
+TEST(MemcachedParserTest, SplitInput) {
+    const std::string key(70, 'k');
+    const std::string input = "get " + key + " a " + key + "b\r\n";
+
+    for (size_t step = 1; step <= input.size(); step++) {
+        Protocol::Parser parser;
+        size_t offset = 0;
+        bool cmd_avail = false;
+        while (!cmd_avail && offset < input.size()) {
+            size_t consumed = 0;
+            size_t len = std::min(step, input.size() - offset);
+            cmd_avail = parser.Parse(input.data() + offset, len, consumed);
+            offset += consumed;
+        }
+        ASSERT_TRUE(cmd_avail);
+        ASSERT_EQ(input.size(), offset);
+
+        size_t value_size;
+        std::unique_ptr<Execute::Command> cmd = parser.Build(value_size);
+        std::vector<std::string> keys = reinterpret_cast<Execute::Get *>(cmd.get())->keys();
+        ASSERT_EQ(3, keys.size());
+        ASSERT_EQ(key, keys[0]);
+        ASSERT_EQ("a", keys[1]);
+        ASSERT_EQ(key + "b", keys[2]);
+    }
+}
+
+// Tokens parsed out of a single read point into the caller's buffer
+TEST(MemcachedParserTest, ViewsReferenceInput) {
+    Protocol::Parser parser;
+
+    const std::string input = "get first second\r\n";
+    size_t consumed = 0;
+    ASSERT_TRUE(parser.Parse(input.data(), input.size(), consumed));
+
+    ASSERT_TRUE(parser.NameView() == "get");
+    ASSERT_EQ(input.data(), parser.NameView().data);
+    ASSERT_EQ(2, parser.KeysCount());
+    ASSERT_EQ(input.data() + 4, parser.KeyView(0).data);
+    ASSERT_EQ("first", parser.KeyView(0).str());
+    ASSERT_EQ(input.data() + 10, parser.KeyView(1).data);
+    ASSERT_EQ("second", parser.KeyView(1).str());
+}
+
+// Tokens seen in previous reads survive changes of the caller's buffer
+TEST(MemcachedParserTest, ViewsSurviveBufferReuse) {
+    Protocol::Parser parser;
+
+    char buffer[64] = "set very_lo";
+    size_t consumed = 0;
+    ASSERT_FALSE(parser.Parse(buffer, std::strlen(buffer), consumed));
+    ASSERT_EQ(std::strlen(buffer), consumed);
+
+    std::strcpy(buffer, "ng_key 1 2 3\r\n");
+    ASSERT_TRUE(parser.Parse(buffer, std::strlen(buffer), consumed));
+    ASSERT_EQ(std::strlen(buffer), consumed);
+
+    ASSERT_TRUE(parser.NameView() == "set");
+    ASSERT_EQ("very_long_key", parser.KeyView(0).str());
+
+    size_t value_size;
+    std::unique_ptr<Execute::Command> cmd = parser.Build(value_size);
+    ASSERT_EQ(3, value_size);
+    ASSERT_EQ("very_long_key", reinterpret_cast<Execute::Set *>(cmd.get())->key());
+}
+
+// All commands with data blocks are parsed out of the single buffer
+TEST(MemcachedParserTest, BatchParse) {
+    Protocol::Parser parser;
+
+    const std::string input = "set foo 0 0 3\r\nbar\r\nget foo\r\nadd x 0 0 0\r\n\r\nget fo";
+    std::vector<Protocol::Parser::Request> requests;
+    ASSERT_EQ(input.size(), parser.ParseBatch(input.data(), input.size(), requests));
+    ASSERT_EQ(3, requests.size());
+    ASSERT_EQ("foo", reinterpret_cast<Execute::Set *>(requests[0].command.get())->key());
+    ASSERT_EQ("bar", requests[0].argument);
+    ASSERT_EQ("foo", reinterpret_cast<Execute::Get *>(requests[1].command.get())->keys()[0]);
+    ASSERT_EQ("", requests[1].argument);
+    ASSERT_EQ("x", reinterpret_cast<Execute::Add *>(requests[2].command.get())->key());
+    ASSERT_EQ("", requests[2].argument);
+
+    // Tail of the last command is kept inside of the parser
+    requests.clear();
+    const std::string tail = "o\r\n";
+    ASSERT_EQ(tail.size(), parser.ParseBatch(tail.data(), tail.size(), requests));
+    ASSERT_EQ(1, requests.size());
+    ASSERT_EQ("foo", reinterpret_cast<Execute::Get *>(requests[0].command.get())->keys()[0]);
+}
+
+// Result doesn't depend on how the stream was split into reads
+TEST(MemcachedParserTest, BatchParseSplit) {
+    const std::string input = "set key1 0 0 10\r\n0123456789\r\nget key1 key2\r\nappend key2 0 0 2\r\nab\r\n";
+
+    for (size_t step = 1; step <= input.size(); step++) {
+        Protocol::Parser parser;
+        std::vector<Protocol::Parser::Request> requests;
+        for (size_t offset = 0; offset < input.size(); offset += step) {
+            size_t len = std::min(step, input.size() - offset);
+            ASSERT_EQ(len, parser.ParseBatch(input.data() + offset, len, requests));
+        }
+
+        ASSERT_EQ(3, requests.size());
+        ASSERT_EQ("0123456789", requests[0].argument);
+        ASSERT_EQ(2, reinterpret_cast<Execute::Get *>(requests[1].command.get())->keys().size());
+        ASSERT_EQ("key2", reinterpret_cast<Execute::Append *>(requests[2].command.get())->key());
+        ASSERT_EQ("ab", requests[2].argument);
+    }
+}
+
+TEST(MemcachedParserTest, BodyBuffer) {
+    Protocol::Parser parser;
+    std::vector<Protocol::Parser::Request> requests;
+
+    size_t size;
+    ASSERT_EQ(nullptr, parser.BodyBuffer(size));
+
+    const std::string head = "set key1 0 0 10\r\n0123";
+    ASSERT_EQ(head.size(), parser.ParseBatch(head.data(), head.size(), requests));
+    ASSERT_EQ(0, requests.size());
+
+    // Rest of the data block and its \r\n go right into the parser buffer
+    char *body = parser.BodyBuffer(size);
+    ASSERT_NE(nullptr, body);
+    ASSERT_EQ(8, size);
+    memcpy(body, "456", 3);
+    parser.BodyReceived(3, requests);
+    ASSERT_EQ(0, requests.size());
+
+    body = parser.BodyBuffer(size);
+    ASSERT_EQ(5, size);
+    memcpy(body, "789\r\n", 5);
+    parser.BodyReceived(5, requests);
+    ASSERT_EQ(1, requests.size());
+    ASSERT_EQ("0123456789", requests[0].argument);
+    ASSERT_EQ(nullptr, parser.BodyBuffer(size));
+
+    const std::string tail = "get key1\r\n";
+    ASSERT_EQ(tail.size(), parser.ParseBatch(tail.data(), tail.size(), requests));
+    ASSERT_EQ(2, requests.size());
+}
+
+TEST(MemcachedParserTest, BodyTooLarge) {
+    Protocol::Parser parser;
+    std::vector<Protocol::Parser::Request> requests;
+
+    const std::string input = "set key1 0 0 1000000000\r\n";
+    ASSERT_THROW(parser.ParseBatch(input.data(), input.size(), requests), std::runtime_error);
+}
+
+TEST(MemcachedParserTest, Noreply) {
+    Protocol::Parser parser;
+
+    const std::string input = "set foo 0 0 1 noreply\r\na\r\nadd foo 0 0 1\r\nb\r\nappend foo 1 2 1 noreply \r\nc\r\n";
+    std::vector<Protocol::Parser::Request> requests;
+    ASSERT_EQ(input.size(), parser.ParseBatch(input.data(), input.size(), requests));
+    ASSERT_EQ(3, requests.size());
+    ASSERT_TRUE(requests[0].noreply);
+    ASSERT_EQ("a", requests[0].argument);
+    ASSERT_FALSE(requests[1].noreply);
+    ASSERT_TRUE(requests[2].noreply);
+    ASSERT_EQ(1, reinterpret_cast<Execute::Append *>(requests[2].command.get())->flags());
+
+    Protocol::Parser single;
+    size_t consumed = 0;
+    ASSERT_THROW(single.Parse("set foo 0 0 1 reply\r\n", consumed), std::runtime_error);
+}
+
+TEST(MemcachedParserTest, MetaCommands) {
+    Protocol::Parser parser;
+
+    const std::string input = "mg foo v k Oa1\r\nms bar 3 q MA\r\nabc\r\nmd foo q\r\nma cnt N0 J5 v\r\nmn\r\n";
+    std::vector<Protocol::Parser::Request> requests;
+    ASSERT_EQ(input.size(), parser.ParseBatch(input.data(), input.size(), requests));
+    ASSERT_EQ(5, requests.size());
+
+    Execute::MetaGet *mg = reinterpret_cast<Execute::MetaGet *>(requests[0].command.get());
+    ASSERT_EQ("foo", mg->key());
+    ASSERT_TRUE(mg->Has('v'));
+    ASSERT_TRUE(mg->Has('k'));
+    ASSERT_EQ("a1", mg->Token('O'));
+    ASSERT_FALSE(mg->quiet());
+
+    Execute::MetaSet *ms = reinterpret_cast<Execute::MetaSet *>(requests[1].command.get());
+    ASSERT_EQ("bar", ms->key());
+    ASSERT_TRUE(ms->quiet());
+    ASSERT_EQ("A", ms->Token('M'));
+    ASSERT_EQ("abc", requests[1].argument);
+
+    Execute::MetaDelete *md = reinterpret_cast<Execute::MetaDelete *>(requests[2].command.get());
+    ASSERT_EQ("foo", md->key());
+    ASSERT_TRUE(md->quiet());
+
+    Execute::MetaArithmetic *ma = reinterpret_cast<Execute::MetaArithmetic *>(requests[3].command.get());
+    ASSERT_EQ("cnt", ma->key());
+    ASSERT_EQ("5", ma->Token('J'));
+
+    ASSERT_FALSE(dynamic_cast<Execute::MetaNoop *>(requests[4].command.get()) == nullptr);
+}
+
+TEST(MemcachedParserTest, KeyCommands) {
+    Protocol::Parser parser;
+
+    const std::string input = "replace foo 0 10 1\r\na\r\nprepend foo 0 0 1 noreply\r\nb\r\ndelete foo\r\n"
+                              "delete bar 0 noreply\r\ntouch foo -1\r\ntouch bar 3600 noreply\r\ngat 60 foo bar\r\n"
+                              "flush_all\r\nflush_all 0 noreply\r\n";
+    std::vector<Protocol::Parser::Request> requests;
+    ASSERT_EQ(input.size(), parser.ParseBatch(input.data(), input.size(), requests));
+    ASSERT_EQ(9, requests.size());
+
+    Execute::Replace *replace = dynamic_cast<Execute::Replace *>(requests[0].command.get());
+    ASSERT_NE(nullptr, replace);
+    ASSERT_EQ(10, replace->expire());
+    ASSERT_EQ("a", requests[0].argument);
+
+    ASSERT_NE(nullptr, dynamic_cast<Execute::Prepend *>(requests[1].command.get()));
+    ASSERT_TRUE(requests[1].noreply);
+    ASSERT_EQ("b", requests[1].argument);
+
+    Execute::Delete *del = dynamic_cast<Execute::Delete *>(requests[2].command.get());
+    ASSERT_NE(nullptr, del);
+    ASSERT_EQ("foo", del->key());
+    ASSERT_FALSE(requests[2].noreply);
+    ASSERT_EQ("bar", dynamic_cast<Execute::Delete *>(requests[3].command.get())->key());
+    ASSERT_TRUE(requests[3].noreply);
+
+    Execute::Touch *touch = dynamic_cast<Execute::Touch *>(requests[4].command.get());
+    ASSERT_NE(nullptr, touch);
+    ASSERT_EQ("foo", touch->key());
+    ASSERT_EQ(-1, touch->expire());
+    ASSERT_FALSE(requests[4].noreply);
+    ASSERT_EQ(3600, dynamic_cast<Execute::Touch *>(requests[5].command.get())->expire());
+    ASSERT_TRUE(requests[5].noreply);
+
+    Execute::Gat *gat = dynamic_cast<Execute::Gat *>(requests[6].command.get());
+    ASSERT_NE(nullptr, gat);
+    ASSERT_EQ(60, gat->expire());
+    ASSERT_EQ(std::vector<std::string>({"foo", "bar"}), gat->keys());
+
+    ASSERT_NE(nullptr, dynamic_cast<Execute::FlushAll *>(requests[7].command.get()));
+    ASSERT_EQ(Protocol::CommandType::kFlushAll, requests[7].type);
+    ASSERT_FALSE(requests[7].noreply);
+    ASSERT_TRUE(requests[8].noreply);
+}
+
+TEST(MemcachedParserTest, KeyCommandErrors) {
+    const std::vector<std::string> inputs = {"delete\r\n",       "delete foo 10\r\n", "touch foo\r\n",
+                                             "touch foo 1x\r\n", "gat 10\r\n",        "flush_all 1 2\r\n"};
+    for (auto &input : inputs) {
+        Protocol::Parser parser;
+        std::vector<Protocol::Parser::Request> requests;
+        ASSERT_THROW(parser.ParseBatch(input.data(), input.size(), requests), std::runtime_error) << input;
+    }
+}
+
+TEST(MemcachedParserTest, MetaSetNeedsLength) {
+    Protocol::Parser parser;
+
+    const std::string input = "ms bar\r\n";
+    std::vector<Protocol::Parser::Request> requests;
+    ASSERT_THROW(parser.ParseBatch(input.data(), input.size(), requests), std::runtime_error);
+}
+
+TEST(MemcachedParserTest, CommandType) {
+    ASSERT_EQ(Protocol::CommandType::kSet, Protocol::command_type("set", 3));
+    ASSERT_EQ(Protocol::CommandType::kPrepend, Protocol::command_type("prepend", 7));
+    ASSERT_EQ(Protocol::CommandType::kMetaNoop, Protocol::command_type("mn", 2));
+    ASSERT_EQ(Protocol::CommandType::kUnknown, Protocol::command_type("sets", 4));
+    ASSERT_EQ(Protocol::CommandType::kUnknown, Protocol::command_type("se", 2));
+    ASSERT_EQ(Protocol::CommandType::kUnknown, Protocol::command_type("", 0));
+    ASSERT_EQ(Protocol::CommandType::kUnknown, Protocol::command_type("prepended", 9));
+    ASSERT_EQ(Protocol::CommandType::kFlushAll, Protocol::command_type("flush_all", 9));
+    ASSERT_EQ(Protocol::CommandType::kTouch, Protocol::command_type("touch", 5));
+
+    Protocol::Parser parser;
+    size_t consumed = 0;
+    ASSERT_TRUE(parser.Parse("gets a\r\n", consumed));
+    ASSERT_EQ(Protocol::CommandType::kGets, parser.Type());
+}
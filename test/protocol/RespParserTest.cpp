@@ -0,0 +1,136 @@
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <cstring>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include <afina/execute/Resp.h>
+
+#include <protocol/Parser.h>
+#include <protocol/RespParser.h>
+#include <storage/SimpleLRU.h>
+
+using namespace Afina;
+using Protocol::RespParser;
+
+namespace {
+
+std::string command(const std::vector<std::string> &args) {
+    std::string out = "*" + std::to_string(args.size()) + "\r\n";
+    for (auto &arg : args) {
+        out += "$" + std::to_string(arg.size()) + "\r\n" + arg + "\r\n";
+    }
+    return out;
+}
+
+// Runs requests one by one the way network layer does, returns whole response
+std::string execute(Storage &storage, std::vector<RespParser::Request> &requests) {
+    std::string response;
+    for (auto &request : requests) {
+        std::vector<ValueChunk> chunks;
+        request.command->ExecuteOwned(storage, std::move(request.argument), chunks);
+        for (auto &chunk : chunks) {
+            response += *chunk;
+        }
+        response += "\r\n";
+    }
+    requests.clear();
+    return response;
+}
+
+} // namespace
+
+TEST(RespParserTest, Pipeline) {
+    const std::string input = command({"SET", "foo", "bar"}) + command({"get", "foo"}) + command({"GET", "baz"}) +
+                              command({"INCR", "n"}) + command({"DECRBY", "n", "5"}) + command({"DEL", "foo", "n"}) +
+                              command({"PING"});
+
+    RespParser parser;
+    std::vector<RespParser::Request> requests;
+    ASSERT_EQ(input.size(), parser.ParseBatch(input.data(), input.size(), requests));
+    ASSERT_EQ(7, requests.size());
+    ASSERT_NE(nullptr, dynamic_cast<Execute::RespSet *>(requests[0].command.get()));
+    ASSERT_EQ("bar", requests[0].argument);
+    ASSERT_NE(nullptr, dynamic_cast<Execute::RespGet *>(requests[1].command.get()));
+    ASSERT_FALSE(requests[1].noreply);
+
+    Backend::SimpleLRU storage(1024);
+    ASSERT_EQ("+OK\r\n$3\r\nbar\r\n$-1\r\n:1\r\n:-4\r\n:2\r\n+PONG\r\n", execute(storage, requests));
+}
+
+TEST(RespParserTest, SplitInput) {
+    const std::string value(100, 'v');
+    const std::string input = command({"SET", "key1", value, "EX", "100"}) + command({"GET", "key1"}) +
+                              command({"EXPIRE", "key1", "0"}) + command({"GET", "key1"});
+
+    for (size_t step = 1; step <= input.size(); step++) {
+        RespParser parser;
+        std::vector<RespParser::Request> requests;
+        for (size_t offset = 0; offset < input.size(); offset += step) {
+            size_t len = std::min(step, input.size() - offset);
+            ASSERT_EQ(len, parser.ParseBatch(input.data() + offset, len, requests));
+        }
+
+        ASSERT_EQ(4, requests.size());
+        ASSERT_EQ(value, requests[0].argument);
+
+        Backend::SimpleLRU storage(1024);
+        ASSERT_EQ("+OK\r\n$100\r\n" + value + "\r\n:1\r\n$-1\r\n", execute(storage, requests));
+    }
+}
+
+TEST(RespParserTest, BodyBuffer) {
+    RespParser parser;
+    std::vector<RespParser::Request> requests;
+
+    size_t size;
+    ASSERT_EQ(nullptr, parser.BodyBuffer(size));
+
+    const std::string head = "*3\r\n$3\r\nSET\r\n$3\r\nkey\r\n$10\r\n0123";
+    ASSERT_EQ(head.size(), parser.ParseBatch(head.data(), head.size(), requests));
+    ASSERT_EQ(0, requests.size());
+
+    // Rest of the value and its \r\n go right into the argument buffer
+    char *body = parser.BodyBuffer(size);
+    ASSERT_NE(nullptr, body);
+    ASSERT_EQ(8, size);
+    memcpy(body, "456789\r\n", 8);
+    parser.BodyReceived(8, requests);
+    ASSERT_EQ(1, requests.size());
+    ASSERT_EQ("0123456789", requests[0].argument);
+    ASSERT_EQ(nullptr, parser.BodyBuffer(size));
+}
+
+TEST(RespParserTest, CommandErrors) {
+    const std::string input = command({"FLUSHALL"}) + command({"GET"}) + command({"SET", "k", "v", "NX", "XX"}) +
+                              command({"SET", "k", "v", "EX", "0"}) + command({"INCRBY", "k", "1x"}) +
+                              command({"SET", "k", "v"}) + command({"INCR", "k"}) + "*0\r\n";
+
+    RespParser parser;
+    std::vector<RespParser::Request> requests;
+    ASSERT_EQ(input.size(), parser.ParseBatch(input.data(), input.size(), requests));
+    ASSERT_EQ(7, requests.size());
+
+    Backend::SimpleLRU storage(1024);
+    ASSERT_EQ("-ERR unknown command 'FLUSHALL'\r\n"
+              "-ERR wrong number of arguments for 'get' command\r\n"
+              "-ERR syntax error\r\n"
+              "-ERR invalid expire time in 'set' command\r\n"
+              "-ERR value is not an integer or out of range\r\n"
+              "+OK\r\n"
+              "-ERR value is not an integer or out of range\r\n",
+              execute(storage, requests));
+}
+
+TEST(RespParserTest, ProtocolErrors) {
+    const std::vector<std::string> inputs = {"GET foo\r\n",  "*1\r\n+PING\r\n",           "*1\r\n$4\r\nPINGxx",
+                                             "*x\r\n",       "*1\r\n$100000000000\r\n", std::string(64, '*')};
+    for (auto &input : inputs) {
+        RespParser parser;
+        std::vector<RespParser::Request> requests;
+        ASSERT_THROW(parser.ParseBatch(input.data(), input.size(), requests), std::runtime_error) << input;
+    }
+}
@@ -0,0 +1,156 @@
+#include "gtest/gtest.h"
+
+#include <iomanip>
+#include <iostream>
+#include <map>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "storage/ARC.h"
+#include "storage/SimpleLRU.h"
+
+using namespace Afina::Backend;
+
+TEST(ARCTest, PutGet) {
+    ARC storage;
+
+    EXPECT_TRUE(storage.Put("KEY1", "val1"));
+    EXPECT_TRUE(storage.Put("KEY2", "val2"));
+    EXPECT_FALSE(storage.PutIfAbsent("KEY1", "val3"));
+    EXPECT_FALSE(storage.Set("KEY3", "val3"));
+    EXPECT_TRUE(storage.Set("KEY2", "val22"));
+
+    std::string value;
+    EXPECT_TRUE(storage.Get("KEY1", value));
+    EXPECT_EQ("val1", value);
+    EXPECT_TRUE(storage.Get("KEY2", value));
+    EXPECT_EQ("val22", value);
+
+    EXPECT_TRUE(storage.Delete("KEY1"));
+    EXPECT_FALSE(storage.Delete("KEY1"));
+    EXPECT_FALSE(storage.Get("KEY1", value));
+}
+
+TEST(ARCTest, SizeLimit) {
+    ARC storage(10 * 4);
+
+    EXPECT_FALSE(storage.Put("k", std::string(40, 'v')));
+    for (int i = 0; i < 100; ++i) {
+        EXPECT_TRUE(storage.Put("k" + std::to_string(i % 10), std::to_string(i % 100)));
+        EXPECT_TRUE(storage.Put("x" + std::to_string(i), "v"));
+    }
+
+    std::vector<std::pair<std::string, std::string>> stats;
+    storage.GetStats(stats);
+    std::map<std::string, std::string> named(stats.begin(), stats.end());
+    EXPECT_GE(40, std::stoul(named["bytes"]));
+    EXPECT_GE(std::max<std::size_t>(std::stoul(named["curr_items"]), 16),
+              std::stoul(named["arc_b1_items"]) + std::stoul(named["arc_b2_items"]));
+}
+
+TEST(ARCTest, FrequentSurvivesScan) {
+    ARC storage(10 * 4);
+
+    // k0..k4 are used twice, so they are frequent
+    for (int round = 0; round < 2; ++round) {
+        for (int i = 0; i < 5; ++i) {
+            std::string value;
+            if (!storage.Get("k" + std::to_string(i), value)) {
+                EXPECT_TRUE(storage.Put("k" + std::to_string(i), "vv"));
+            }
+        }
+    }
+
+    // Long scan of one-time keys must not flush them out
+    for (int i = 0; i < 100; ++i) {
+        EXPECT_TRUE(storage.Put("s" + std::to_string(i), "vv"));
+    }
+
+    std::string value;
+    for (int i = 0; i < 5; ++i) {
+        EXPECT_TRUE(storage.Get("k" + std::to_string(i), value));
+    }
+}
+
+/**
+ * Hit ratio comparison harness: replays key trace against the storage, every miss is
+ * followed by Put just like cache-aside client does
+ */
+static double hit_ratio(Afina::Storage &storage, const std::vector<int> &trace) {
+    std::size_t hits = 0;
+    std::string value;
+    const std::string payload(32, 'v');
+    for (int key : trace) {
+        std::string k = "key" + std::to_string(key);
+        if (storage.Get(k, value)) {
+            hits++;
+        } else {
+            storage.Put(k, payload);
+        }
+    }
+    return double(hits) / trace.size();
+}
+
+// Zipf-like popularity over the given number of keys
+static void zipf_phase(std::mt19937 &rnd, std::vector<int> &trace, int keys, int length, int offset = 0) {
+    std::vector<double> weights(keys);
+    for (int i = 0; i < keys; ++i) {
+        weights[i] = 1.0 / (i + 1);
+    }
+    std::discrete_distribution<int> dist(weights.begin(), weights.end());
+    for (int i = 0; i < length; ++i) {
+        trace.push_back(offset + dist(rnd));
+    }
+}
+
+// One-time keys, never repeated
+static void scan_phase(std::vector<int> &trace, int length, int &next) {
+    for (int i = 0; i < length; ++i) {
+        trace.push_back(next++);
+    }
+}
+
+// Cyclic access to the working set a bit larger than the cache
+static void loop_phase(std::vector<int> &trace, int keys, int length, int offset) {
+    for (int i = 0; i < length; ++i) {
+        trace.push_back(offset + i % keys);
+    }
+}
+
+TEST(ARCTest, HitRatioComparison) {
+    // Every item takes key (~8 bytes) + 32 bytes of value, so cache fits ~250 items
+    const std::size_t cache_size = 250 * 40;
+
+    std::map<std::string, std::vector<int>> workloads;
+    std::mt19937 rnd(42);
+
+    zipf_phase(rnd, workloads["zipf"], 2000, 50000);
+
+    int next = 1000000;
+    std::vector<int> &scan = workloads["zipf+scans"];
+    for (int i = 0; i < 10; ++i) {
+        zipf_phase(rnd, scan, 1000, 5000);
+        scan_phase(scan, 1000, next);
+    }
+
+    std::vector<int> &phases = workloads["alternating"];
+    for (int i = 0; i < 5; ++i) {
+        loop_phase(phases, 300, 10000, 2000000);
+        zipf_phase(rnd, phases, 2000, 10000);
+    }
+
+    std::cout << std::setw(14) << "workload" << std::setw(10) << "lru" << std::setw(10) << "arc" << std::endl;
+    for (auto &w : workloads) {
+        SimpleLRU lru(cache_size);
+        ARC arc(cache_size);
+
+        double lru_ratio = hit_ratio(lru, w.second);
+        double arc_ratio = hit_ratio(arc, w.second);
+        std::cout << std::setw(14) << w.first << std::fixed << std::setprecision(4) << std::setw(10) << lru_ratio
+                  << std::setw(10) << arc_ratio << std::endl;
+
+        // ARC is expected to be at least as good as LRU within a small margin
+        EXPECT_LE(lru_ratio - 0.02, arc_ratio) << w.first;
+    }
+}
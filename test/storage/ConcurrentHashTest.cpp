@@ -0,0 +1,87 @@
+#include "gtest/gtest.h"
+
+#include <atomic>
+#include <map>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "storage/ConcurrentHash.h"
+
+using namespace Afina::Backend;
+
+TEST(ConcurrentHashTest, PutGet) {
+    ConcurrentHash storage(1024, 1);
+
+    EXPECT_TRUE(storage.Put("KEY1", "val1"));
+    EXPECT_TRUE(storage.Put("KEY2", "val2"));
+    EXPECT_TRUE(storage.Put("KEY3", "val3"));
+    EXPECT_FALSE(storage.PutIfAbsent("KEY1", "val"));
+    EXPECT_FALSE(storage.Set("KEY4", "val"));
+
+    // All keys share one bucket, change the one in the middle
+    EXPECT_TRUE(storage.Set("KEY2", "val22"));
+
+    std::string value;
+    EXPECT_TRUE(storage.Get("KEY1", value));
+    EXPECT_EQ("val1", value);
+    EXPECT_TRUE(storage.Get("KEY2", value));
+    EXPECT_EQ("val22", value);
+    EXPECT_TRUE(storage.Get("KEY3", value));
+    EXPECT_EQ("val3", value);
+
+    EXPECT_TRUE(storage.Delete("KEY2"));
+    EXPECT_FALSE(storage.Delete("KEY2"));
+    EXPECT_FALSE(storage.Get("KEY2", value));
+    EXPECT_TRUE(storage.Get("KEY3", value));
+}
+
+TEST(ConcurrentHashTest, SizeLimit) {
+    ConcurrentHash storage(100 * 10);
+
+    EXPECT_FALSE(storage.Put("big", std::string(1000, 'v')));
+    for (int i = 0; i < 1000; ++i) {
+        EXPECT_TRUE(storage.Put("key" + std::to_string(1000 + i), "vvv"));
+    }
+
+    std::vector<std::pair<std::string, std::string>> stats;
+    storage.GetStats(stats);
+    std::map<std::string, std::string> named(stats.begin(), stats.end());
+    EXPECT_GE(1000, std::stol(named["bytes"]));
+    EXPECT_EQ(100, std::stol(named["curr_items"]));
+    EXPECT_EQ(900, std::stol(named["evictions"]));
+}
+
+// Writers and readers work with the same small key space, every value read must be
+// consistent with the key
+TEST(ConcurrentHashTest, ConcurrentAccess) {
+    ConcurrentHash storage(64 * 1024, 64);
+
+    std::atomic<bool> failed(false);
+    std::vector<std::thread> threads;
+    for (int t = 0; t < 8; ++t) {
+        threads.emplace_back([&storage, &failed, t]() {
+            std::string value;
+            for (int i = 0; i < 20000; ++i) {
+                std::string key = "key" + std::to_string((i * 7 + t) % 500);
+                switch ((i + t) % 4) {
+                case 0:
+                    storage.Put(key, key + ":" + std::to_string(i));
+                    break;
+                case 1:
+                    storage.Delete(key);
+                    break;
+                default:
+                    if (storage.Get(key, value) && value.compare(0, key.size() + 1, key + ":") != 0) {
+                        failed = true;
+                    }
+                }
+            }
+        });
+    }
+
+    for (auto &t : threads) {
+        t.join();
+    }
+    EXPECT_FALSE(failed);
+}
@@ -1,16 +1,26 @@
 #include "gtest/gtest.h"
+#include <chrono>
+#include <cstdlib>
 #include <iomanip>
 #include <iostream>
+#include <map>
 #include <set>
+#include <thread>
 #include <vector>
 
+#include <sys/stat.h>
+#include <unistd.h>
+
 #include <afina/execute/Add.h>
 #include <afina/execute/Append.h>
 #include <afina/execute/Delete.h>
 #include <afina/execute/Get.h>
 #include <afina/execute/Set.h>
 
+#include "storage/ConcurrentHash.h"
 #include "storage/SimpleLRU.h"
+#include "storage/ThreadSafeARC.h"
+#include "storage/ThreadSafeSimpleLRU.h"
 
 using namespace Afina::Backend;
 using namespace Afina::Execute;
@@ -197,3 +207,480 @@ TEST(StorageTest, MaxTest) {
         EXPECT_FALSE(storage.Get(key, res));
     }
 }
+
+TEST(StorageTest, ScanPrefix) {
+    SimpleLRU storage;
+
+    EXPECT_TRUE(storage.Put("user:2", "b"));
+    EXPECT_TRUE(storage.Put("user:1", "a"));
+    EXPECT_TRUE(storage.Put("session:1", "c"));
+    EXPECT_TRUE(storage.Put("user:3", "d"));
+    EXPECT_TRUE(storage.Put("users", "e"));
+
+    std::vector<std::string> keys;
+    EXPECT_EQ(Afina::Storage::ScanResult::kEnd, storage.Scan("user:", "", 10, keys));
+    ASSERT_EQ(3, keys.size());
+    EXPECT_EQ("user:1", keys[0]);
+    EXPECT_EQ("user:2", keys[1]);
+    EXPECT_EQ("user:3", keys[2]);
+
+    keys.clear();
+    EXPECT_EQ(Afina::Storage::ScanResult::kEnd, storage.Scan("nope", "", 10, keys));
+    EXPECT_TRUE(keys.empty());
+}
+
+TEST(StorageTest, ScanCursor) {
+    SimpleLRU storage;
+
+    for (int i = 0; i < 10; ++i) {
+        EXPECT_TRUE(storage.Put("k" + std::to_string(i), "v"));
+    }
+
+    std::vector<std::string> keys;
+    EXPECT_EQ(Afina::Storage::ScanResult::kMore, storage.Scan("k", "", 4, keys));
+    ASSERT_EQ(4, keys.size());
+    EXPECT_EQ("k3", keys.back());
+
+    EXPECT_EQ(Afina::Storage::ScanResult::kMore, storage.Scan("k", keys.back(), 4, keys));
+    ASSERT_EQ(8, keys.size());
+    EXPECT_EQ("k7", keys.back());
+
+    EXPECT_EQ(Afina::Storage::ScanResult::kEnd, storage.Scan("k", keys.back(), 4, keys));
+    ASSERT_EQ(10, keys.size());
+    EXPECT_EQ("k9", keys.back());
+}
+
+TEST(StorageTest, ScanKeepsOrder) {
+    SimpleLRU storage(3 * 4);
+
+    EXPECT_TRUE(storage.Put("k1", "v1"));
+    EXPECT_TRUE(storage.Put("k2", "v2"));
+    EXPECT_TRUE(storage.Put("k3", "v3"));
+
+    // Scan must not make k1 the freshest one, so it is evicted first
+    std::vector<std::string> keys;
+    EXPECT_EQ(Afina::Storage::ScanResult::kEnd, storage.Scan("k1", "", 10, keys));
+    EXPECT_TRUE(storage.Put("k4", "v4"));
+
+    std::string value;
+    EXPECT_FALSE(storage.Get("k1", value));
+    EXPECT_TRUE(storage.Get("k2", value));
+}
+
+TEST(StorageTest, LargeValueChunks) {
+    SimpleLRU storage(1024 * 1024);
+
+    std::string big(3 * ChunkPool::kChunkSize + 100, 'x');
+    for (size_t i = 0; i < big.size(); ++i) {
+        big[i] = 'a' + i % 26;
+    }
+    EXPECT_TRUE(storage.Put("KEY1", big));
+
+    std::vector<Afina::ValueChunk> chunks;
+    EXPECT_TRUE(storage.GetChunks("KEY1", chunks));
+    ASSERT_EQ(4, chunks.size());
+
+    std::string joined;
+    for (auto &chunk : chunks) {
+        joined += *chunk;
+    }
+    EXPECT_TRUE(joined == big);
+
+    std::string value;
+    EXPECT_TRUE(storage.Get("KEY1", value));
+    EXPECT_TRUE(value == big);
+}
+
+TEST(StorageTest, AppendChunks) {
+    SimpleLRU storage(1024 * 1024);
+
+    EXPECT_FALSE(storage.Append("KEY1", "val"));
+    EXPECT_TRUE(storage.Put("KEY1", "val"));
+    EXPECT_TRUE(storage.Append("KEY1", "ue"));
+
+    std::string value;
+    EXPECT_TRUE(storage.Get("KEY1", value));
+    EXPECT_EQ("value", value);
+
+    // Reader keeps old chunks, appending must not change what it sees
+    std::vector<Afina::ValueChunk> before;
+    EXPECT_TRUE(storage.GetChunks("KEY1", before));
+
+    std::string tail(2 * ChunkPool::kChunkSize, 't');
+    EXPECT_TRUE(storage.Append("KEY1", tail));
+    ASSERT_EQ(1, before.size());
+    EXPECT_EQ("value", *before[0]);
+
+    EXPECT_TRUE(storage.Get("KEY1", value));
+    EXPECT_TRUE(value == "value" + tail);
+}
+
+TEST(StorageTest, AppendEvicts) {
+    SimpleLRU storage(16);
+
+    EXPECT_TRUE(storage.Put("k1", "v1"));
+    EXPECT_TRUE(storage.Put("k2", "v2"));
+    EXPECT_TRUE(storage.Append("k1", "1234567890"));
+
+    std::string value;
+    EXPECT_FALSE(storage.Get("k2", value));
+    EXPECT_TRUE(storage.Get("k1", value));
+    EXPECT_EQ("v11234567890", value);
+
+    EXPECT_FALSE(storage.Append("k1", "1234567890"));
+}
+
+TEST(StorageTest, Prepend) {
+    SimpleLRU storage(16);
+
+    EXPECT_FALSE(storage.Prepend("k1", "val"));
+    EXPECT_TRUE(storage.Put("k1", "ue"));
+    EXPECT_TRUE(storage.Prepend("k1", "val"));
+
+    std::string value;
+    EXPECT_TRUE(storage.Get("k1", value));
+    EXPECT_EQ("value", value);
+
+    EXPECT_FALSE(storage.Prepend("k1", "1234567890"));
+    EXPECT_TRUE(storage.Get("k1", value));
+    EXPECT_EQ("value", value);
+}
+
+TEST(StorageTest, AdoptBuffer) {
+    SimpleLRU storage(64);
+
+    EXPECT_TRUE(storage.Put("k1", "v1"));
+    EXPECT_TRUE(storage.Put("k2", "v2"));
+
+    std::string buffer(60, 'b');
+    const char *data = buffer.data();
+    EXPECT_TRUE(storage.Adopt("k1", std::move(buffer)));
+
+    // Value is kept in the very same buffer, no copy made
+    std::vector<Afina::ValueChunk> chunks;
+    EXPECT_TRUE(storage.GetChunks("k1", chunks));
+    ASSERT_EQ(1, chunks.size());
+    EXPECT_EQ(data, chunks[0]->data());
+
+    std::string value;
+    EXPECT_FALSE(storage.Get("k2", value));
+    EXPECT_TRUE(storage.Get("k1", value));
+    EXPECT_EQ(std::string(60, 'b'), value);
+
+    EXPECT_FALSE(storage.Adopt("k3", std::string(128, 'x')));
+    EXPECT_TRUE(storage.Put("k3", "v3"));
+    EXPECT_TRUE(storage.Get("k3", value));
+}
+
+TEST(StorageTest, TouchExpires) {
+    SimpleLRU storage(1024);
+
+    EXPECT_FALSE(storage.Touch("KEY1", 1));
+    EXPECT_TRUE(storage.Put("KEY1", "val1"));
+    EXPECT_TRUE(storage.Put("KEY2", "val2"));
+    EXPECT_TRUE(storage.Put("KEY3", "val3"));
+
+    EXPECT_TRUE(storage.Touch("KEY1", 1));
+    EXPECT_TRUE(storage.Touch("KEY2", 1));
+    EXPECT_TRUE(storage.Touch("KEY2", 0));
+    EXPECT_TRUE(storage.Touch("KEY3", 1));
+
+    // Set keeps expiration, Put starts over without it
+    EXPECT_TRUE(storage.Set("KEY1", "new1"));
+    EXPECT_TRUE(storage.Put("KEY3", "new3"));
+
+    std::this_thread::sleep_for(std::chrono::milliseconds(1100));
+
+    std::string value;
+    EXPECT_FALSE(storage.Get("KEY1", value));
+    EXPECT_FALSE(storage.Delete("KEY1"));
+    EXPECT_TRUE(storage.Get("KEY2", value));
+    EXPECT_EQ("val2", value);
+    EXPECT_TRUE(storage.Get("KEY3", value));
+    EXPECT_EQ("new3", value);
+
+    EXPECT_TRUE(storage.Touch("KEY2", -1));
+    EXPECT_FALSE(storage.Get("KEY2", value));
+
+    std::vector<std::string> keys;
+    EXPECT_EQ(Afina::Storage::ScanResult::kEnd, storage.Scan("KEY", "", 10, keys));
+    ASSERT_EQ(1, keys.size());
+    EXPECT_EQ("KEY3", keys[0]);
+}
+
+// ARC and hash table expire keys the same way LRU does
+TEST(StorageTest, TouchExpiresOtherStorages) {
+    ARC arc(1024);
+    ThreadSafeARC locked_arc(1024);
+    ConcurrentHash hash(1024, 1);
+
+    for (Afina::Storage *storage : std::vector<Afina::Storage *>{&arc, &locked_arc, &hash}) {
+        EXPECT_FALSE(storage->Touch("KEY1", 1));
+        EXPECT_TRUE(storage->Put("KEY1", "val1"));
+        EXPECT_TRUE(storage->Put("KEY2", "val2"));
+        EXPECT_TRUE(storage->Put("KEY3", "val3"));
+
+        EXPECT_TRUE(storage->Touch("KEY1", 1));
+        EXPECT_TRUE(storage->Touch("KEY2", 1));
+        EXPECT_TRUE(storage->Touch("KEY2", 0));
+        EXPECT_TRUE(storage->Touch("KEY3", 1));
+
+        int64_t ttl = 0;
+        EXPECT_TRUE(storage->TimeToLive("KEY1", ttl));
+        EXPECT_EQ(1, ttl);
+        EXPECT_TRUE(storage->TimeToLive("KEY2", ttl));
+        EXPECT_EQ(-1, ttl);
+        EXPECT_FALSE(storage->TimeToLive("none", ttl));
+
+        // Set and Append keep expiration, Put starts over without it
+        EXPECT_TRUE(storage->Set("KEY1", "new1"));
+        EXPECT_TRUE(storage->Append("KEY1", "+"));
+        EXPECT_TRUE(storage->Put("KEY3", "new3"));
+
+        std::this_thread::sleep_for(std::chrono::milliseconds(1100));
+
+        std::string value;
+        EXPECT_FALSE(storage->Get("KEY1", value));
+        EXPECT_FALSE(storage->Set("KEY1", "val"));
+        EXPECT_FALSE(storage->Delete("KEY1"));
+        EXPECT_TRUE(storage->PutIfAbsent("KEY1", "again"));
+        EXPECT_TRUE(storage->Get("KEY1", value));
+        EXPECT_EQ("again", value);
+        EXPECT_TRUE(storage->Get("KEY2", value));
+        EXPECT_EQ("val2", value);
+        EXPECT_TRUE(storage->Get("KEY3", value));
+        EXPECT_EQ("new3", value);
+
+        EXPECT_TRUE(storage->Touch("KEY2", -1));
+        EXPECT_FALSE(storage->Get("KEY2", value));
+    }
+}
+
+TEST(StorageTest, ChunkPoolReuse) {
+    ChunkPool pool(2);
+
+    std::string *raw;
+    {
+        std::shared_ptr<std::string> chunk = pool.Allocate();
+        EXPECT_EQ(0, chunk->size());
+        EXPECT_LE(ChunkPool::kChunkSize, chunk->capacity());
+        chunk->assign("data");
+        raw = chunk.get();
+    }
+    EXPECT_EQ(1, pool.FreeCount());
+
+    std::shared_ptr<std::string> chunk = pool.Allocate();
+    EXPECT_EQ(raw, chunk.get());
+    EXPECT_EQ(0, chunk->size());
+    EXPECT_EQ(0, pool.FreeCount());
+}
+
+// Every test gets its own tier file, so that parallel runs never share it, and file is gone once test is over
+class SecondTierTest : public ::testing::Test {
+protected:
+    void SetUp() override {
+        char path[] = "/tmp/afina_tier_XXXXXX";
+        int fd = mkstemp(path);
+        ASSERT_NE(-1, fd);
+        close(fd);
+        tier_path = path;
+    }
+
+    void TearDown() override {
+        if (!tier_path.empty()) {
+            unlink(tier_path.c_str());
+            rmdir((tier_path + ".compact").c_str());
+        }
+    }
+
+    std::string tier_path;
+};
+
+TEST_F(SecondTierTest, Spill) {
+    SimpleLRU storage(3 * 4);
+    storage.SetSecondTier(std::unique_ptr<FileTier>(new FileTier(tier_path, 1024)));
+
+    EXPECT_TRUE(storage.Put("k1", "v1"));
+    EXPECT_TRUE(storage.Put("k2", "v2"));
+    EXPECT_TRUE(storage.Put("k3", "v3"));
+    EXPECT_TRUE(storage.Put("k4", "v4"));
+
+    // k1 is evicted from memory but still available
+    EXPECT_FALSE(storage.PutIfAbsent("k1", "new"));
+
+    std::string value;
+    EXPECT_TRUE(storage.Get("k1", value));
+    EXPECT_EQ("v1", value);
+
+    // Promotion of k1 evicted k2
+    EXPECT_TRUE(storage.Set("k2", "v22"));
+    EXPECT_TRUE(storage.Get("k2", value));
+    EXPECT_EQ("v22", value);
+
+    EXPECT_TRUE(storage.Delete("k3"));
+    EXPECT_FALSE(storage.Get("k3", value));
+    EXPECT_FALSE(storage.Delete("k3"));
+
+    std::vector<std::pair<std::string, std::string>> stats;
+    storage.GetStats(stats);
+    std::map<std::string, std::string> named(stats.begin(), stats.end());
+    EXPECT_EQ("1", named["tier2_hits"]);
+    EXPECT_EQ("2", named["curr_items"]);
+    EXPECT_EQ(1, named.count("tier1_get_avg_ns"));
+    EXPECT_EQ(1, named.count("tier2_read_avg_ns"));
+}
+
+TEST_F(SecondTierTest, ClearBothTiers) {
+    SimpleLRU storage(3 * 4);
+    storage.SetSecondTier(std::unique_ptr<FileTier>(new FileTier(tier_path, 1024)));
+
+    EXPECT_TRUE(storage.Put("k1", "v1"));
+    EXPECT_TRUE(storage.Put("k2", "v2"));
+    EXPECT_TRUE(storage.Put("k3", "v3"));
+    EXPECT_TRUE(storage.Put("k4", "v4"));
+    EXPECT_TRUE(storage.Clear());
+
+    std::string value;
+    EXPECT_FALSE(storage.Get("k1", value));
+    EXPECT_FALSE(storage.Get("k4", value));
+
+    // Storage is fully usable after clear
+    EXPECT_TRUE(storage.Put("k1", "v11"));
+    EXPECT_TRUE(storage.Put("k2", "v22"));
+    EXPECT_TRUE(storage.Put("k3", "v33"));
+    EXPECT_TRUE(storage.Get("k1", value));
+    EXPECT_EQ("v11", value);
+}
+
+TEST_F(SecondTierTest, Compaction) {
+    FileTier tier(tier_path, 1024);
+
+    // Each record takes 8 + 4 + 100 bytes, so log fits 9 of them
+    std::string value(100, 'v');
+    for (int i = 0; i < 100; ++i) {
+        std::string key = "k" + std::to_string(100 + i);
+        EXPECT_TRUE(tier.Put(key, {std::make_shared<std::string>(value)}));
+    }
+
+    // Oldest ones are dropped, the newest survive
+    EXPECT_FALSE(tier.Contains("k100"));
+    EXPECT_TRUE(tier.Contains("k199"));
+
+    std::string res;
+    EXPECT_TRUE(tier.Take("k198", res));
+    EXPECT_TRUE(res == value);
+    EXPECT_FALSE(tier.Take("k198", res));
+
+    std::vector<std::pair<std::string, std::string>> stats;
+    tier.GetStats(stats);
+    std::map<std::string, std::string> named(stats.begin(), stats.end());
+    EXPECT_NE("0", named["tier2_compactions"]);
+    EXPECT_GE(1024, std::stoul(named["tier2_file_bytes"]));
+}
+
+// Directory in place of the temporary log makes compaction fail, tier keeps what it has and refuses new records
+TEST_F(SecondTierTest, FailedCompaction) {
+    ASSERT_EQ(0, mkdir((tier_path + ".compact").c_str(), 0700));
+    FileTier tier(tier_path, 1024);
+
+    // Each record takes 8 + 4 + 100 bytes, so log fits 9 of them before compaction
+    std::string value(100, 'v');
+    for (int i = 0; i < 9; ++i) {
+        EXPECT_TRUE(tier.Put("k" + std::to_string(100 + i), {std::make_shared<std::string>(value)}));
+    }
+    EXPECT_FALSE(tier.Put("k109", {std::make_shared<std::string>(value)}));
+    EXPECT_FALSE(tier.Contains("k109"));
+    EXPECT_TRUE(tier.Contains("k100"));
+
+    std::string res;
+    EXPECT_TRUE(tier.Take("k108", res));
+    EXPECT_TRUE(res == value);
+
+    // Once the cause is gone tier compacts again
+    ASSERT_EQ(0, rmdir((tier_path + ".compact").c_str()));
+    EXPECT_TRUE(tier.Put("k109", {std::make_shared<std::string>(value)}));
+    EXPECT_TRUE(tier.Contains("k109"));
+}
+
+// Spill that fails is the same as eviction without second tier, memory tier keeps working
+TEST_F(SecondTierTest, FailedSpill) {
+    ASSERT_EQ(0, mkdir((tier_path + ".compact").c_str(), 0700));
+    SimpleLRU storage(3 * 4);
+    storage.SetSecondTier(std::unique_ptr<FileTier>(new FileTier(tier_path, 40)));
+
+    // Log fits 3 records of 8 + 2 + 2 bytes, k4 and k5 are dropped on eviction
+    for (int i = 1; i <= 8; ++i) {
+        EXPECT_TRUE(storage.Put("k" + std::to_string(i), "v" + std::to_string(i)));
+    }
+
+    std::string value;
+    EXPECT_FALSE(storage.Get("k4", value));
+    EXPECT_TRUE(storage.Get("k8", value));
+    EXPECT_EQ("v8", value);
+    EXPECT_TRUE(storage.Get("k1", value));
+    EXPECT_EQ("v1", value);
+    EXPECT_TRUE(storage.Set("k8", "new"));
+}
+
+// Read-modify-write of the thread safe storages never loses concurrent updates
+TEST(StorageTest, ConcurrentUpdate) {
+    ThreadSafeSimplLRU lru(1024 * 1024);
+    ThreadSafeARC arc(1024 * 1024);
+    ConcurrentHash hash(1024 * 1024);
+
+    for (Afina::Storage *storage : std::vector<Afina::Storage *>{&lru, &arc, &hash}) {
+        std::vector<std::thread> threads;
+        for (int t = 0; t < 4; ++t) {
+            threads.emplace_back([storage]() {
+                for (int i = 0; i < 2000; ++i) {
+                    storage->Update("counter", [](bool present, std::string &value) {
+                        value = std::to_string((present ? std::stoi(value) : 0) + 1);
+                        return true;
+                    });
+                }
+            });
+        }
+        for (auto &t : threads) {
+            t.join();
+        }
+
+        std::string value;
+        EXPECT_TRUE(storage->Get("counter", value));
+        EXPECT_EQ("8000", value);
+
+        // Declined update leaves key as it is
+        EXPECT_FALSE(storage->Update("counter", [](bool present, std::string &value) { return false; }));
+        EXPECT_FALSE(storage->Update("none", [](bool present, std::string &value) { return present; }));
+        EXPECT_FALSE(storage->Get("none", value));
+    }
+}
+
+// Appends and prepends of the thread safe storages never lose each other
+TEST(StorageTest, ConcurrentAppendPrepend) {
+    ThreadSafeSimplLRU lru(1024 * 1024);
+    ThreadSafeARC arc(1024 * 1024);
+    ConcurrentHash hash(1024 * 1024);
+
+    for (Afina::Storage *storage : std::vector<Afina::Storage *>{&lru, &arc, &hash}) {
+        EXPECT_TRUE(storage->Put("log", "|"));
+
+        std::vector<std::thread> threads;
+        for (int t = 0; t < 4; ++t) {
+            threads.emplace_back([storage]() {
+                for (int i = 0; i < 500; ++i) {
+                    storage->Append("log", "a");
+                    storage->Prepend("log", "p");
+                }
+            });
+        }
+        for (auto &t : threads) {
+            t.join();
+        }
+
+        std::string value;
+        EXPECT_TRUE(storage->Get("log", value));
+        EXPECT_EQ(std::string(2000, 'p') + "|" + std::string(2000, 'a'), value);
+        EXPECT_FALSE(storage->Prepend("none", "p"));
+        EXPECT_FALSE(storage->Get("none", value));
+    }
+}